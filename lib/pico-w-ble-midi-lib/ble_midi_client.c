@@ -835,6 +835,47 @@ uint8_t ble_midi_client_stream_write(uint8_t nbytes, const uint8_t* midi_stream_
     return bytes_written;
 }
 
+uint8_t ble_midi_client_packet_write(uint8_t nbytes, const uint8_t* ble_midi_packet)
+{
+    // do not send data in unconnected state, otherwise a crash will occur on reconnect
+    if (!ble_midi_client_is_ready()) {
+        return 0;
+    }
+
+    uint8_t bytes_written = ble_midi_pkt_codec_push_ble_pkt(ble_midi_packet, nbytes, ble_midi_pkt_codec_data);
+    if (bytes_written > 0) {
+        write_callback_registration.callback = handle_can_write_without_response;
+        write_callback_registration.context = NULL;
+
+        gatt_client_request_to_write_without_response(&write_callback_registration, con_handle);
+    }
+    return bytes_written;
+}
+
+uint16_t ble_midi_client_get_max_packet_size(void)
+{
+    if (!ble_midi_client_is_ready()) {
+        return 0;
+    }
+    return ble_midi_pkt_codec_get_mtu(ble_midi_pkt_codec_data);
+}
+
+uint16_t ble_midi_client_get_num_free_packets(void)
+{
+    if (!ble_midi_client_is_ready()) {
+        return 0;
+    }
+    return ble_midi_pkt_codec_get_num_free_ble_pkts(ble_midi_pkt_codec_data);
+}
+
+bool ble_midi_client_is_packet_pending(void)
+{
+    if (!ble_midi_client_is_ready()) {
+        return false;
+    }
+    return ble_midi_pkt_codec_ble_pkt_available(ble_midi_pkt_codec_data);
+}
+
 uint8_t ble_midi_client_stream_read(uint8_t max_bytes, uint8_t* midi_stream_bytes, uint16_t* timestamp)
 {
     ble_midi_message_t mes;
@@ -182,6 +182,40 @@ void ble_midi_client_request_disconnect();
  */
 uint8_t ble_midi_client_stream_write(uint8_t nbytes, const uint8_t* midi_stream_bytes);
 
+/**
+ * @brief write an already encoded BLE-MIDI 1.0 packet
+ *
+ * In contrast to ble_midi_client_stream_write() the timestamps of the packet are
+ * kept, so the caller can collect several messages with their own timestamps
+ * in one packet.
+ *
+ * @param nbytes the number of bytes in the packet, at most ble_midi_client_get_max_packet_size()
+ * @param ble_midi_packet a pointer to the BLE-MIDI 1.0 packet starting with the header byte
+ * @return uint8_t nbytes if the packet was queued or 0 if not
+ */
+uint8_t ble_midi_client_packet_write(uint8_t nbytes, const uint8_t* ble_midi_packet);
+
+/**
+ * @brief
+ *
+ * @return the maximum number of bytes of a BLE-MIDI 1.0 packet or 0 if the client is not ready
+ */
+uint16_t ble_midi_client_get_max_packet_size(void);
+
+/**
+ * @brief
+ *
+ * @return the number of packets that can be written with ble_midi_client_packet_write() or 0 if the client is not ready
+ */
+uint16_t ble_midi_client_get_num_free_packets(void);
+
+/**
+ * @brief
+ *
+ * @return true if a packet written with ble_midi_client_packet_write() still waits until it can be sent
+ */
+bool ble_midi_client_is_packet_pending(void);
+
 /**
  * @brief read a MIDI 1.0 byte stream for a single timestamp up to max_bytes long
  *
@@ -35,6 +35,7 @@
 #include "pico/stdlib.h"
 #include <assert.h>
 #include <stdio.h>
+#include <string.h>
 
 #define MIDI_SERVICE_HEADER(x) (0x80 | (((x) >> 7) & 0x3F) )
 #define MIDI_SERVICE_TIMESTAMP_LOW(x) (0x80 | ((x) & 0x7F))
@@ -647,4 +648,21 @@ uint16_t ble_midi_pkt_codec_ble_pkt_pop(ble_midi_packet_t* pkt, ble_midi_codec_d
 bool ble_midi_pkt_codec_ble_pkt_available(ble_midi_codec_data_t* context)
 {
     return ring_buffer_get_num_bytes(&context->to_ble) >= sizeof(ble_midi_packet_t);
-}
\ No newline at end of file
+}
+
+uint16_t ble_midi_pkt_codec_push_ble_pkt(const uint8_t* pkt, uint16_t nbytes, ble_midi_codec_data_t* context)
+{
+    if (nbytes == 0 || nbytes > context->ble_mtu || nbytes > MAX_BLE_MIDI_PACKET)
+        return 0;
+    ble_midi_packet_t ble_pkt;
+    ble_pkt.nbytes = nbytes;
+    memcpy(ble_pkt.pkt, pkt, nbytes);
+    if (!midi_service_stream_push(&context->to_ble, (uint8_t*)&ble_pkt, sizeof(ble_pkt)))
+        return 0;
+    return nbytes;
+}
+
+uint16_t ble_midi_pkt_codec_get_num_free_ble_pkts(ble_midi_codec_data_t* context)
+{
+    return (context->to_ble.bufsize - ring_buffer_get_num_bytes(&context->to_ble)) / sizeof(ble_midi_packet_t);
+}
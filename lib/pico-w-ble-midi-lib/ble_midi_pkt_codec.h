@@ -134,6 +134,24 @@ uint16_t ble_midi_pkt_codec_ble_pkt_pop(ble_midi_packet_t* pkt, ble_midi_codec_d
  * @return true if there is at least one BLE-MIDI packet available to send
  */
 bool ble_midi_pkt_codec_ble_pkt_available(ble_midi_codec_data_t* context);
+
+/**
+ * @brief push an already encoded BLE-MIDI 1.0 packet to the context's packet to send ring buffer
+ *
+ * @param pkt a BLE-MIDI 1.0 formatted packet
+ * @param nbytes the number of bytes in the packet, must not exceed the MTU of the connection
+ * @param context the data associated with a BLE-MIDI 1.0 connection
+ * @return uint16_t nbytes if the packet was pushed or 0 if it is too long or the ring buffer is full
+ */
+uint16_t ble_midi_pkt_codec_push_ble_pkt(const uint8_t* pkt, uint16_t nbytes, ble_midi_codec_data_t* context);
+
+/**
+ * @brief
+ *
+ * @param context the data associated with a BLE-MIDI 1.0 connection
+ * @return uint16_t the number of BLE-MIDI packets that can be pushed before the packet to send ring buffer is full
+ */
+uint16_t ble_midi_pkt_codec_get_num_free_ble_pkts(ble_midi_codec_data_t* context);
 #if defined __cplusplus
 }
 #endif
\ No newline at end of file
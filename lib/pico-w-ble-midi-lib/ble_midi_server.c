@@ -269,6 +269,34 @@ uint8_t ble_midi_server_stream_write(uint8_t nbytes, const uint8_t* midi_stream_
 }
 
 
+uint8_t ble_midi_server_packet_write(uint8_t nbytes, const uint8_t* ble_midi_packet)
+{
+    if (ble_midi_server_is_connected())
+        return midi_service_stream_packet_write(con_handle, nbytes, ble_midi_packet);
+    return 0;
+}
+
+uint16_t ble_midi_server_get_max_packet_size()
+{
+    if (ble_midi_server_is_connected())
+        return midi_service_stream_get_max_packet_size(con_handle);
+    return 0;
+}
+
+uint16_t ble_midi_server_get_num_free_packets()
+{
+    if (ble_midi_server_is_connected())
+        return midi_service_stream_get_num_free_packets(con_handle);
+    return 0;
+}
+
+bool ble_midi_server_is_packet_pending()
+{
+    if (ble_midi_server_is_connected())
+        return midi_service_stream_is_packet_pending(con_handle);
+    return false;
+}
+
 void ble_midi_server_request_disconnect()
 {
     if (ble_midi_server_is_connected())
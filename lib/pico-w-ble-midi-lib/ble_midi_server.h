@@ -74,6 +74,40 @@ uint8_t ble_midi_server_stream_read(uint8_t max_bytes, uint8_t* midi_stream_byte
  */
 uint8_t ble_midi_server_stream_write(uint8_t nbytes, const uint8_t* midi_stream_bytes);
 
+/**
+ * @brief write an already encoded BLE-MIDI 1.0 packet to Bluetooth if connected
+ *
+ * In contrast to ble_midi_server_stream_write() the timestamps of the packet are
+ * kept, so the caller can collect several messages with their own timestamps
+ * in one packet.
+ *
+ * @param nbytes is the number of bytes in the packet, at most ble_midi_server_get_max_packet_size()
+ * @param ble_midi_packet is the BLE-MIDI 1.0 packet starting with the header byte
+ * @return nbytes if the packet was queued or 0 if not
+ */
+uint8_t ble_midi_server_packet_write(uint8_t nbytes, const uint8_t* ble_midi_packet);
+
+/**
+ * @brief
+ *
+ * @return the maximum number of bytes of a BLE-MIDI 1.0 packet or 0 if not connected
+ */
+uint16_t ble_midi_server_get_max_packet_size();
+
+/**
+ * @brief
+ *
+ * @return the number of packets that can be written with ble_midi_server_packet_write() or 0 if not connected
+ */
+uint16_t ble_midi_server_get_num_free_packets();
+
+/**
+ * @brief
+ *
+ * @return true if a packet written with ble_midi_server_packet_write() still waits until it can be sent
+ */
+bool ble_midi_server_is_packet_pending();
+
 /**
  * @brief request disconnection from currently connected Bluetooth client
  *
@@ -326,3 +326,34 @@ uint8_t midi_service_stream_read(hci_con_handle_t con_handle, uint8_t max_bytes,
 
     return nread;
 }
+
+uint8_t midi_service_stream_packet_write(hci_con_handle_t con_handle, uint8_t nbytes, const uint8_t* ble_midi_packet)
+{
+    midi_service_stream_connection_t* context = get_context_for_conn_handle(con_handle);
+    uint16_t npushed = 0;
+    if (context) {
+        npushed = ble_midi_pkt_codec_push_ble_pkt(ble_midi_packet, nbytes, context->ble_midi_pkt_codec_data);
+        if (npushed > 0) {
+            midi_service_server_request_can_send_now(&context->send_request, context->connection_handle);
+        }
+    }
+    return npushed;
+}
+
+uint16_t midi_service_stream_get_max_packet_size(hci_con_handle_t con_handle)
+{
+    midi_service_stream_connection_t* context = get_context_for_conn_handle(con_handle);
+    return context ? ble_midi_pkt_codec_get_mtu(context->ble_midi_pkt_codec_data) : 0;
+}
+
+uint16_t midi_service_stream_get_num_free_packets(hci_con_handle_t con_handle)
+{
+    midi_service_stream_connection_t* context = get_context_for_conn_handle(con_handle);
+    return context ? ble_midi_pkt_codec_get_num_free_ble_pkts(context->ble_midi_pkt_codec_data) : 0;
+}
+
+bool midi_service_stream_is_packet_pending(hci_con_handle_t con_handle)
+{
+    midi_service_stream_connection_t* context = get_context_for_conn_handle(con_handle);
+    return context && ble_midi_pkt_codec_ble_pkt_available(context->ble_midi_pkt_codec_data);
+}
@@ -69,6 +69,43 @@ uint8_t midi_service_stream_write(hci_con_handle_t con_handle, uint8_t nbytes, c
  * zero if there are no more bytes to read
  */
 uint8_t midi_service_stream_read(hci_con_handle_t con_handle, uint8_t max_bytes, uint8_t* midi_stream_bytes, uint16_t* timestamp);
+
+/**
+ * @brief write an already encoded BLE-MIDI 1.0 packet
+ *
+ * The packet is sent as it is when the MIDI service allows it, so the
+ * caller is responsible for the header, the timestamps and running status.
+ *
+ * @param con_handle the HCI connection handle for the connection to send the packet to
+ * @param nbytes the number of bytes in the packet
+ * @param ble_midi_packet a pointer to the BLE-MIDI 1.0 packet
+ * @return uint8_t nbytes if the packet was queued or 0 if not
+ */
+uint8_t midi_service_stream_packet_write(hci_con_handle_t con_handle, uint8_t nbytes, const uint8_t* ble_midi_packet);
+
+/**
+ * @brief
+ *
+ * @param con_handle the HCI connection handle
+ * @return uint16_t the maximum number of bytes of a BLE-MIDI 1.0 packet for the connection or 0 if not connected
+ */
+uint16_t midi_service_stream_get_max_packet_size(hci_con_handle_t con_handle);
+
+/**
+ * @brief
+ *
+ * @param con_handle the HCI connection handle
+ * @return uint16_t the number of packets that can be written before the send buffer of the connection is full
+ */
+uint16_t midi_service_stream_get_num_free_packets(hci_con_handle_t con_handle);
+
+/**
+ * @brief
+ *
+ * @param con_handle the HCI connection handle
+ * @return true if a written packet still waits until the MIDI service can send it
+ */
+bool midi_service_stream_is_packet_pending(hci_con_handle_t con_handle);
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,118 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "adc_trace_capture.h"
+
+#include "drum_kit.h"
+#include "spsc_queue.h"
+#include "webui.h"
+
+#include <string.h>
+
+#define ADC_TRACE_QUEUE_SIZE 4
+
+// chunks are sent by the main core as the web server must not be accessed by the sensing core
+static SpscQueue<AdcTraceChunk, ADC_TRACE_QUEUE_SIZE> chunkQueue;
+
+size_t AdcTraceCapture::start(const DrumKit& drumKit, time_us_t minIntervalUs, uint8_t* headerBuffer, size_t bufferSize) {
+  const DrumScanner& scanner = drumKit.getScanner();
+  const size_t headerSize = sizeof(AdcTraceHeader) + scanner.getSlotsCount() * sizeof(AdcTraceSlotInfo);
+  if (headerSize > bufferSize) {
+    return 0;
+  }
+
+  AdcTraceHeader header;
+  memcpy(header.magic, ADC_TRACE_MAGIC, sizeof(header.magic));
+  header.version = ADC_TRACE_VERSION;
+  header.slotsCount = scanner.getSlotsCount();
+  memcpy(headerBuffer, &header, sizeof(header));
+
+  AdcTraceSlotInfo* slotInfos = (AdcTraceSlotInfo*) (headerBuffer + sizeof(header));
+  for (scan_slot_t slot = 0; slot < scanner.getSlotsCount(); ++slot) {
+    const ScanSlot& scanSlot = scanner.getSlot(slot);
+    AdcTraceSlotInfo& info = slotInfos[slot];
+    info.muxIndex = scanSlot.mux ? scanSlot.mux - drumKit.getMux(0) : ADC_TRACE_DIRECT_PIN;
+    info.channel = scanSlot.mux ? scanSlot.channel : scanSlot.analogInPin;
+    info.padIndex = UNKNOWN_PAD;
+    info.pinIndex = 0;
+  }
+
+  for (pad_size_t padIndex = drumKit.getPadsCount(); padIndex-- > 0;) { // the first pad wins
+    const DrumPad& pad = *drumKit.getPad(padIndex);
+    for (pin_size_t pinIndex = 0; pad.getConnector() && pinIndex < pad.getConnector()->getPinCount(); ++pinIndex) {
+      const sensor_value_t* sample = pad.getConnector()->getPin(pinIndex).sample;
+      if (sample) {
+        AdcTraceSlotInfo& info = slotInfos[scanner.getSlotIndex(sample)];
+        info.padIndex = padIndex;
+        info.pinIndex = pinIndex;
+      }
+    }
+  }
+
+  this->minIntervalUs = minIntervalUs;
+  slotsCount = header.slotsCount;
+  isFirstFrame = true;
+  droppedFrameCount = 0;
+  chunk = nullptr;
+  active = true;
+  return headerSize;
+}
+
+void AdcTraceCapture::stop() {
+  if (chunk) {
+    commitChunk();
+  }
+  active = false;
+}
+
+void AdcTraceCapture::abort() {
+  stop();
+  forwardQueuedChunks(); // the trace must be complete before the status is sent
+  webUI.sendAdcTraceStatus(*this);
+}
+
+void AdcTraceCapture::recordSweep(const DrumScanner& scanner) {
+  const time_us_t frameTimeUs = *scanner.getSampleTimeLocation(0);
+  if (!isFirstFrame && frameTimeUs - lastFrameTimeUs < minIntervalUs) {
+    return;
+  }
+
+  const size_t frameSize = getAdcTraceFrameSize(slotsCount, true); // max. size
+  if (chunk && chunk->size + frameSize > ADC_TRACE_CHUNK_SIZE) {
+    commitChunk();
+  }
+  if (!chunk) {
+    chunk = chunkQueue.beginPush();
+    if (!chunk) {
+      ++droppedFrameCount; // UI is not fast enough
+      return;
+    }
+    memcpy(chunk->data, ADC_TRACE_DATA_MAGIC, strlen(ADC_TRACE_DATA_MAGIC));
+    chunk->size = strlen(ADC_TRACE_DATA_MAGIC);
+  }
+
+  const time_us_t deltaUs = isFirstFrame ? 0 : frameTimeUs - lastFrameTimeUs;
+  chunk->size += encodeAdcTraceFrame(chunk->data + chunk->size, deltaUs, scanner.getSamples(), slotsCount);
+  lastFrameTimeUs = frameTimeUs;
+  isFirstFrame = false;
+}
+
+void AdcTraceCapture::commitChunk() {
+  chunkQueue.commitPush();
+  chunk = nullptr;
+}
+
+const AdcTraceChunk* AdcTraceCapture::peekQueuedChunk() {
+  return chunkQueue.peek();
+}
+
+void AdcTraceCapture::popQueuedChunk() {
+  chunkQueue.pop();
+}
+
+void AdcTraceCapture::forwardQueuedChunks() {
+  while (const AdcTraceChunk* queuedChunk = peekQueuedChunk()) {
+    webUI.sendBinaryToWebSocket((uint8_t*) queuedChunk->data, queuedChunk->size);
+    popQueuedChunk();
+  }
+}
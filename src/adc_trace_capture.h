@@ -0,0 +1,78 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "adc_trace.h"
+#include "drum_scanner.h"
+
+class DrumKit;
+
+// prefix of the WebSocket messages with trace frames, the trace header is sent with ADC_TRACE_MAGIC
+#define ADC_TRACE_DATA_MAGIC "EDTD"
+
+#define ADC_TRACE_CHUNK_SIZE 1024
+
+struct AdcTraceChunk {
+  size_t size;
+  uint8_t data[ADC_TRACE_CHUNK_SIZE]; // ADC_TRACE_DATA_MAGIC followed by the frames
+};
+
+/**
+ * Records the raw samples of all inputs of each sweep as an ADC trace (see adc_trace.h),
+ * so that field issues can be reproduced with the native simulation.
+ *
+ * The frames are collected in chunks by the sensing core and streamed to the web UI by the main core.
+ * If the UI cannot keep up, frames are dropped. The time of the next frame still refers to the last recorded one.
+ * Slots of masked drums are not skipped while recording, so that every frame contains current samples.
+ */
+class AdcTraceCapture {
+public:
+  /**
+   * Starts recording the scan plan of the kit. Must be called by the main core while the sensing is paused.
+   * @param minIntervalUs min. time between two recorded sweeps, 0 to record every sweep
+   * @return size of the trace header written to headerBuffer or 0 if it does not fit.
+   */
+  size_t start(const DrumKit& drumKit, time_us_t minIntervalUs, uint8_t* headerBuffer, size_t bufferSize);
+
+  /**
+   * Stops recording and queues the last chunk. Must be called by the main core while the sensing is paused.
+   */
+  void stop();
+
+  /**
+   * Stops recording without a request of the UI, e.g. because the scan plan changed, and sends the status to the UI.
+   * Must be called by the main core while the sensing is paused.
+   */
+  void abort();
+
+  bool isActive() const { return active; }
+  uint32_t getDroppedFrameCount() const { return droppedFrameCount; }
+
+  /**
+   * Records the samples of the last sweep. Called by the sensing core after each full sweep.
+   */
+  void recordSweep(const DrumScanner& scanner);
+
+  /**
+   * Sends the queued chunks to the UI. Must be called by the main core.
+   */
+  static void forwardQueuedChunks();
+
+  // consumer side of the chunk queue, used by forwardQueuedChunks()
+  static const AdcTraceChunk* peekQueuedChunk();
+  static void popQueuedChunk();
+
+private:
+  void commitChunk();
+
+private:
+  bool active = false;
+  uint8_t slotsCount = 0;
+  time_us_t minIntervalUs = 0;
+  time_us_t lastFrameTimeUs = 0;
+  bool isFirstFrame = true;
+  uint32_t droppedFrameCount = 0;
+
+  AdcTraceChunk* chunk = nullptr; // chunk that is currently filled
+};
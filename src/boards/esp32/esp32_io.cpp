@@ -49,6 +49,23 @@ sensor_value_t DrumIO::readAnalogInPin(pin_size_t pin) {
   return (sum / NUM_SAMPLES) >> 2; // 12 to 10 bit
 }
 
+// analogRead() is blocking and has no reusable setup, so a sweep is just a series of single reads
+static pin_size_t framePin = PIN_UNUSED;
+
+void DrumIO::beginAnalogInFrame() {
+}
+
+void DrumIO::startAnalogInFramePin(pin_size_t pin) {
+  framePin = pin;
+}
+
+sensor_value_t DrumIO::finishAnalogInFramePin() {
+  return readAnalogInPin(framePin);
+}
+
+void DrumIO::endAnalogInFrame() {
+}
+
 bool DrumIO::initDigitalOutPin(pin_size_t pin) {
   if (pin >= GPIO_PIN_COUNT) { // GPIO_NUM_MAX
     return false;
@@ -113,6 +130,10 @@ void DrumIO::getMemoryStats(uint32_t& total, uint32_t& free) {
   free = 0;
 }
 
+uint32_t DrumIO::getMinFreeHeap() {
+  return 0;
+}
+
 pin_size_t DrumIO::getMidiTxPin(HardwareSerial& serial) {
   return PIN_UNUSED;
 }
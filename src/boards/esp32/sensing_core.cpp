@@ -0,0 +1,9 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "sensing_core.h"
+
+// sensing is performed by the main loop
+bool SensingCore::startOwnCore() {
+  return false;
+}
@@ -0,0 +1,90 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "adc_trace_replay.h"
+
+#include "log.h"
+
+#include <fstream>
+#include <iterator>
+#include <string.h>
+
+bool AdcTraceReplay::load(const uint8_t* traceData, size_t size) {
+  data.clear();
+  slotInfos.clear();
+  framesOffset = position = 0;
+  timeUs = 0;
+
+  AdcTraceHeader header;
+  if (size < sizeof(header)) {
+    return false;
+  }
+  memcpy(&header, traceData, sizeof(header));
+  if (memcmp(header.magic, ADC_TRACE_MAGIC, sizeof(header.magic)) != 0 || header.version != ADC_TRACE_VERSION) {
+    logError("Invalid ADC trace header");
+    return false;
+  }
+
+  const size_t headerSize = sizeof(header) + header.slotsCount * sizeof(AdcTraceSlotInfo);
+  if (size < headerSize) {
+    logError("ADC trace is truncated");
+    return false;
+  }
+
+  slotInfos.resize(header.slotsCount);
+  memcpy(slotInfos.data(), traceData + sizeof(header), header.slotsCount * sizeof(AdcTraceSlotInfo));
+  data.assign(traceData, traceData + size);
+  framesOffset = position = headerSize;
+  return true;
+}
+
+bool AdcTraceReplay::loadFile(const char* path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    logError("Cannot open ADC trace: %s", path);
+    return false;
+  }
+  std::vector<uint8_t> content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  return load(content.data(), content.size());
+}
+
+size_t AdcTraceReplay::getFrameSize(size_t offset) const {
+  if (offset + sizeof(uint16_t) > data.size()) {
+    return 0;
+  }
+  const size_t frameSize = getAdcTraceFrameSize(getSlotsCount(), isAdcTraceLongDelta(data.data() + offset));
+  return (offset + frameSize <= data.size()) ? frameSize : 0; // 0 if the frame is truncated
+}
+
+size_t AdcTraceReplay::getFrameCount() const {
+  size_t frameCount = 0;
+  size_t offset = framesOffset;
+  while (const size_t frameSize = getFrameSize(offset)) {
+    offset += frameSize;
+    ++frameCount;
+  }
+  return frameCount;
+}
+
+bool AdcTraceReplay::nextFrame() {
+  if (getFrameSize(position) == 0) {
+    return false;
+  }
+
+  time_us_t deltaUs;
+  position += decodeAdcTraceFrame(data.data() + position, deltaUs, samples, getSlotsCount());
+  timeUs += deltaUs;
+  if (isVirtualClockEnabled()) {
+    advanceVirtualClock(deltaUs);
+  }
+
+  for (uint8_t slot = 0; slot < getSlotsCount(); ++slot) {
+    const AdcTraceSlotInfo& info = slotInfos[slot];
+    if (info.muxIndex == ADC_TRACE_DIRECT_PIN) {
+      setAnalogInValue(info.channel, samples[slot]);
+    } else {
+      setMuxInValue(info.muxIndex, info.channel, samples[slot]);
+    }
+  }
+  return true;
+}
@@ -0,0 +1,57 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "adc_trace.h"
+#include "simulation.h"
+
+#include <vector>
+
+/**
+ * Replays a raw ADC trace (see adc_trace.h) through the simulated inputs, so that the kit reads the recorded
+ * samples with DrumIO like on the device. The kit must use the same muxes and pins as the recorded one.
+ */
+class AdcTraceReplay {
+public:
+  /**
+   * Loads a trace, e.g. the header and frames recorded by AdcTraceCapture.
+   * @return false if the data is not a valid trace
+   */
+  bool load(const uint8_t* data, size_t size);
+  bool loadFile(const char* path);
+
+  uint8_t getSlotsCount() const { return slotInfos.size(); }
+  const AdcTraceSlotInfo& getSlotInfo(uint8_t slot) const { return slotInfos[slot]; }
+  size_t getFrameCount() const;
+
+  /**
+   * Applies the next frame to the simulated inputs. If the virtual clock is enabled, it is advanced by the
+   * time between the frames first.
+   * @return false if the end of the trace was reached
+   */
+  bool nextFrame();
+
+  void rewind() {
+    position = framesOffset;
+    timeUs = 0;
+  }
+
+  // time of the current frame relative to the first one
+  time_us_t getTimeUs() const { return timeUs; }
+
+  const sensor_value_t* getSamples() const { return samples; }
+
+private:
+  // size of the frame at offset or 0 if there is no complete frame
+  size_t getFrameSize(size_t offset) const;
+
+private:
+  std::vector<uint8_t> data;
+  std::vector<AdcTraceSlotInfo> slotInfos;
+  size_t framesOffset = 0;
+  size_t position = 0;
+  time_us_t timeUs = 0;
+
+  sensor_value_t samples[UINT8_MAX] = {};
+};
@@ -3,6 +3,7 @@
 
 #include "Common.h"
 
+#include <atomic>
 #include <sys/time.h>
 #include <thread>
 
@@ -21,11 +22,35 @@ uint16_t makeWord(uint8_t h, uint8_t l) {
   return (h << 8) | l;
 }
 
+static std::atomic<bool> virtualClockEnabled = false;
+static std::atomic<time_us_t> virtualTimeUs = 0;
+
+void enableVirtualClock(time_us_t startTimeUs) {
+  virtualTimeUs = startTimeUs;
+  virtualClockEnabled = true;
+}
+
+void disableVirtualClock() {
+  virtualClockEnabled = false;
+}
+
+bool isVirtualClockEnabled() {
+  return virtualClockEnabled;
+}
+
+void advanceVirtualClock(time_us_t deltaUs) {
+  virtualTimeUs += deltaUs;
+}
+
 time_ms_t millis() {
   return micros() / 1000l;
 }
 
 time_us_t micros() {
+  if (virtualClockEnabled) {
+    return virtualTimeUs;
+  }
+
   struct timeval tv;
   gettimeofday(&tv, NULL);
 
@@ -37,5 +62,9 @@ void yield(void) { std::this_thread::yield(); }
 void pinMode(pin_size_t pinNumber, PinMode pinMode) {}
 
 void delay(unsigned long ms) {
+  if (virtualClockEnabled) {
+    advanceVirtualClock(ms * 1000);
+    return;
+  }
   usleep(ms * 1000);
 }
\ No newline at end of file
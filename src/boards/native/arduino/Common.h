@@ -116,6 +116,13 @@ typedef uint8_t pin_size_t;
   time_us_t micros(void);
   void delay(unsigned long);
   void delayMicroseconds(unsigned int us);
+
+  // Virtual clock of the simulation: while enabled, the time only advances explicitly or by delay(),
+  // so that simulations are deterministic and can run faster than real time.
+  void enableVirtualClock(time_us_t startTimeUs);
+  void disableVirtualClock(void);
+  bool isVirtualClockEnabled(void);
+  void advanceVirtualClock(time_us_t deltaUs);
   unsigned long pulseIn(pin_size_t pin, uint8_t state, unsigned long timeout);
   unsigned long pulseInLong(pin_size_t pin, uint8_t state, unsigned long timeout);
 
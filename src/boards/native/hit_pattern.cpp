@@ -0,0 +1,176 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "hit_pattern.h"
+
+#include <algorithm>
+#include <math.h>
+
+struct DetectedHit {
+  time_us_t hitTimeUs; // start of the scan time
+  time_us_t reportTimeUs; // end of the update in which the hit was detected
+  sensor_value_t peak;
+};
+
+void HitPattern::addHit(pad_size_t padIndex, time_us_t timeUs, sensor_value_t peak) {
+  const SyntheticHit hit = {padIndex, timeUs, peak};
+  auto position = std::upper_bound(hits.begin(), hits.end(), hit,
+      [](const SyntheticHit& a, const SyntheticHit& b) { return a.timeUs < b.timeUs; });
+  hits.insert(position, hit);
+}
+
+void HitPattern::addRoll(const pad_size_t* padIndices, pad_size_t padCount, time_us_t startTimeUs, uint16_t rateHz, uint16_t hitCount, sensor_value_t peak) {
+  const time_us_t intervalUs = 1000000 / rateHz;
+  for (uint16_t i = 0; i < hitCount; ++i) {
+    for (pad_size_t padIndex = 0; padIndex < padCount; ++padIndex) {
+      addHit(padIndices[padIndex], startTimeUs + i * intervalUs, peak);
+    }
+  }
+}
+
+void HitPattern::addFlam(pad_size_t padIndex, time_us_t timeUs, time_us_t spacingUs, sensor_value_t gracePeak, sensor_value_t peak) {
+  addHit(padIndex, timeUs, gracePeak);
+  addHit(padIndex, timeUs + spacingUs, peak);
+}
+
+sensor_value_t HitPattern::getValue(pad_size_t padIndex, time_us_t timeUs) const {
+  float value = 0;
+  for (const SyntheticHit& hit : hits) {
+    if (hit.timeUs > timeUs) {
+      break;
+    }
+    const time_us_t elapsedUs = timeUs - hit.timeUs;
+    if (hit.padIndex != padIndex || elapsedUs >= waveform.lengthUs) {
+      continue;
+    }
+
+    if (elapsedUs < waveform.riseTimeUs) {
+      value += (float) hit.peak * elapsedUs / waveform.riseTimeUs;
+    } else {
+      const float decayUs = elapsedUs - waveform.riseTimeUs;
+      value += hit.peak * expf(-decayUs / waveform.decayTimeUs) * fabsf(cosf(M_PI * decayUs / waveform.ringPeriodUs));
+    }
+  }
+  return (value >= MAX_SENSOR_VALUE) ? MAX_SENSOR_VALUE : (sensor_value_t) value;
+}
+
+time_us_t HitPattern::getDurationUs() const {
+  return hits.empty() ? 0 : hits.back().timeUs + waveform.lengthUs;
+}
+
+String HitPatternResult::toString() const {
+  char text[200];
+  snprintf(text, sizeof(text), "hits: %u, detected: %u, merged: %u, missed: %u, extra: %u, "
+      "peak error: %.1f (max %u), latency: %.0f us (max %llu us), updates: %u",
+      hitCount, detectedCount, mergedCount, missedCount, extraCount, meanPeakError, maxPeakError,
+      meanLatencyUs, (unsigned long long) maxLatencyUs, updateCount);
+  return String(text);
+}
+
+static void evaluatePadHits(const HitPattern& pattern, pad_size_t padIndex, const std::vector<DetectedHit>& detectedHits, HitPatternResult& result,
+    uint64_t& peakErrorSum, uint64_t& latencySum) {
+  const DrumSettings& settings = drumKit.getPad(padIndex)->getSettings();
+  const time_us_t blockedTimeUs = settings.scanTimeUs + settings.maskTimeMs * 1000L;
+  const time_us_t toleranceUs = 2 * pattern.getWaveform().riseTimeUs; // the hit is detected while the signal rises
+
+  std::vector<const SyntheticHit*> padHits;
+  for (const SyntheticHit& hit : pattern.getHits()) {
+    if (hit.padIndex == padIndex) {
+      padHits.push_back(&hit);
+    }
+  }
+  std::vector<bool> isMatched(padHits.size(), false);
+
+  // a detected hit belongs to the latest hit that started before it
+  for (const DetectedHit& detectedHit : detectedHits) {
+    int latestIndex = -1;
+    for (size_t i = 0; i < padHits.size() && padHits[i]->timeUs <= detectedHit.hitTimeUs + toleranceUs; ++i) {
+      latestIndex = i;
+    }
+    if (latestIndex < 0 || isMatched[latestIndex]) {
+      ++result.extraCount;
+      continue;
+    }
+
+    const SyntheticHit& hit = *padHits[latestIndex];
+    isMatched[latestIndex] = true;
+    ++result.detectedCount;
+
+    const sensor_value_t peakError = (detectedHit.peak > hit.peak) ? detectedHit.peak - hit.peak : hit.peak - detectedHit.peak;
+    peakErrorSum += peakError;
+    result.maxPeakError = std::max(result.maxPeakError, peakError);
+
+    const time_us_t latencyUs = detectedHit.reportTimeUs - hit.timeUs;
+    latencySum += latencyUs;
+    result.maxLatencyUs = std::max(result.maxLatencyUs, latencyUs);
+  }
+
+  // hits that were not detected are merged if they are in the blocked time of a detected hit
+  for (size_t i = 0; i < padHits.size(); ++i) {
+    if (isMatched[i]) {
+      continue;
+    }
+    const bool isMerged = std::any_of(detectedHits.begin(), detectedHits.end(), [&](const DetectedHit& detectedHit) {
+      return detectedHit.hitTimeUs <= padHits[i]->timeUs + toleranceUs && padHits[i]->timeUs < detectedHit.hitTimeUs + blockedTimeUs;
+    });
+    if (isMerged) {
+      ++result.mergedCount;
+    } else {
+      ++result.missedCount;
+    }
+  }
+}
+
+HitPatternResult runHitPattern(const HitPattern& pattern, time_us_t virtualUpdatePeriodUs) {
+  HitPatternResult result;
+  result.hitCount = pattern.getHits().size();
+
+  bool isPadUsed[MAX_PAD_COUNT] = {};
+  for (const SyntheticHit& hit : pattern.getHits()) {
+    isPadUsed[hit.padIndex] = true;
+  }
+
+  std::vector<DetectedHit> detectedHits[MAX_PAD_COUNT];
+  time_us_t lastHitTimesUs[MAX_PAD_COUNT] = {};
+
+  const time_us_t startTimeUs = micros();
+  const time_us_t durationUs = pattern.getDurationUs();
+  time_us_t timeUs;
+  while ((timeUs = micros() - startTimeUs) < durationUs) {
+    for (pad_size_t padIndex = 0; padIndex < drumKit.getPadsCount(); ++padIndex) {
+      if (isPadUsed[padIndex]) {
+        setPadPinValue(*drumKit.getPad(padIndex), 0, pattern.getValue(padIndex, timeUs));
+      }
+    }
+
+    drumKit.updateDrums();
+    ++result.updateCount;
+    if (isVirtualClockEnabled()) {
+      advanceVirtualClock(virtualUpdatePeriodUs);
+    }
+
+    const time_us_t reportTimeUs = micros() - startTimeUs;
+    for (pad_size_t padIndex = 0; padIndex < drumKit.getPadsCount(); ++padIndex) {
+      const DrumPad& pad = *drumKit.getPad(padIndex);
+      if (pad.isHit() && pad.hitTimeUs != lastHitTimesUs[padIndex]) {
+        lastHitTimesUs[padIndex] = pad.hitTimeUs;
+        detectedHits[padIndex].push_back({pad.hitTimeUs - startTimeUs, reportTimeUs, pad.maxZoneValues[0]});
+      }
+    }
+  }
+
+  for (pad_size_t padIndex = 0; padIndex < drumKit.getPadsCount(); ++padIndex) {
+    setPadPinValue(*drumKit.getPad(padIndex), 0, 0);
+  }
+
+  uint64_t peakErrorSum = 0;
+  uint64_t latencySum = 0;
+  for (pad_size_t padIndex = 0; padIndex < drumKit.getPadsCount(); ++padIndex) {
+    evaluatePadHits(pattern, padIndex, detectedHits[padIndex], result, peakErrorSum, latencySum);
+  }
+  if (result.detectedCount > 0) {
+    result.meanPeakError = (float) peakErrorSum / result.detectedCount;
+    result.meanLatencyUs = (float) latencySum / result.detectedCount;
+  }
+  return result;
+}
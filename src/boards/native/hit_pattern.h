@@ -0,0 +1,89 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "simulation.h"
+
+#include <vector>
+
+struct SyntheticHit {
+  pad_size_t padIndex;
+  time_us_t timeUs; // relative to the start of the pattern
+  sensor_value_t peak;
+};
+
+/**
+ * Shape of the synthesized piezo signal of a hit: a linear rise to the peak followed by a
+ * decaying oscillation. Only the magnitude matters as the sensing removes the sign.
+ */
+struct HitWaveform {
+  time_us_t riseTimeUs = 300;
+  time_us_t decayTimeUs = 3000; // time constant of the exponential decay
+  time_us_t ringPeriodUs = 1600; // period of the oscillation of the piezo
+  time_us_t lengthUs = 40000; // the signal is cut after this time
+};
+
+/**
+ * A synthetic hit pattern with its ground truth, e.g. rolls, flams or hits in the mask time of another pad.
+ * The signals of hits on the same pad add up, so fast rolls overlap like on a real pad.
+ */
+class HitPattern {
+public:
+  void clear() { hits.clear(); }
+
+  void addHit(pad_size_t padIndex, time_us_t timeUs, sensor_value_t peak);
+
+  /**
+   * Adds a roll with the given rate on all pads simultaneously.
+   */
+  void addRoll(const pad_size_t* padIndices, pad_size_t padCount, time_us_t startTimeUs, uint16_t rateHz, uint16_t hitCount, sensor_value_t peak);
+
+  /**
+   * Adds a flam, i.e. a soft grace note shortly before the main hit.
+   */
+  void addFlam(pad_size_t padIndex, time_us_t timeUs, time_us_t spacingUs, sensor_value_t gracePeak, sensor_value_t peak);
+
+  /**
+   * Value of the signal of a pad at the given time, as expected by setPadPinValue().
+   */
+  sensor_value_t getValue(pad_size_t padIndex, time_us_t timeUs) const;
+
+  // end of the last hit including the decay of its signal
+  time_us_t getDurationUs() const;
+
+  const std::vector<SyntheticHit>& getHits() const { return hits; }
+
+  HitWaveform& getWaveform() { return waveform; }
+  const HitWaveform& getWaveform() const { return waveform; }
+
+private:
+  HitWaveform waveform;
+  std::vector<SyntheticHit> hits; // ordered by time
+};
+
+struct HitPatternResult {
+  uint32_t hitCount = 0; // ground truth
+  uint32_t detectedCount = 0; // detected hits that match a hit of the ground truth
+  uint32_t mergedCount = 0; // hits in the scan or mask time of a detected hit of the same pad
+  uint32_t missedCount = 0;
+  uint32_t extraCount = 0; // detected hits without a hit in the ground truth, e.g. retriggers
+
+  float meanPeakError = 0; // measured peak compared to the peak of the signal
+  sensor_value_t maxPeakError = 0;
+  float meanLatencyUs = 0; // time from the start of a hit until the hit was detected
+  time_us_t maxLatencyUs = 0;
+
+  uint32_t updateCount = 0;
+
+  String toString() const;
+};
+
+/**
+ * Feeds the pattern through setPadPinValue() into the kit and compares the detected hits
+ * against the ground truth. Only the first zone of the pads is used.
+ *
+ * The pattern runs in real time, unless the virtual clock is enabled. Then the clock is advanced
+ * by virtualUpdatePeriodUs after each update, so the result does not depend on the host.
+ */
+HitPatternResult runHitPattern(const HitPattern& pattern, time_us_t virtualUpdatePeriodUs = 100);
@@ -0,0 +1,38 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "midi_transport_capture.h"
+
+#include <stdio.h>
+
+static bool parseMidiMessageType(const String& value, MidiMessageType& result) {
+  for (MidiMessageType type : {MidiMessageType::NoteOn, MidiMessageType::NoteOff,
+      MidiMessageType::ChannelAfterTouch, MidiMessageType::PolyAfterTouch, MidiMessageType::ControlChange}) {
+    if (value.equalsIgnoreCase(midiMessageTypeToString(type))) {
+      result = type;
+      return true;
+    }
+  }
+  return false;
+}
+
+String CapturedMidiMessage::toString() const {
+  return String(timeUs) + " " + midiMessageTypeToString(message.type)
+    + " " + message.channel + " " + message.data1 + " " + message.data2;
+}
+
+bool CapturedMidiMessage::parse(const String& line, CapturedMidiMessage& result) {
+  unsigned long time;
+  char type[24];
+  unsigned int channel, data1, data2;
+  if (sscanf(line.c_str(), "%lu %23s %u %u %u", &time, type, &channel, &data1, &data2) != 5
+      || !parseMidiMessageType(type, result.message.type)) {
+    return false;
+  }
+
+  result.timeUs = time;
+  result.message.channel = channel;
+  result.message.data1 = data1;
+  result.message.data2 = data2;
+  return true;
+}
@@ -0,0 +1,78 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "midi_transport_queue.h"
+#include "types.h"
+
+#include <vector>
+
+inline String midiMessageTypeToString(MidiMessageType value) {
+  using enum MidiMessageType;
+  MAP_ENUM_TO_STRING(NoteOn);
+  MAP_ENUM_TO_STRING(NoteOff);
+  MAP_ENUM_TO_STRING(ChannelAfterTouch);
+  MAP_ENUM_TO_STRING(PolyAfterTouch);
+  MAP_ENUM_TO_STRING(ControlChange);
+  return ENUM_TO_STRING(NoteOn);
+}
+
+struct CapturedMidiMessage {
+  time_us_t timeUs; // relative to the start of the capture
+  MidiMessage message;
+
+  /**
+   * One line per message: "<timeUs> <type> <channel> <data1> <data2>", e.g. "12300 NoteOn 10 38 96"
+   */
+  String toString() const;
+  static bool parse(const String& line, CapturedMidiMessage& result);
+};
+
+/**
+ * Records all messages with the time they were sent, e.g. to compare the output of the sensing
+ * with a golden file. Use it with the virtual clock to get results that do not depend on the host.
+ */
+class MidiTransport_Capture : public MidiTransport {
+public:
+  void start(MidiOutputMode mode) override {}
+
+  void sendNoteOn(uint8_t inNoteNumber, uint8_t inVelocity, midi_channel_t inChannel) override {
+    capture({MidiMessageType::NoteOn, inNoteNumber, inVelocity, inChannel});
+  }
+
+  void sendNoteOff(uint8_t inNoteNumber, uint8_t inVelocity, midi_channel_t inChannel) override {
+    capture({MidiMessageType::NoteOff, inNoteNumber, inVelocity, inChannel});
+  }
+
+  void sendAfterTouch(uint8_t inPressure, midi_channel_t inChannel) override {
+    capture({MidiMessageType::ChannelAfterTouch, inPressure, 0, inChannel});
+  }
+
+  void sendAfterTouch(uint8_t inNoteNumber, uint8_t inPressure, midi_channel_t inChannel) override {
+    capture({MidiMessageType::PolyAfterTouch, inNoteNumber, inPressure, inChannel});
+  }
+
+  void sendControlChange(uint8_t inControlNumber, uint8_t inControlValue, midi_channel_t inChannel) override {
+    capture({MidiMessageType::ControlChange, inControlNumber, inControlValue, inChannel});
+  }
+
+  /**
+   * Removes all captured messages. The time of the next messages is relative to now.
+   */
+  void clear() {
+    messages.clear();
+    startTimeUs = micros();
+  }
+
+  const std::vector<CapturedMidiMessage>& getMessages() const { return messages; }
+
+private:
+  void capture(const MidiMessage& message) {
+    messages.push_back({micros() - startTimeUs, message});
+  }
+
+private:
+  std::vector<CapturedMidiMessage> messages;
+  time_us_t startTimeUs = 0;
+};
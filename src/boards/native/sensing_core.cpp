@@ -0,0 +1,15 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "sensing_core.h"
+
+#include <thread>
+
+bool SensingCore::startOwnCore() {
+  std::thread([]() {
+    while (true) {
+      SensingCore::update();
+    }
+  }).detach();
+  return true;
+}
@@ -16,3 +16,7 @@
 extern DrumKit drumKit;
 
 void setPadPinValue(const DrumPad& pad, zone_size_t zone, sensor_value_t value);
+
+// raw ADC values of the inputs, i.e. including the voltage offset of the mux inputs
+void setMuxInValue(mux_size_t mux, channel_size_t channel, sensor_value_t rawValue);
+void setAnalogInValue(pin_size_t pin, sensor_value_t rawValue);
@@ -2,17 +2,21 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "log.h"
+#include "sensing_core.h"
 #include "simulation.h"
 
 #define MAX_PINS 50
 sensor_value_t analogInValues[MAX_PINS];
 sensor_value_t muxInValues[MAX_MUX_COUNT][MAX_CHANNEL_COUNT];
+pin_status_t digitalOutValues[MAX_PINS];
+pin_size_t framePin = PIN_UNUSED;
 
 extern void handleReset();
 
 void DrumIO::setup(bool usePwmPowerSupply) {
   for (int i = 0; i < MAX_PINS; ++i) {
     analogInValues[i] = 0; // assume analog in is just used for unsigned values
+    digitalOutValues[i] = HIGH;
   }
 
   for (int mux = 0; mux < MAX_MUX_COUNT; ++mux) {
@@ -33,16 +37,49 @@ sensor_value_t DrumIO::readAnalogInPin(pin_size_t pin) {
   return analogInValues[pin];
 }
 
-// overwrites weak function in drum_mux.cpp
-sensor_value_t readMuxChannel(channel_size_t channel, pin_size_t analogInPin) {
-  for (int muxIndex = 0; muxIndex < drumKit.getMuxCount(); ++muxIndex) {
+void DrumIO::beginAnalogInFrame() {
+}
+
+void DrumIO::startAnalogInFramePin(pin_size_t pin) {
+  framePin = pin;
+}
+
+// emulates the muxes by evaluating the state of their enable and select pins at the end of the conversion
+sensor_value_t DrumIO::finishAnalogInFramePin() {
+  const DrumMux* enabledMux = nullptr;
+  mux_size_t enabledMuxIndex = 0;
+  for (mux_size_t muxIndex = 0; muxIndex < drumKit.getMuxCount(); ++muxIndex) {
     const DrumMux& mux = *drumKit.getMux(muxIndex);
-    if (mux.getAnalogInPin() == analogInPin) {
-      return muxInValues[muxIndex][channel];
+    if (mux.getAnalogInPin() != framePin) {
+      continue;
+    }
+
+    pin_size_t enablePin = mux.getEnablePin();
+    if (enablePin != PIN_UNUSED && digitalOutValues[enablePin] != LOW) {
+      continue; // other muxes might share the same analog in pin
+    }
+
+    if (enabledMux) {
+      return INVALID_SENSOR_VALUE; // outputs of multiple muxes are shorted
+    }
+    enabledMux = &mux;
+    enabledMuxIndex = muxIndex;
+  }
+
+  if (!enabledMux) {
+    return analogInValues[framePin];
+  }
+
+  channel_size_t channel = 0;
+  for (pin_size_t selectPinIndex = 0; selectPinIndex < enabledMux->getSelectPinsCount(); ++selectPinIndex) {
+    if (digitalOutValues[enabledMux->getSelectPin(selectPinIndex)] == HIGH) {
+      channel |= (1 << selectPinIndex);
     }
   }
-    
-  return ZERO_OFFSET;
+  return muxInValues[enabledMuxIndex][channel];
+}
+
+void DrumIO::endAnalogInFrame() {
 }
 
 void setPadPinValue(const DrumPad& pad, zone_size_t zone, sensor_value_t value) {
@@ -57,11 +94,26 @@ void setPadPinValue(const DrumPad& pad, zone_size_t zone, sensor_value_t value)
   }
 }
 
+void setMuxInValue(mux_size_t mux, channel_size_t channel, sensor_value_t rawValue) {
+  if (mux < MAX_MUX_COUNT && channel < MAX_CHANNEL_COUNT) {
+    muxInValues[mux][channel] = rawValue;
+  }
+}
+
+void setAnalogInValue(pin_size_t pin, sensor_value_t rawValue) {
+  if (pin < MAX_PINS) {
+    analogInValues[pin] = rawValue;
+  }
+}
+
 bool DrumIO::initDigitalOutPin(pin_size_t pin) {
   return true;
 }
 
 void DrumIO::writeDigitalOutPin(pin_size_t pinNumber, pin_status_t status) {
+  if (pinNumber < MAX_PINS) {
+    digitalOutValues[pinNumber] = status;
+  }
 }
 
 void DrumIO::led(LedId id, bool enable) {
@@ -71,7 +123,8 @@ void DrumIO::update() {
 }
 
 bool DrumIO::requestReset(uint32_t delayMs) {
-  drumKit = DrumKit();
+  SensingPause sensingPause;
+  drumKit.reset();
   DrumConfigMapper::loadAndApplyDrumKitConfig(drumKit);
   logInfo("Soft reset performed\n");
   return false;
@@ -86,6 +139,10 @@ void DrumIO::getMemoryStats(uint32_t& total, uint32_t& free) {
   free = 0;
 }
 
+uint32_t DrumIO::getMinFreeHeap() {
+  return 0;
+}
+
 pin_size_t DrumIO::getMidiTxPin(HardwareSerial& serial) {
   return PIN_UNUSED;
 }
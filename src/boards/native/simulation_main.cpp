@@ -1,10 +1,13 @@
 // Copyright (c) 2025 Tobias Gunkel
 // SPDX-License-Identifier: GPL-3.0-or-later
 
+#include "adc_trace_replay.h"
 #include "log.h"
+#include "loop_profiler.h"
 #include "pad_sound_playback.h"
 #include "simulation.h"
 #include "monitor.h"
+#include "sensing_core.h"
 #include "usb_device.h"
 
 #include <Arduino.h>
@@ -41,6 +44,9 @@ static sensor_value_t sensorValue = 0;
 
 static std::shared_ptr<PadSoundPlayback> padPlayback;
 
+static std::unique_ptr<AdcTraceReplay> traceReplay;
+static time_us_t traceStartTimeUs = 0;
+
 void UsbDevice::begin() {}
 void UsbDevice::update() {}
 
@@ -64,6 +70,30 @@ void updatePlayback() {
   }
 }
 
+static void logLoopProfile() {
+#ifdef ENABLE_LOOP_PROFILER
+  SensingPause sensingPause; // the histograms of the sensing are written by the sensing core
+  printf("Loop profile:\n%s\n", loopProfiler.toString().c_str());
+#endif
+}
+
+// replays the trace in real time
+void updateTraceReplay() {
+  if (!traceReplay) {
+    return;
+  }
+
+  const time_us_t elapsedUs = micros() - traceStartTimeUs;
+  while (traceReplay->getTimeUs() <= elapsedUs) {
+    if (!traceReplay->nextFrame()) {
+      logInfo("Trace replay finished\n");
+      logLoopProfile();
+      traceReplay.reset();
+      return;
+    }
+  }
+}
+
 void updateSignal() {
   const DrumPad* pad = drumKit.getMonitor().getMonitoredPad();
   if (pad && jitterLevel) {
@@ -126,6 +156,11 @@ static void handleInput() {
     return;
   }
 
+  if (key == 'p') {
+    logLoopProfile();
+    return;
+  }
+
   CommandAction action;
   const DrumPad* hitPad = getHitPadAndAction(key, action);
   if (action == CommandAction::Increase) {
@@ -144,12 +179,22 @@ static void handleInput() {
   }
 }
 
-int main() {
+int main(int argc, char** argv) {
   setup();
 
+  if (argc > 1) { // raw ADC trace to replay
+    traceReplay = std::make_unique<AdcTraceReplay>();
+    if (traceReplay->loadFile(argv[1])) {
+      traceStartTimeUs = micros();
+    } else {
+      traceReplay.reset();
+    }
+  }
+
   while (true) {
     handleInput();
     updatePlayback();
+    updateTraceReplay();
     updateSignal();
     loop();
   }
@@ -182,6 +182,8 @@ void MidiTransport_BleClient::stop() {
 }
 
 void MidiTransport_BleClient::update() {
+  flush(); // messages that waited until the stack sent the previous packet
+
   updateScanStatus(scanStartTimeMs);
 
   uint32_t currentTimeMs = millis();
@@ -58,6 +58,8 @@ void MidiTransport_BleServer::stop() {
 }
 
 void MidiTransport_BleServer::update() {
+  flush(); // messages that waited until the stack sent the previous packet
+
   uint32_t currentTimeMs = millis();
 
   static uint32_t lastSyncTimeMs = 0;
@@ -68,6 +70,22 @@ void MidiTransport_BleServer::update() {
   }
 }
 
-size_t MidiTransport_BleServer::write(uint8_t b) {
-  return ble_midi_server_stream_write(1, &b);
+bool MidiTransport_BleServer::isConnected() {
+  return ble_midi_server_is_connected();
+}
+
+bool MidiTransport_BleServer::writePacket(const uint8_t* packet, size_t size) {
+  return ble_midi_server_packet_write(size, packet) > 0;
+}
+
+size_t MidiTransport_BleServer::getMaxPacketSize() {
+  return ble_midi_server_get_max_packet_size();
+}
+
+size_t MidiTransport_BleServer::getFreePacketCount() {
+  return ble_midi_server_get_num_free_packets();
+}
+
+bool MidiTransport_BleServer::isPacketPending() {
+  return ble_midi_server_is_packet_pending();
 }
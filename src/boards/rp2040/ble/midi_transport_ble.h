@@ -0,0 +1,148 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <algorithm>
+#include "midi_transport.h"
+#include "ble_midi_packet.h"
+
+/**
+ * Base of the BLE MIDI client and server transports.
+ *
+ * A BLE-MIDI packet can only be sent at the next connection event (every 7.5 - 15ms), so the messages
+ * are collected in one packet (see BleMidiPacketEncoder) instead of sending a packet per message,
+ * which could take several connection events for the pads of a single hit.
+ * The packet is passed to the stack if the stack has sent the previous one, i.e. the stack asked for the
+ * next packet when it could send it. Until then further messages are added to the open packet.
+ * If the send buffer of the stack is full, the packet is kept and the output is held back (see getWriteCapacity()).
+ * Messages that end a note and still do not fit are kept in a small overflow and sent on the next flush,
+ * other messages are dropped.
+ */
+class MidiTransport_Ble : public MidiTransport {
+public:
+  virtual void begin() = 0;
+
+  void start(MidiOutputMode) override {
+    encoder.clear();
+    overflowCount = 0;
+    begin();
+  }
+
+  void flush() override {
+    sendOverflow();
+    if (encoder.isEmpty()) {
+      return;
+    }
+    // the messages until the stack can send the previous packet are added to this packet
+    if (isPacketPending()) {
+      return;
+    }
+    sendPacket();
+  }
+
+  /**
+   * Free space of the open packet and of the send buffer of the stack. The open packet is only counted
+   * if it can be passed to the stack when the next message does not fit into it anymore.
+   */
+  size_t getWriteCapacity() override {
+    if (!isConnected()) {
+      return SIZE_MAX; // the messages are dropped anyway
+    }
+    const size_t freePacketCount = getFreePacketCount();
+    if (freePacketCount == 0 || overflowCount > 0) {
+      return 0;
+    }
+    const size_t maxPacketSize = encoder.isEmpty() ? getMaxPacketSize() : encoder.getMaxPacketSize();
+    const size_t freeSize = (maxPacketSize - encoder.getPacketSize()) + (freePacketCount - 1) * (maxPacketSize - 1);
+    // a message needs a timestamp byte in addition to its MIDI bytes
+    return freeSize / (MIDI_MAX_MESSAGE_SIZE + 1) * MIDI_MAX_MESSAGE_SIZE;
+  }
+
+  uint32_t getDroppedCount() const override { return droppedCount; }
+
+  void sendMessage(const MidiMessage& message) override {
+    // the overflow is older than the message, so the message has to wait behind it
+    if (!sendOverflow() || !addMessage(message)) {
+      // the write capacity was ignored, only messages that end a note are kept to avoid stuck notes
+      if (MidiPriorityQueue::endsNote(message.type) && overflowCount < BLE_MIDI_OVERFLOW_SIZE) {
+        overflow[overflowCount++] = message;
+      } else {
+        ++droppedCount;
+      }
+    }
+  }
+
+  void sendNoteOn(uint8_t inNoteNumber, uint8_t inVelocity, midi_channel_t inChannel) override {
+    sendMessage({MidiMessageType::NoteOn, inNoteNumber, inVelocity, inChannel, micros()});
+  }
+
+  void sendNoteOff(uint8_t inNoteNumber, uint8_t inVelocity, midi_channel_t inChannel) override {
+    sendMessage({MidiMessageType::NoteOff, inNoteNumber, inVelocity, inChannel, micros()});
+  }
+
+  void sendAfterTouch(uint8_t inPressure, midi_channel_t inChannel) override {
+    sendMessage({MidiMessageType::ChannelAfterTouch, inPressure, 0, inChannel, micros()});
+  }
+
+  void sendAfterTouch(uint8_t inNoteNumber, uint8_t inPressure, midi_channel_t inChannel) override {
+    sendMessage({MidiMessageType::PolyAfterTouch, inNoteNumber, inPressure, inChannel, micros()});
+  }
+
+  void sendControlChange(uint8_t inControlNumber, uint8_t inControlValue, midi_channel_t inChannel) override {
+    sendMessage({MidiMessageType::ControlChange, inControlNumber, inControlValue, inChannel, micros()});
+  }
+
+protected:
+  virtual bool isConnected() = 0;
+  // returns false if the send buffer of the stack is full
+  virtual bool writePacket(const uint8_t* packet, size_t size) = 0;
+  virtual size_t getMaxPacketSize() = 0;
+  // number of packets that fit into the send buffer of the stack
+  virtual size_t getFreePacketCount() = 0;
+  // true if a packet in the send buffer waits until the stack can send it
+  virtual bool isPacketPending() = 0;
+
+private:
+  // returns false if the message neither fits into the open packet nor into a new one
+  bool addMessage(const MidiMessage& message) {
+    if (encoder.isEmpty()) {
+      encoder.setMaxPacketSize(getMaxPacketSize()); // the MTU might have changed
+    }
+    if (encoder.addMessage(message)) {
+      return true;
+    }
+    return sendPacket() && encoder.addMessage(message);
+  }
+
+  // returns false if messages are left in the overflow
+  bool sendOverflow() {
+    uint8_t sentCount = 0;
+    while (sentCount < overflowCount && addMessage(overflow[sentCount])) {
+      ++sentCount;
+    }
+    std::copy(overflow + sentCount, overflow + overflowCount, overflow);
+    overflowCount -= sentCount;
+    return overflowCount == 0;
+  }
+
+  // the packet is dropped if not connected and kept if the stack cannot take it
+  bool sendPacket() {
+    if (!isConnected()) {
+      droppedCount += encoder.getMessageCount();
+    } else if (!writePacket(encoder.getPacket(), encoder.getPacketSize())) {
+      return false;
+    }
+    encoder.clear();
+    return true;
+  }
+
+private:
+  // messages that end a note are kept here if the stack is full (e.g. when an output is too slow)
+  static constexpr uint8_t BLE_MIDI_OVERFLOW_SIZE = 8;
+
+  BleMidiPacketEncoder encoder;
+  MidiMessage overflow[BLE_MIDI_OVERFLOW_SIZE];
+  uint8_t overflowCount = 0;
+  uint32_t droppedCount = 0;
+};
@@ -3,16 +3,23 @@
 
 #pragma once
 
-#include "midi_transport_arduino_midi.h"
+#include "midi_transport_ble.h"
 #include "ble_midi_client.h"
 
-class MidiTransport_BleClient : public MidiTransport_ArduinoMidi {
+class MidiTransport_BleClient : public MidiTransport_Ble {
 public:
   void begin() override;
   void stop() override;
   void update() override;
 
-  size_t write(uint8_t b) override {
-    return ble_midi_client_stream_write(1, &b);
+protected:
+  bool isConnected() override { return ble_midi_client_is_ready(); }
+
+  bool writePacket(const uint8_t* packet, size_t size) override {
+    return ble_midi_client_packet_write(size, packet) > 0;
   }
+
+  size_t getMaxPacketSize() override { return ble_midi_client_get_max_packet_size(); }
+  size_t getFreePacketCount() override { return ble_midi_client_get_num_free_packets(); }
+  bool isPacketPending() override { return ble_midi_client_is_packet_pending(); }
 };
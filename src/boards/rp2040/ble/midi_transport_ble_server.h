@@ -3,13 +3,18 @@
 
 #pragma once
 
-#include "midi_transport_arduino_midi.h"
+#include "midi_transport_ble.h"
 
-class MidiTransport_BleServer : public MidiTransport_ArduinoMidi {
+class MidiTransport_BleServer : public MidiTransport_Ble {
 public:
   void begin() override;
   void stop() override;
   void update() override;
 
-  size_t write(uint8_t b) override;
+protected:
+  bool isConnected() override;
+  bool writePacket(const uint8_t* packet, size_t size) override;
+  size_t getMaxPacketSize() override;
+  size_t getFreePacketCount() override;
+  bool isPacketPending() override;
 };
@@ -38,13 +38,21 @@
 
 static dma_channel_config adcDmaCfg;
 static uint adcDmaChannel;
+
+// the DMA write address wraps around inside this buffer during a frame, so it can be re-triggered without reconfiguration
+#define FRAME_SAMPLES_RING_BITS 1
+static_assert((1 << FRAME_SAMPLES_RING_BITS) == NUM_SAMPLES, "NUM_SAMPLES must match the size of the DMA write ring");
+static uint8_t frameSamples[NUM_SAMPLES] __attribute__((aligned(NUM_SAMPLES)));
+static int frameAdcInput = -1;
 static uint32_t resetScheduledAtMs = 0;
+static uint32_t minFreeHeap = UINT32_MAX;
 
 static bool hasLed3 = false;
 
 static void ledInit();
 static void buttonInit();
 static void adcInit();
+static void updateMinFreeHeap();
 
 void DrumIO::setup(bool usePwmPowerSupply) {
 #ifdef WATCHDOG_TIMEOUT_MS
@@ -119,10 +127,7 @@ static void readAdcPinInternal(pin_size_t pin, uint8_t* captureBuffer, uint8_t n
   adc_run(false);
 }
 
-sensor_value_t DrumIO::readAnalogInPin(pin_size_t pin) {
-  uint8_t samples[NUM_SAMPLES];
-  readAdcPinInternal(pin, samples, NUM_SAMPLES);
-
+static inline sensor_value_t averageSamples(const uint8_t* samples) {
   unsigned int sum = 0;
   for (uint8_t i = 0; i < NUM_SAMPLES; ++i) {
     sum += samples[i];
@@ -130,6 +135,48 @@ sensor_value_t DrumIO::readAnalogInPin(pin_size_t pin) {
   return (sum / NUM_SAMPLES) << 2;
 }
 
+sensor_value_t DrumIO::readAnalogInPin(pin_size_t pin) {
+  uint8_t samples[NUM_SAMPLES];
+  readAdcPinInternal(pin, samples, NUM_SAMPLES);
+  return averageSamples(samples);
+}
+
+void DrumIO::beginAnalogInFrame() {
+  dma_channel_config frameDmaCfg = adcDmaCfg;
+  channel_config_set_ring(&frameDmaCfg, true, FRAME_SAMPLES_RING_BITS);
+
+  dma_channel_configure(adcDmaChannel, &frameDmaCfg,
+      frameSamples, // dst
+      &adc_hw->fifo, // src
+      NUM_SAMPLES, // transfer count
+      false // started by readAnalogInFramePin()
+  );
+
+  frameAdcInput = -1;
+}
+
+void DrumIO::startAnalogInFramePin(pin_size_t pin) {
+  int adcInput = pin - __FIRSTANALOGGPIO;
+  if (adcInput != frameAdcInput) { // muxes usually share the same ADC input
+    adc_select_input(adcInput);
+    frameAdcInput = adcInput;
+  }
+  adc_fifo_drain();
+
+  dma_channel_set_trans_count(adcDmaChannel, NUM_SAMPLES, true);
+  adc_run(true);
+}
+
+sensor_value_t DrumIO::finishAnalogInFramePin() {
+  dma_channel_wait_for_finish_blocking(adcDmaChannel);
+  adc_run(false);
+
+  return averageSamples(frameSamples);
+}
+
+void DrumIO::endAnalogInFrame() {
+}
+
 bool DrumIO::initDigitalOutPin(pin_size_t pin) {
   if (pin < 0 || pin >= __GPIOCNT) {
     return false;
@@ -245,6 +292,7 @@ void reset() {
 
 void DrumIO::update() {
   blinkLed();
+  updateMinFreeHeap();
 #ifdef WATCHDOG_TIMEOUT_MS
   watchdog_update();
 #endif
@@ -273,6 +321,20 @@ void DrumIO::getMemoryStats(uint32_t& total, uint32_t& free) {
   free = rp2040.getFreeHeap();
 }
 
+// newlib trims the arena when memory is freed, so its size is no high-water mark. The free heap is sampled
+// on every update instead, peaks between two updates of the main loop are missed.
+static void updateMinFreeHeap() {
+  const uint32_t freeHeap = rp2040.getFreeHeap();
+  if (freeHeap < minFreeHeap) {
+    minFreeHeap = freeHeap;
+  }
+}
+
+uint32_t DrumIO::getMinFreeHeap() {
+  updateMinFreeHeap();
+  return minFreeHeap;
+}
+
 pin_size_t DrumIO::getMidiTxPin(HardwareSerial& serial) {
   if (&serial == &SerialTx2 || &serial == &Serial2) {
     return drumKit.getBoardVersion() == BoardVersion::V1_1
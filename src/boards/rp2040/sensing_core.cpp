@@ -0,0 +1,21 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "sensing_core.h"
+
+#include <Arduino.h>
+
+// core1 is started by the Arduino core as soon as setup1() / loop1() are defined,
+// but it must not sense before the config was loaded by setup() on core0.
+bool SensingCore::startOwnCore() {
+  return true;
+}
+
+void setup1() {
+}
+
+void loop1() {
+  if (SensingCore::isRunningOnOwnCore()) {
+    SensingCore::update();
+  }
+}
@@ -14,6 +14,9 @@
 #define GENERAL_BOARD "board"
 #define GENERAL_GATETIME "gateTimeMs"
 #define GENERAL_MIDI_OUTPUT_MODE "midiOutputMode"
+#define GENERAL_MIDI_FAN_OUT_MODES "midiFanOutModes"
+#define GENERAL_MIDI_CONSTANT_LATENCY "midiConstantLatencyUs"
+#define GENERAL_SCAN_OVERSAMPLING "scanOversampling"
 
 #define GENERAL_BLE_PAIRING "blePairing"
 #define GENERAL_BLE_PAIRING_NAME "name"
@@ -64,12 +67,29 @@ void DrumConfigMapper::applyGeneralConfig(DrumKit& drumKit, JsonObjectConst gene
     drumKit.setGateTime(generalNode[GENERAL_GATETIME].as<int>());
   }
 
+  if (generalNode[GENERAL_SCAN_OVERSAMPLING].is<int>()) {
+    drumKit.setScanOversampling(generalNode[GENERAL_SCAN_OVERSAMPLING].as<int>());
+  }
+
   if (generalNode[GENERAL_MIDI_OUTPUT_MODE].is<String>()) {
     String modeStr = generalNode[GENERAL_MIDI_OUTPUT_MODE].as<String>();
     MidiOutputMode mode = parseMidiOutputMode(modeStr);
     drumKit.setMidiOutputMode(mode);
   }
 
+  JsonArrayConst fanOutModesNode = generalNode[GENERAL_MIDI_FAN_OUT_MODES];
+  if (fanOutModesNode) {
+    std::vector<MidiOutputMode> fanOutModes;
+    for (JsonVariantConst modeNode : fanOutModesNode) {
+      fanOutModes.push_back(parseMidiOutputMode(modeNode.as<String>()));
+    }
+    drumKit.setMidiFanOutModes(fanOutModes);
+  }
+
+  if (generalNode[GENERAL_MIDI_CONSTANT_LATENCY].is<int>()) {
+    drumKit.setMidiConstantLatency(max(0, generalNode[GENERAL_MIDI_CONSTANT_LATENCY].as<int>()));
+  }
+
 #if HAS_BLUETOOTH
   JsonObjectConst blePairingNode = generalNode[GENERAL_BLE_PAIRING];
   if (blePairingNode) {
@@ -105,9 +125,16 @@ void DrumConfigMapper::convertGeneralConfigToJson(const DrumKit& drumKit, JsonDo
   convertBoardConfigToJson(drumKit, generalNode);
 
   generalNode[GENERAL_GATETIME] = drumKit.getGateTime();
+  generalNode[GENERAL_SCAN_OVERSAMPLING] = drumKit.getScanOversampling();
 
   generalNode[GENERAL_MIDI_OUTPUT_MODE] = midiOutputModeToString(drumKit.getMidiOutputMode());
 
+  JsonArray fanOutModesNode = generalNode[GENERAL_MIDI_FAN_OUT_MODES].to<JsonArray>();
+  for (MidiOutputMode mode : drumKit.getMidiFanOutModes()) {
+    fanOutModesNode.add(midiOutputModeToString(mode));
+  }
+  generalNode[GENERAL_MIDI_CONSTANT_LATENCY] = drumKit.getMidiConstantLatency();
+
 #if HAS_BLUETOOTH
   if (!bleClient.getPairingInfo().address.isEmpty()) {
     JsonObject bleNode = generalNode[GENERAL_BLE_PAIRING].to<JsonObject>();
@@ -7,6 +7,7 @@
 #define SETTINGS_ZONES_TYPE_PROP "zonesType"
 #define SETTINGS_CHOKE_TYPE_PROP "chokeType"
 #define SETTINGS_CURVETYPE_PROP "curveType"
+#define SETTINGS_CUSTOM_CURVE_PROP "customCurve"
 #define SETTINGS_DECAYTYPE_PROP "decayType"
 #define SETTINGS_PAD_TYPE_PROP "padType"
 
@@ -51,6 +52,7 @@ static CurveType mapStringToCurveType(String value) {
   MAP_STRING_TO_ENUM(Exponential2);
   MAP_STRING_TO_ENUM(Logarithmic1);
   MAP_STRING_TO_ENUM(Logarithmic2);
+  MAP_STRING_TO_ENUM(Custom);
   eventLog.log(Level::Warn, String("Unknown curve type '") + value + "' -> using fallback");
   return CURVE_TYPE_DEFAULT;
 }
@@ -69,6 +71,37 @@ static inline void SETTING_FROM_JSON(T& setting, JsonVariantConst settingsNode)
   }
 }
 
+// percentages are stored as fixed-point values for the sensing
+static inline void PERCENT_SETTING_FROM_JSON(percent_q8_t& setting, JsonVariantConst settingsNode) {
+  if (settingsNode.is<float>()) {
+    setting = toPercentQ8(settingsNode.as<float>());
+  }
+}
+
+static void applyCustomCurvePoints(DrumSettings& settings, JsonArrayConst pointsNode) {
+  settings.customCurvePointsCount = 0;
+  for (JsonObjectConst pointNode : pointsNode) {
+    if (settings.customCurvePointsCount >= MAX_CURVE_POINTS) {
+      eventLog.log(Level::Warn, String("Custom curve has more than ") + MAX_CURVE_POINTS + " points -> ignoring the rest");
+      break;
+    }
+
+    CurvePoint point = {0, 127};
+    SETTING_FROM_JSON(point.input, pointNode["input"]);
+    SETTING_FROM_JSON(point.velocity, pointNode["velocity"]);
+    point.input = min(point.input, (uint8_t) 100);
+    point.velocity = constrain(point.velocity, 1, 127);
+
+    // insert sorted by input
+    uint8_t index = settings.customCurvePointsCount++;
+    while (index > 0 && settings.customCurvePoints[index - 1].input > point.input) {
+      settings.customCurvePoints[index] = settings.customCurvePoints[index - 1];
+      --index;
+    }
+    settings.customCurvePoints[index] = point;
+  }
+}
+
 // Note: this will also be called on reconfiguration with a partial config
 void DrumConfigMapper::applyPadSettings(DrumPad& pad, JsonObjectConst settingsNode) {
   DrumSettings& settings = pad.getSettings();
@@ -89,6 +122,11 @@ void DrumConfigMapper::applyPadSettings(DrumPad& pad, JsonObjectConst settingsNo
     settings.decayType = mapStringToDecayType(settingsNode[SETTINGS_DECAYTYPE_PROP]);
   }
 
+  JsonArrayConst customCurveNode = settingsNode[SETTINGS_CUSTOM_CURVE_PROP];
+  if (!customCurveNode.isNull()) {
+    applyCustomCurvePoints(settings, customCurveNode);
+  }
+
   JsonArrayConst zoneThresholdsNode = settingsNode["zoneThresholds"];
   if (!zoneThresholdsNode.isNull()) {
     for (int zone = 0; zone < 3; ++zone) {
@@ -103,8 +141,15 @@ void DrumConfigMapper::applyPadSettings(DrumPad& pad, JsonObjectConst settingsNo
   SETTING_FROM_JSON(settings.scanTimeUs, settingsNode["scanTimeUs"]);
   SETTING_FROM_JSON(settings.maskTimeMs, settingsNode["maskTimeMs"]);
   SETTING_FROM_JSON(settings.decayTimeMs, settingsNode["decayTimeMs"]);
-  SETTING_FROM_JSON(settings.almostClosedThreshold, settingsNode["almostClosedThreshold"]);
-  SETTING_FROM_JSON(settings.closedThreshold, settingsNode["closedThreshold"]);
+  SETTING_FROM_JSON(settings.earlyCommitDropPercent, settingsNode["earlyCommitDropPercent"]);
+  SETTING_FROM_JSON(settings.earlyCommitSampleCount, settingsNode["earlyCommitSampleCount"]);
+  SETTING_FROM_JSON(settings.earlyCommitMinTimeUs, settingsNode["earlyCommitMinTimeUs"]);
+  SETTING_FROM_JSON(settings.predictionEnabled, settingsNode["predictionEnabled"]);
+  SETTING_FROM_JSON(settings.predictionSampleCount, settingsNode["predictionSampleCount"]);
+  SETTING_FROM_JSON(settings.predictionAmplitudeGain, settingsNode["predictionAmplitudeGain"]);
+  SETTING_FROM_JSON(settings.predictionRiseGain, settingsNode["predictionRiseGain"]);
+  PERCENT_SETTING_FROM_JSON(settings.almostClosedThreshold, settingsNode["almostClosedThreshold"]);
+  PERCENT_SETTING_FROM_JSON(settings.closedThreshold, settingsNode["closedThreshold"]);
   SETTING_FROM_JSON(settings.moveDetectTolerance, settingsNode["moveDetectTolerance"]);
   SETTING_FROM_JSON(settings.chickDetectTimeoutMs, settingsNode["chickDetectTimeoutMs"]);
   SETTING_FROM_JSON(settings.crossNoteEnabled, settingsNode["crossNoteEnabled"]);
@@ -129,6 +174,13 @@ enum DrumSettingId {
   MASK_TIME_MS,
   DECAY_TIME_MS,
   DECAY_TYPE,
+  EARLY_COMMIT_DROP_PERCENT,
+  EARLY_COMMIT_SAMPLE_COUNT,
+  EARLY_COMMIT_MIN_TIME_US,
+  PREDICTION_ENABLED,
+  PREDICTION_SAMPLE_COUNT,
+  PREDICTION_AMPLITUDE_GAIN,
+  PREDICTION_RISE_GAIN,
 
   ZONE_THRESHOLDS,
   THRESHOLD_MAX,
@@ -152,6 +204,13 @@ static const DrumSettingId settingItemsDrumOrCymbal[] = {
     MASK_TIME_MS,
     DECAY_TIME_MS,
     DECAY_TYPE,
+    EARLY_COMMIT_DROP_PERCENT,
+    EARLY_COMMIT_SAMPLE_COUNT,
+    EARLY_COMMIT_MIN_TIME_US,
+    PREDICTION_ENABLED,
+    PREDICTION_SAMPLE_COUNT,
+    PREDICTION_AMPLITUDE_GAIN,
+    PREDICTION_RISE_GAIN,
     ZONE_THRESHOLDS};
 const int SETTING_ITEMS_DRUM_OR_CYMBAL_SIZE = sizeof(settingItemsDrumOrCymbal) / sizeof(DrumSettingId);
 
@@ -178,6 +237,12 @@ const int SETTING_ITEMS_PEDAL_CONTROL_SIZE = sizeof(settingItemsPedalControl) /
     return;                                                         \
   }
 
+#define SETTING_TO_JSON_PERCENT(label, ymlName)               \
+  if (settingId == label) {                                   \
+    settingsNode[#ymlName] = fromPercentQ8(settings.ymlName); \
+    return;                                                   \
+  }
+
 static String mapPadTypeToString(PadType value) {
   using enum PadType;
   MAP_ENUM_TO_STRING(Drum);
@@ -217,6 +282,7 @@ static String mapCurveTypeToString(CurveType value) {
   MAP_ENUM_TO_STRING(Exponential2);
   MAP_ENUM_TO_STRING(Logarithmic1);
   MAP_ENUM_TO_STRING(Logarithmic2);
+  MAP_ENUM_TO_STRING(Custom);
   eventLog.log(Level::Warn, String("Unknown curve type '") + (uint8_t)value + "' -> using fallback");
   return mapCurveTypeToString(CURVE_TYPE_DEFAULT);
 }
@@ -246,6 +312,14 @@ static void convertPadSettingToJson(DrumSettingId settingId, JsonObject settings
 
   if (settingId == CURVE_TYPE) {
     settingsNode[SETTINGS_CURVETYPE_PROP] = mapCurveTypeToString(settings.curveType);
+    if (settings.curveType == CurveType::Custom) {
+      JsonArray customCurveNode = settingsNode[SETTINGS_CUSTOM_CURVE_PROP].to<JsonArray>();
+      for (uint8_t index = 0; index < settings.customCurvePointsCount; ++index) {
+        JsonObject pointNode = customCurveNode.add<JsonObject>();
+        pointNode["input"] = settings.customCurvePoints[index].input;
+        pointNode["velocity"] = settings.customCurvePoints[index].velocity;
+      }
+    }
     return;
   }
 
@@ -269,8 +343,15 @@ static void convertPadSettingToJson(DrumSettingId settingId, JsonObject settings
   SETTING_TO_JSON(SCAN_TIME_MS, scanTimeUs)
   SETTING_TO_JSON(MASK_TIME_MS, maskTimeMs)
   SETTING_TO_JSON(DECAY_TIME_MS, decayTimeMs)
-  SETTING_TO_JSON(ALMOST_CLOSED_THRESHOLD, almostClosedThreshold)
-  SETTING_TO_JSON(CLOSED_THRESHOLD, closedThreshold)
+  SETTING_TO_JSON(EARLY_COMMIT_DROP_PERCENT, earlyCommitDropPercent)
+  SETTING_TO_JSON(EARLY_COMMIT_SAMPLE_COUNT, earlyCommitSampleCount)
+  SETTING_TO_JSON(EARLY_COMMIT_MIN_TIME_US, earlyCommitMinTimeUs)
+  SETTING_TO_JSON(PREDICTION_ENABLED, predictionEnabled)
+  SETTING_TO_JSON(PREDICTION_SAMPLE_COUNT, predictionSampleCount)
+  SETTING_TO_JSON(PREDICTION_AMPLITUDE_GAIN, predictionAmplitudeGain)
+  SETTING_TO_JSON(PREDICTION_RISE_GAIN, predictionRiseGain)
+  SETTING_TO_JSON_PERCENT(ALMOST_CLOSED_THRESHOLD, almostClosedThreshold)
+  SETTING_TO_JSON_PERCENT(CLOSED_THRESHOLD, closedThreshold)
   SETTING_TO_JSON_THRESHOLD(MOVE_DETECT_TOLERANCE, moveDetectTolerance, moveDetectTolerance)
   SETTING_TO_JSON(CHICK_DETECT_TIMEOUT, chickDetectTimeoutMs)
   SETTING_TO_JSON(HEAD_RIM_BIAS, headRimBias)
@@ -0,0 +1,56 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "adc_trace.h"
+
+#include <string.h>
+
+size_t encodeAdcTraceFrame(uint8_t* buffer, time_us_t deltaUs, const sensor_value_t* samples, uint8_t slotsCount) {
+  const bool isLongDelta = deltaUs >= ADC_TRACE_LONG_DELTA;
+  const uint16_t delta = isLongDelta ? ADC_TRACE_LONG_DELTA : deltaUs;
+  buffer[0] = delta & 0xFF;
+  buffer[1] = delta >> 8;
+  uint8_t* data = buffer + sizeof(uint16_t);
+  if (isLongDelta) {
+    const uint32_t longDelta = (deltaUs < ADC_TRACE_MAX_DELTA_US) ? deltaUs : ADC_TRACE_MAX_DELTA_US;
+    for (size_t i = 0; i < sizeof(uint32_t); ++i) {
+      data[i] = (longDelta >> (8 * i)) & 0xFF;
+    }
+    data += sizeof(uint32_t);
+  }
+
+  const size_t frameSize = getAdcTraceFrameSize(slotsCount, isLongDelta);
+  memset(data, 0, buffer + frameSize - data);
+
+  // a sample starts at an even bit within a byte, so it never spans more than two bytes
+  uint32_t bitPos = 0;
+  for (uint8_t slot = 0; slot < slotsCount; ++slot) {
+    const uint16_t sample = (samples[slot] < MAX_SENSOR_VALUE) ? samples[slot] : MAX_SENSOR_VALUE;
+    const uint16_t bits = sample << (bitPos % 8);
+    uint8_t* bytes = data + bitPos / 8;
+    bytes[0] |= bits & 0xFF;
+    bytes[1] |= bits >> 8;
+    bitPos += ADC_TRACE_SAMPLE_BITS;
+  }
+  return frameSize;
+}
+
+size_t decodeAdcTraceFrame(const uint8_t* buffer, time_us_t& deltaUs, sensor_value_t* samples, uint8_t slotsCount) {
+  const bool isLongDelta = isAdcTraceLongDelta(buffer);
+  const uint8_t* data = buffer + sizeof(uint16_t);
+  if (isLongDelta) {
+    deltaUs = data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t) data[3] << 24);
+    data += sizeof(uint32_t);
+  } else {
+    deltaUs = buffer[0] | (buffer[1] << 8);
+  }
+
+  uint32_t bitPos = 0;
+  for (uint8_t slot = 0; slot < slotsCount; ++slot) {
+    const uint8_t* bytes = data + bitPos / 8;
+    const uint16_t bits = bytes[0] | (bytes[1] << 8);
+    samples[slot] = (bits >> (bitPos % 8)) & ((1 << ADC_TRACE_SAMPLE_BITS) - 1);
+    bitPos += ADC_TRACE_SAMPLE_BITS;
+  }
+  return getAdcTraceFrameSize(slotsCount, isLongDelta);
+}
@@ -0,0 +1,68 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "packed.h"
+#include "types.h"
+
+#include <stddef.h>
+
+/*
+ * Binary format of raw ADC traces, e.g. to reproduce the sensing of a kit offline with the native simulation.
+ *
+ * A trace starts with an AdcTraceHeader, followed by an AdcTraceSlotInfo for each input of the scan plan.
+ * Then a frame follows for each recorded sweep:
+ *   - uint16 (little endian): time in us since the previous frame, 0 for the first frame
+ *   - only if the uint16 is ADC_TRACE_LONG_DELTA: uint32 (little endian) with the time (saturated),
+ *     e.g. for a gap after dropped frames
+ *   - the raw 10 bit samples of all slots, packed LSB first (4 samples in 5 bytes)
+ *
+ * The trace does not contain the settings of the kit, it has to be replayed with the config it was recorded with.
+ */
+
+#define ADC_TRACE_MAGIC "EDTR"
+#define ADC_TRACE_VERSION 2
+
+// mux index of slots that are read directly from an ADC pin
+#define ADC_TRACE_DIRECT_PIN 0xFF
+
+#define ADC_TRACE_SAMPLE_BITS 10
+#define ADC_TRACE_LONG_DELTA UINT16_MAX
+#define ADC_TRACE_MAX_DELTA_US UINT32_MAX
+
+struct AdcTraceHeader {
+  char magic[4];
+  uint8_t version;
+  uint8_t slotsCount;
+} ATTR_PACKED;
+
+struct AdcTraceSlotInfo {
+  uint8_t muxIndex; // or ADC_TRACE_DIRECT_PIN
+  uint8_t channel; // channel of the mux or the analog in pin
+  uint8_t padIndex; // first pad that uses the input or UNKNOWN_PAD
+  uint8_t pinIndex; // pin of the pad's connector (i.e. the zone)
+} ATTR_PACKED;
+
+inline size_t getAdcTraceFrameSize(uint8_t slotsCount, bool isLongDelta = false) {
+  return sizeof(uint16_t) + (isLongDelta ? sizeof(uint32_t) : 0) + (slotsCount * ADC_TRACE_SAMPLE_BITS + 7) / 8;
+}
+
+/**
+ * Checks if the frame in buffer uses the long delta, only the first two bytes of the frame are read.
+ */
+inline bool isAdcTraceLongDelta(const uint8_t* buffer) {
+  return (buffer[0] | (buffer[1] << 8)) == ADC_TRACE_LONG_DELTA;
+}
+
+/**
+ * Writes a frame with the samples of one sweep. Samples above MAX_SENSOR_VALUE (i.e. invalid samples) are clamped.
+ * @return size of the frame, see getAdcTraceFrameSize()
+ */
+size_t encodeAdcTraceFrame(uint8_t* buffer, time_us_t deltaUs, const sensor_value_t* samples, uint8_t slotsCount);
+
+/**
+ * Reads a frame written by encodeAdcTraceFrame().
+ * @return size of the frame, see getAdcTraceFrameSize()
+ */
+size_t decodeAdcTraceFrame(const uint8_t* buffer, time_us_t& deltaUs, sensor_value_t* samples, uint8_t slotsCount);
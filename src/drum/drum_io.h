@@ -46,6 +46,24 @@ public:
   /** Reads a 10 bit ADC value from the given pin */
   static sensor_value_t readAnalogInPin(pin_size_t pin);
 
+  /**
+   * Prepares the ADC for a sweep of reads with startAnalogInFramePin() / finishAnalogInFramePin().
+   * The ADC must not be read with readAnalogInPin() until endAnalogInFrame() is called.
+   */
+  static void beginAnalogInFrame();
+
+  /**
+   * Starts the conversion of the given pin as part of a sweep.
+   * Other digital out pins may be changed until finishAnalogInFramePin() is called, as long as the input
+   * of the converted pin is not affected.
+   */
+  static void startAnalogInFramePin(pin_size_t pin);
+
+  /** Waits for the conversion started with startAnalogInFramePin() and returns the 10 bit ADC value */
+  static sensor_value_t finishAnalogInFramePin();
+
+  static void endAnalogInFrame();
+
   static bool initDigitalOutPin(pin_size_t pin);
 
   static void writeDigitalOutPin(pin_size_t pin, pin_status_t status);
@@ -67,6 +85,11 @@ public:
 
   static void getMemoryStats(uint32_t& total, uint32_t& free);
 
+  /**
+   * Lowest free heap since the start (i.e. the high-water mark of the heap usage), 0 if unknown.
+   */
+  static uint32_t getMinFreeHeap();
+
   /**
    * Returns the TX pin to use for the selected serial port for MIDI output,
    * or PIN_UNUSED to use the default pin.
@@ -5,8 +5,10 @@
 #include "log.h"
 
 #include "config/config_mapper.h"
+#include "loop_profiler.h"
 #include "midi_transport.h"
 #include "monitor.h"
+#include "sensing_core.h"
 
 #define HIHAT_CC 4
 #define MIDI_CHANNEL 10
@@ -20,6 +22,8 @@ void DrumKit::updateDrums() {
   static uint32_t updateCountPer30s = 0;
   
   time_us_t senseTimeUs = micros();
+  LOOP_PROFILER_START_SENSING(senseTimeUs);
+  LOOP_PROFILER_START(senseTimeUs);
 
   if (senseTimeUs - lastHitTimeUs > HIT_INDICATOR_DELAY_US) {
     DrumIO::led(LedId::HitIndicator, false);
@@ -35,80 +39,255 @@ void DrumKit::updateDrums() {
   sendPendingMidiNoteOffMessages();
 
   readMultiplexers(senseTimeUs);
+  LOOP_PROFILER_END_PHASE(LoopPhase::MuxRead);
   
   if (drumMonitor.isLatencyTestActive()) {
     drumMonitor.updateLatencyTest(senseTimeUs);
     return;
   }
 
-  for (pad_size_t i = 0; i < padsCount; ++i) {
-    DrumPad& pad = pads[i];
-    if (pad.isEnabled()) {
-      evaluatePad(senseTimeUs, pad);
+  const pad_size_t activePadsCount = sensingTable.getActivePadsCount();
+  for (pad_size_t row = 0; row < activePadsCount; ++row) {
+    const pad_size_t padIndex = sensingTable.getActivePadIndex(row);
+    DrumPad& pad = pads[padIndex];
+    // the samples of settling inputs are skipped as they would also shift the offset of the auto calibration
+    if (!isInputPaused(padIndex) && isPadSettled(pad)) {
+      pad.readInputValues(senseTimeUs);
+    } else { // the samples are outdated, only the time is needed for the mask time
+      pad.sampleTimeUs = senseTimeUs;
+    }
+  }
+
+  // skip all pads that are idle, so that only pads with a (possible) hit are evaluated
+  pad_size_t padIndices[MAX_PAD_COUNT];
+  const pad_size_t evaluatePadsCount = sensingTable.findPadsToEvaluate(padIndices);
+  for (pad_size_t i = 0; i < evaluatePadsCount; ++i) {
+    DrumPad& pad = pads[padIndices[i]];
+    if (isPadSettled(pad)) {
+      evaluatePad(pad.sampleTimeUs, pad);
     }
   }
 
+  oversampleScanningPads();
+  LOOP_PROFILER_END_PHASE(LoopPhase::PadEvaluation);
+
   drumMonitor.checkAndSendMonitoredPadHitInfo();
   drumMonitor.checkAndSendNonMonitoredPadHitInfo();
+  LOOP_PROFILER_END_PHASE(LoopPhase::Monitor);
+}
+
+void DrumKit::rebuildScanPlan() {
+  if (adcTraceCapture.isActive()) {
+    adcTraceCapture.abort(); // the trace only contains the slots of the old plan
+  }
+
+  scanner.reset();
+  settlingTracker.reset();
+
+  for (connector_size_t connectorIndex = 0; connectorIndex < connectorsCount; ++connectorIndex) {
+    DrumConnector& connector = connectors[connectorIndex];
+    for (pin_size_t pinIndex = 0; pinIndex < connector.getPinCount(); ++pinIndex) {
+      connector.getPin(pinIndex).sample = nullptr;
+      connector.getPin(pinIndex).sampleTimeUs = nullptr;
+    }
+  }
+
+  // only the pins consumed by enabled pads (and the pedals of enabled hi-hats) are read.
+  // The monitored pad is also read as the latency test might use a disabled pad. Touch sensors are not read by the ADC.
+  bool isPadRead[MAX_PAD_COUNT] = {};
+  const DrumPad* monitoredPad = drumMonitor.getMonitoredPad();
+  if (monitoredPad) {
+    isPadRead[monitoredPad->getIndex()] = true;
+  }
+  for (pad_size_t padIndex = 0; padIndex < padsCount; ++padIndex) {
+    const DrumPad& pad = pads[padIndex];
+    if (pad.isEnabled()) {
+      isPadRead[padIndex] = true;
+      if (pad.getPedalPad()) {
+        isPadRead[pad.getPedalPad()->getIndex()] = true;
+      }
+    }
+  }
+
+  bool isMuxChannelRead[MAX_MUX_COUNT][MAX_CHANNEL_COUNT] = {};
+  for (pad_size_t padIndex = 0; padIndex < padsCount; ++padIndex) {
+    if (!isPadRead[padIndex]) {
+      continue;
+    }
+    const DrumPad& pad = pads[padIndex];
+    for (pin_size_t pinIndex = 0; pinIndex < pad.getActivePinCount(); ++pinIndex) {
+      const DrumPin& pin = pad.getConnector()->getPin(pinIndex);
+      if (pin.mux && pin.mux->isInitialized() && pin.index < pin.mux->getChannelCount()) {
+        isMuxChannelRead[pin.mux - mux][pin.index] = true;
+      }
+    }
+  }
+
+  // interleave the muxes so that switching and settling of one mux can overlap with the conversion of another
+  for (channel_size_t channel = 0; channel < MAX_CHANNEL_COUNT; ++channel) {
+    for (mux_size_t muxIndex = 0; muxIndex < muxCount; ++muxIndex) {
+      if (isMuxChannelRead[muxIndex][channel]) {
+        scanner.addMuxChannel(mux[muxIndex], channel);
+      }
+    }
+  }
+
+  // bind the pins to their slots, the mux channels were already added above
+  for (pad_size_t padIndex = 0; padIndex < padsCount; ++padIndex) {
+    if (!isPadRead[padIndex]) {
+      continue;
+    }
+    DrumPad& pad = pads[padIndex];
+    for (pin_size_t pinIndex = 0; pinIndex < pad.getActivePinCount(); ++pinIndex) {
+      DrumPin& pin = pad.getConnector()->getPin(pinIndex);
+      if (pin.mux) {
+        pin.sample = (pin.index < MAX_CHANNEL_COUNT && isMuxChannelRead[pin.mux - mux][pin.index]) ? scanner.addMuxChannel(*pin.mux, pin.index) : nullptr;
+      } else if (pin.isValid()) {
+        pin.sample = scanner.addDirectPin(pin.index);
+      }
+      if (pin.sample) {
+        const scan_slot_t slot = scanner.getSlotIndex(pin.sample);
+        pin.sampleTimeUs = scanner.getSampleTimeLocation(slot);
+        settlingTracker.addPin(slot, pin);
+      }
+    }
+  }
+
+  // drums do not read their inputs while masked, so their slots are skipped then, unless other pads use them too.
+  // The monitored pad is always read to show its signal.
+  bool isSlotUsed[MAX_SCAN_SLOTS] = {};
+  for (scan_slot_t slot = 0; slot < MAX_SCAN_SLOTS; ++slot) {
+    slotMaskOwners[slot] = UNKNOWN_PAD;
+  }
+  for (pad_size_t padIndex = 0; padIndex < MAX_PAD_COUNT; ++padIndex) {
+    isPausedInMask[padIndex] = false;
+    if (padIndex >= padsCount || !isPadRead[padIndex]) {
+      continue;
+    }
+
+    const DrumPad& pad = pads[padIndex];
+    isPausedInMask[padIndex] = pad.isEnabled() && pad.getPadType() == PadType::Drum && &pad != monitoredPad;
+    for (pin_size_t pinIndex = 0; pinIndex < pad.getActivePinCount(); ++pinIndex) {
+      const sensor_value_t* sample = pad.getConnector()->getPin(pinIndex).sample;
+      if (!sample) {
+        continue;
+      }
+      const scan_slot_t slot = scanner.getSlotIndex(sample);
+      slotMaskOwners[slot] = (!isSlotUsed[slot] && isPausedInMask[padIndex]) ? padIndex : UNKNOWN_PAD;
+      isSlotUsed[slot] = true;
+    }
+  }
+}
+
+/**
+ * Reads the inputs of the pads in the scan time again and evaluates them with the new samples and their time,
+ * so that their peak is captured more accurately and the scan time is tracked in shorter intervals.
+ * Pads whose hit was already detected in this update are not read again until the hit was sent.
+ */
+void DrumKit::oversampleScanningPads() {
+  for (uint8_t pass = 0; pass < scanOversampling; ++pass) {
+    pad_size_t padIndices[MAX_PAD_COUNT];
+    const pad_size_t scanningPadsCount = sensingTable.findScanningPads(padIndices);
+    if (scanningPadsCount == 0) {
+      return;
+    }
+
+    scan_slot_t slotIndices[MAX_SCAN_SLOTS];
+    scan_slot_t slotsCount = 0;
+    for (pad_size_t i = 0; i < scanningPadsCount; ++i) {
+      const DrumPad& pad = pads[padIndices[i]];
+      if (!isPadSettled(pad)) {
+        continue;
+      }
+      for (pin_size_t pinIndex = 0; pinIndex < pad.getActivePinCount(); ++pinIndex) {
+        const sensor_value_t* sample = pad.getConnector()->getPin(pinIndex).sample;
+        if (sample && slotsCount < MAX_SCAN_SLOTS) {
+          slotIndices[slotsCount++] = scanner.getSlotIndex(sample);
+        }
+      }
+    }
+    scanner.sweepSlots(slotIndices, slotsCount);
+
+    const time_us_t senseTimeUs = micros(); // only used if the sample time is unknown
+    for (pad_size_t i = 0; i < scanningPadsCount; ++i) {
+      DrumPad& pad = pads[padIndices[i]];
+      if (isPadSettled(pad)) {
+        pad.readInputValues(senseTimeUs);
+        evaluatePad(pad.sampleTimeUs, pad, true);
+      }
+    }
+  }
 }
 
 void DrumKit::readMultiplexers(time_us_t senseTimeUs) {
 #ifndef SIMULATE_IO
-  stabilizeMultiplexerOffsetVoltage(senseTimeUs);
+  checkMultiplexerIdleTime(senseTimeUs);
 #endif
 
-  for (mux_size_t i = 0; i < muxCount; ++i) {
-    mux[i].scan();
+  // skip the inputs of masked drums, unless a trace is recorded
+  const bool isTraceActive = adcTraceCapture.isActive();
+  for (scan_slot_t slot = 0; slot < scanner.getSlotsCount(); ++slot) {
+    const pad_size_t owner = slotMaskOwners[slot];
+    scanner.setSlotSkipped(slot, !isTraceActive && owner != UNKNOWN_PAD && pads[owner].getSensingState() == SensingState::Mask);
+  }
+
+  scanner.sweep();
+  settlingTracker.update(scanner, micros());
+
+  if (isTraceActive) {
+    adcTraceCapture.recordSweep(scanner);
   }
 }
 
 /**
  * If the multiplexers are not read for a longer time (e.g. because the main loop is busy with webui tasks),
- * the line capacitance of the multiplexer input pins can cause wrong readings as the voltage drops to 0V and
- * needs to be stabilized to the bias voltage first (~1.5V if no pad is hit or switch is pressed).
+ * the inputs with a voltage offset have to settle again before their values can be used, see SettlingTracker.
  * This should only be necessary if the UI is used and not in normal operation.
  */
-void DrumKit::stabilizeMultiplexerOffsetVoltage(time_us_t senseTimeUs) {
+void DrumKit::checkMultiplexerIdleTime(time_us_t senseTimeUs) {
   static time_us_t lastMuxReadTimeUs = 0;
   
   // Note: do not make this too short as the monitor messages take about 600-700us and we do not want them
-  // to cause a flush as we might miss a hit then.
+  // to cause a settling phase as we might miss a hit then.
   // On the opposite side, a blockage of 5ms already caused false hit triggers. So values between 1-4ms should be fine.
-  const time_us_t flushTimeUs = 4 * 1000; // 4ms seems to be a good compromise
-  bool needsFlush = senseTimeUs - lastMuxReadTimeUs > flushTimeUs;
-  if (!needsFlush) {
-    lastMuxReadTimeUs = senseTimeUs;
-    return;
+  const time_us_t maxIdleTimeUs = 4 * 1000; // 4ms seems to be a good compromise
+  const time_us_t idleTimeUs = senseTimeUs - lastMuxReadTimeUs;
+  lastMuxReadTimeUs = senseTimeUs;
+  if (idleTimeUs > maxIdleTimeUs) {
+    ++statistics.muxSettleCount; // counted instead of logged, the sensing core must not block on the serial port
+    settlingTracker.startSettling(senseTimeUs);
   }
-
-  logInfo("Flush Mux: %ld ms", (senseTimeUs - lastMuxReadTimeUs) / 1000);
-  flushMultiplexers();
-  lastMuxReadTimeUs = micros();
 }
 
 /**
- * This method reads the multiplexers for a short time to to establish the voltage bias on the input lines.
- * This will take longer the higher the capitance and resistance of a line is.
+ * Checks if all inputs of a pad (and its pedal) have settled, otherwise the pad must not be evaluated.
  */
-void DrumKit::flushMultiplexers() {
-  time_ms_t startTimeMs = millis();
-  do {
-    for (mux_size_t i = 0; i < muxCount; ++i) {
-      mux[i].scan();
+bool DrumKit::isPadSettled(const DrumPad& pad) const {
+  if (!settlingTracker.isSettling()) {
+    return true;
+  }
+
+  for (pin_size_t pinIndex = 0; pinIndex < pad.getActivePinCount(); ++pinIndex) {
+    const sensor_value_t* sample = pad.getConnector()->getPin(pinIndex).sample;
+    if (sample && !settlingTracker.isSettled(scanner.getSlotIndex(sample))) {
+      return false;
     }
-  } while (millis() - startTimeMs < 100); // assume that 100ms is enough to stabilize the voltage
+  }
+
+  const DrumPad* pedal = pad.getPedalPad();
+  return !pedal || isPadSettled(*pedal);
 }
 
 static void sendChokeMessage(const DrumPad& pad, const midi_note_t* notes) {
   for (int i = 0; i < pad.getActiveZoneCount(); ++i) {
-    midiTransport.sendAfterTouch(notes[i], 127, MIDI_CHANNEL);
+    midiOutputQueue.sendAfterTouch(notes[i], 127, MIDI_CHANNEL);
   }
   for (int i = 0; i < pad.getActiveZoneCount(); ++i) {
-    midiTransport.sendAfterTouch(notes[i], 0, MIDI_CHANNEL);
+    midiOutputQueue.sendAfterTouch(notes[i], 0, MIDI_CHANNEL);
   }
 }
 
-void DrumKit::evaluatePad(time_us_t senseTimeUs, DrumPad& pad) {
+void DrumKit::evaluatePad(time_us_t senseTimeUs, DrumPad& pad, bool isOversampled) {
   switch (pad.getPadType()) {
   case PadType::Drum:
     pad.sense(senseTimeUs);
@@ -117,9 +296,12 @@ void DrumKit::evaluatePad(time_us_t senseTimeUs, DrumPad& pad) {
   case PadType::Cymbal: {
     DrumPad* pedal = pad.getPedalPad();
     if (pedal) { // HiHat
-      pedal->sense(senseTimeUs);
+      // the pedal is not part of the oversampling, its samples were already evaluated in this update
+      if (!isOversampled) {
+        pedal->sense(senseTimeUs);
+      }
       pad.sense(senseTimeUs);
-      evaluateHiHat(pad, *pedal);
+      evaluateHiHat(pad, *pedal, !isOversampled);
     } else {
       pad.sense(senseTimeUs);
       evaluateCymbal(pad);
@@ -136,19 +318,19 @@ void DrumKit::evaluateDrum(const DrumPad& pad) {
 
   if (pad.hits[0]) {
     EDRUM_DEBUG("%s hit main: %d\n", pad.getName().c_str(), pad.hitVelocities[0]);
-    sendMidiNoteOnMessage(mappings.noteMain, pad.hitVelocities[0]);
+    sendMidiNoteOnMessage(mappings.noteMain, pad.hitVelocities[0], pad.hitTimeUs);
   } else if (pad.hits[1]) {
     EDRUM_DEBUG("%s hit rim: %d\n", pad.getName().c_str(), pad.hitVelocities[1]);
-    sendMidiNoteOnMessage(mappings.noteRim, pad.hitVelocities[1]);
+    sendMidiNoteOnMessage(mappings.noteRim, pad.hitVelocities[1], pad.hitTimeUs);
   } else if (pad.hits[2]) {
     EDRUM_DEBUG("%s hit side rim / cross-stick: %d\n", pad.getName().c_str(), pad.hitVelocities[2]);
-    sendMidiNoteOnMessage(mappings.noteCross, pad.hitVelocities[2]);
+    sendMidiNoteOnMessage(mappings.noteCross, pad.hitVelocities[2], pad.hitTimeUs);
   }
 }
 
-void DrumKit::evaluateHiHat(const DrumPad& pad, const DrumPad& pedal) {
-  if (pedal.hihat.isMoving) {
-    midiTransport.sendControlChange(HIHAT_CC, pedal.hihat.pedalCC, MIDI_CHANNEL);
+void DrumKit::evaluateHiHat(const DrumPad& pad, const DrumPad& pedal, bool isPedalSensed) {
+  if (isPedalSensed && pedal.hihat.isMoving) {
+    midiOutputQueue.sendControlChange(HIHAT_CC, pedal.hihat.pedalCC, MIDI_CHANNEL);
   }
 
   const DrumMappings& padMappings = pad.getMappings();
@@ -162,8 +344,8 @@ void DrumKit::evaluateHiHat(const DrumPad& pad, const DrumPad& pedal) {
     evaluateCymbal(pad);
   }
 
-  if (pedalMappings.noteMain != MIDI_NOTE_UNASSIGNED && pedal.hits[0]) { // play chick sound when hihat is closed
-    sendMidiNoteOnMessage(pedalMappings.noteMain, pedal.hitVelocities[0]);
+  if (isPedalSensed && pedalMappings.noteMain != MIDI_NOTE_UNASSIGNED && pedal.hits[0]) { // play chick sound when hihat is closed
+    sendMidiNoteOnMessage(pedalMappings.noteMain, pedal.hitVelocities[0], pedal.hitTimeUs);
   }
 }
 
@@ -176,13 +358,13 @@ void DrumKit::evaluateCymbal(const DrumPad& pad) {
 void DrumKit::evaluateCymbalWithNotes(const DrumPad& pad, const midi_note_t* notes) {
   if (pad.hits[0]) { // bow
     EDRUM_DEBUG("%s hit bow: %d\n", pad.getName().c_str(), pad.hitVelocities[0]);
-    sendMidiNoteOnMessage(notes[0], pad.hitVelocities[0]);
+    sendMidiNoteOnMessage(notes[0], pad.hitVelocities[0], pad.hitTimeUs);
   } else if (pad.hits[1]) { // edge
     EDRUM_DEBUG("%s hit edge: %d\n", pad.getName().c_str(), pad.hitVelocities[1]);
-    sendMidiNoteOnMessage(notes[1], pad.hitVelocities[1]);
+    sendMidiNoteOnMessage(notes[1], pad.hitVelocities[1], pad.hitTimeUs);
   } else if (pad.hits[2]) { // cup
     EDRUM_DEBUG("%s hit cup: %d\n", pad.getName().c_str(), pad.hitVelocities[2]);
-    sendMidiNoteOnMessage(notes[2], pad.hitVelocities[2]);
+    sendMidiNoteOnMessage(notes[2], pad.hitVelocities[2], pad.hitTimeUs);
   } else if (pad.cymbal.isChoked) {
     EDRUM_DEBUG("%s choked\n", pad.getName().c_str());
     sendChokeMessage(pad, notes);
@@ -190,29 +372,28 @@ void DrumKit::evaluateCymbalWithNotes(const DrumPad& pad, const midi_note_t* not
 }
 
 void DrumKit::sendMidiNoteOnOffMessage(midi_note_t note, midi_velocity_t velocity) {
-  if (note != MIDI_NOTE_UNASSIGNED) {
-    midiTransport.sendNoteOn(note, velocity, MIDI_CHANNEL);
-    midiTransport.sendNoteOff(note, 0, MIDI_CHANNEL);
-  }
+  sendMidiNoteOnOffMessage(note, velocity, micros());
 }
 
-void DrumKit::sendMidiNoteOnWithDelayedOffMessage(midi_note_t note, midi_velocity_t velocity) {
-  if (pendingNotesQueue.removeNote(note)) { // stop note if it is already playing
-    midiTransport.sendNoteOff(note, 0, MIDI_CHANNEL);
+// the messages are stamped with the hit time, so that their latency does not depend on the scan order
+void DrumKit::sendMidiNoteOnOffMessage(midi_note_t note, midi_velocity_t velocity, time_us_t hitTimeUs) {
+  if (note != MIDI_NOTE_UNASSIGNED) {
+    midiOutputQueue.sendNoteOn(note, velocity, MIDI_CHANNEL, hitTimeUs);
+    midiOutputQueue.sendNoteOff(note, 0, MIDI_CHANNEL, hitTimeUs);
   }
+}
 
-  midiTransport.sendNoteOn(note, velocity, MIDI_CHANNEL);
-
-  if (pendingNotesQueue.isFull()) { // remove oldest note if queue is full
-    const MidiNoteEvent& oldNote = pendingNotesQueue.peekOldestNote();
-    midiTransport.sendNoteOff(oldNote.note, 0, MIDI_CHANNEL);
-    pendingNotesQueue.removeOldestNote();
+void DrumKit::sendMidiNoteOnWithDelayedOffMessage(midi_note_t note, midi_velocity_t velocity, time_us_t hitTimeUs) {
+  if (noteOffScheduler.cancel(note)) { // stop note if it is already playing
+    midiOutputQueue.sendNoteOff(note, 0, MIDI_CHANNEL, hitTimeUs);
+    ++statistics.retriggeredNoteCount;
   }
 
-  pendingNotesQueue.addNote(note, millis());
+  midiOutputQueue.sendNoteOn(note, velocity, MIDI_CHANNEL, hitTimeUs);
+  noteOffScheduler.scheduleNoteOff(note, millis(), gateTimeMs);
 }
 
-void DrumKit::sendMidiNoteOnMessage(midi_note_t note, midi_velocity_t velocity) {
+void DrumKit::sendMidiNoteOnMessage(midi_note_t note, midi_velocity_t velocity, time_us_t hitTimeUs) {
   DrumIO::led(LedId::HitIndicator, true);
   lastHitTimeUs = micros();
 
@@ -221,21 +402,14 @@ void DrumKit::sendMidiNoteOnMessage(midi_note_t note, midi_velocity_t velocity)
   }
 
   if (gateTimeMs > 0) {
-    sendMidiNoteOnWithDelayedOffMessage(note, velocity);
+    sendMidiNoteOnWithDelayedOffMessage(note, velocity, hitTimeUs);
   } else {
-    sendMidiNoteOnOffMessage(note, velocity);
+    sendMidiNoteOnOffMessage(note, velocity, hitTimeUs);
   }
 }
 
 void DrumKit::sendPendingMidiNoteOffMessages() {
-  time_ms_t currentTimeMs = millis();
-  while (!pendingNotesQueue.isEmpty()) {
-    const MidiNoteEvent& noteEvent = pendingNotesQueue.peekOldestNote();
-    if (currentTimeMs - noteEvent.noteOnTimeMs < gateTimeMs) {
-      return; // wait until next check
-    }
-
-    midiTransport.sendNoteOff(noteEvent.note, 0, MIDI_CHANNEL);
-    pendingNotesQueue.removeOldestNote();
-  } 
+  noteOffScheduler.processExpired(millis(), [](midi_note_t note) {
+    midiOutputQueue.sendNoteOff(note, 0, MIDI_CHANNEL);
+  });
 }
@@ -3,17 +3,24 @@
 
 #pragma once
 
+#include "adc_trace_capture.h"
 #include "config/config_mapper.h"
 #include "drum_pad.h"
 #include "drum_mux.h"
 #include "drum_io.h"
+#include "drum_scanner.h"
+#include "settling_tracker.h"
+#include "sensing_table.h"
 #include "monitor.h"
-#include "note_event_queue.h"
+#include "note_off_scheduler.h"
 #include "midi_transport.h"
 
+#include <new>
 #include <queue>
 
 #define MAX_GATE_TIME_MS (30 * 1000) // 30 seconds
+#define MAX_SCAN_OVERSAMPLING 4
+#define SCAN_OVERSAMPLING_DEFAULT 2
 
 class DrumMonitor;
 
@@ -23,20 +30,42 @@ public:
     for (pad_size_t padIndex = 0; padIndex < MAX_PAD_COUNT; ++padIndex) {
       pads[padIndex].setIndex(padIndex);
     }
+    sensingTable.build(pads, 0);
   };
 
-  // disable shallow copies
+  // disable copies and moves, the pads, the scan plan and the monitor point into the kit
   DrumKit(const DrumKit&) = delete;
   DrumKit& operator=(const DrumKit&) = delete;
 
-  // enable move semantic
-  DrumKit(DrumKit&& other) = default;
-  DrumKit& operator=(DrumKit&& other) = default;
+  /**
+   * Restores the state of a new kit. The kit is rebuilt in place, so that all pointers into it stay valid.
+   */
+  void reset() {
+    this->~DrumKit();
+    new (this) DrumKit();
+  }
 
   void init() {
     for (pad_size_t padIndex = 0; padIndex < padsCount; ++padIndex) {
       pads[padIndex].init();
     }
+    rebuildScanPlan();
+    rebuildSensingTable();
+  }
+
+  /**
+   * Adds only the inputs consumed by enabled pads to the scan plan.
+   * Must be called whenever muxes, connectors, the connectors assigned to pads, pads are enabled or disabled
+   * or their zones change.
+   */
+  void rebuildScanPlan();
+
+  /**
+   * Must be called whenever pads are enabled or disabled, or their connectors or settings change.
+   * Also binds the pads to the table again (done by init()).
+   */
+  void rebuildSensingTable() {
+    sensingTable.build(pads, padsCount);
   }
 
   void updateDrums();
@@ -150,9 +179,23 @@ public:
     connectorsCount++;
   }
 
+  // Scanner
+
+  DrumScanner& getScanner() { return scanner; }
+  const DrumScanner& getScanner() const { return scanner; }
+  SettlingTracker& getSettlingTracker() { return settlingTracker; }
+  const SettlingTracker& getSettlingTracker() const { return settlingTracker; }
+
+  const NoteOffScheduler& getNoteOffScheduler() const { return noteOffScheduler; }
+
+  // Sensing table
+
+  const SensingTable& getSensingTable() const { return sensingTable; }
+
   // Monitor
 
   DrumMonitor& getMonitor() { return drumMonitor; }
+  AdcTraceCapture& getAdcTraceCapture() { return adcTraceCapture; }
   const DrumMonitor& getMonitor() const { return drumMonitor; }
 
   // General
@@ -179,6 +222,22 @@ public:
     this->gateTimeMs = gateTimeMs;
   }
 
+  uint8_t getScanOversampling() const { return scanOversampling; }
+
+  /**
+   * Sets how often the inputs of pads in the scan time are read again after each sweep.
+   * 
+   * Will be clamped to the range 0..MAX_SCAN_OVERSAMPLING.
+   */
+  void setScanOversampling(uint8_t scanOversampling) {
+    if (scanOversampling > MAX_SCAN_OVERSAMPLING) {
+      eventLog.log(Level::Warn, String("Scan oversampling reduced to maximum ")
+        + MAX_SCAN_OVERSAMPLING + " (was " + String(scanOversampling) + ")");
+      scanOversampling = MAX_SCAN_OVERSAMPLING;
+    }
+    this->scanOversampling = scanOversampling;
+  }
+
   MidiOutputMode getMidiOutputMode() const { return midiOutputMode; }
 
   void setMidiOutputMode(MidiOutputMode mode) {
@@ -189,23 +248,51 @@ public:
     }
   }
 
+  std::vector<MidiOutputMode> getMidiFanOutModes() const { return midiTransport.getFanOutModes(); }
+
+  // modes that get all MIDI messages in addition to the MIDI output mode
+  void setMidiFanOutModes(const std::vector<MidiOutputMode>& modes) {
+    midiTransport.setFanOutModes(modes);
+  }
+
+  uint32_t getMidiConstantLatency() const { return midiTransport.getConstantLatency(); }
+
+  /**
+   * Sets the time in microseconds from a hit to its MIDI message. 0 sends the messages as soon as possible.
+   * 
+   * Will be clamped to the range 0..MAX_MIDI_CONSTANT_LATENCY_US.
+   */
+  void setMidiConstantLatency(uint32_t latencyUs) {
+    if (latencyUs > MAX_MIDI_CONSTANT_LATENCY_US) {
+      eventLog.log(Level::Warn, String("MIDI constant latency reduced to maximum ")
+        + MAX_MIDI_CONSTANT_LATENCY_US + "us (was " + String(latencyUs) + "us)");
+      latencyUs = MAX_MIDI_CONSTANT_LATENCY_US;
+    }
+    midiTransport.setConstantLatency(latencyUs);
+  }
+
 public:
   void sendMidiNoteOnOffMessage(midi_note_t note, midi_velocity_t velocity);
 
 private:
-  void evaluatePad(time_us_t senseTimeUs, DrumPad& pad);
+  void evaluatePad(time_us_t senseTimeUs, DrumPad& pad, bool isOversampled = false);
   void evaluateDrum(const DrumPad& pad);
-  void evaluateHiHat(const DrumPad& pad, const DrumPad& pedal);
+  void evaluateHiHat(const DrumPad& pad, const DrumPad& pedal, bool isPedalSensed);
   void evaluateCymbal(const DrumPad& pad);
   void evaluateCymbalWithNotes(const DrumPad& pad, const midi_note_t* notes);
   
-  void sendMidiNoteOnMessage(midi_note_t note, midi_velocity_t velocity);
+  void sendMidiNoteOnMessage(midi_note_t note, midi_velocity_t velocity, time_us_t hitTimeUs);
   void sendPendingMidiNoteOffMessages();
-  void sendMidiNoteOnWithDelayedOffMessage(midi_note_t note, midi_velocity_t velocity);
+  void sendMidiNoteOnWithDelayedOffMessage(midi_note_t note, midi_velocity_t velocity, time_us_t hitTimeUs);
+  void sendMidiNoteOnOffMessage(midi_note_t note, midi_velocity_t velocity, time_us_t hitTimeUs);
 
   void readMultiplexers(time_us_t senseTimeUs);
-  void stabilizeMultiplexerOffsetVoltage(time_us_t senseTimeUs);
-  void flushMultiplexers();
+  void oversampleScanningPads();
+  bool isInputPaused(pad_size_t padIndex) const {
+    return isPausedInMask[padIndex] && pads[padIndex].getSensingState() == SensingState::Mask;
+  }
+  void checkMultiplexerIdleTime(time_us_t senseTimeUs);
+  bool isPadSettled(const DrumPad& pad) const;
 
 private:
   MidiOutputMode midiOutputMode;
@@ -222,7 +309,10 @@ private:
    * @see https://blog.abletondrummer.com/cymbal-choke-with-e-drums-and-ableton-live/
    */
   time_ms_t gateTimeMs = 0; // 0 .. MAX_GATE_TIME_MS
-  NoteEventQueue pendingNotesQueue;
+
+  // number of additional reads of the pads in the scan time per sweep, see oversampleScanningPads()
+  uint8_t scanOversampling = SCAN_OVERSAMPLING_DEFAULT; // 0 .. MAX_SCAN_OVERSAMPLING
+  NoteOffScheduler noteOffScheduler;
 
   mux_size_t muxCount = 0;
   DrumMux mux[MAX_MUX_COUNT];
@@ -236,7 +326,18 @@ private:
   pad_size_t connectorsCount = 0;
   DrumConnector connectors[MAX_CONNECTOR_COUNT];
 
+  DrumScanner scanner;
+  SensingTable sensingTable;
+
+  // scan schedule: drums do not need their inputs while they are masked, see rebuildScanPlan()
+  bool isPausedInMask[MAX_PAD_COUNT] = {};
+  pad_size_t slotMaskOwners[MAX_SCAN_SLOTS]; // pad that skips the slot while masked or UNKNOWN_PAD
+
+  // inputs that have to settle after the multiplexers were not read for a longer time
+  SettlingTracker settlingTracker;
+
   DrumMonitor drumMonitor;
+  AdcTraceCapture adcTraceCapture;
 
   time_us_t lastHitTimeUs = 0;
 
@@ -244,6 +345,10 @@ public:
   struct {
     // number of sensor pollings in the last 30 seconds
     uint32_t updateCountPer30s = 0;
+    // number of times the inputs had to settle as the multiplexers were idle for too long
+    uint32_t muxSettleCount = 0;
+    // number of notes that were hit again before their gate time elapsed, their NoteOff is sent early
+    uint32_t retriggeredNoteCount = 0;
   } statistics;
 };
 
@@ -46,44 +46,27 @@ void DrumMux::init(pin_size_t selectPinsCount, const pin_size_t (&selectPins)[4]
   initialized = !failed;
 }
 
-#ifdef ARDUINO_ARCH_RP2040
-// switch-on-time for 3.3V between 45-225ns -> ~250ns. Delay might not be necessary
-#define MUX_SWITCH_ON_DELAY_CPU_CYCLES (250 * (F_CPU / 1000000L) / 1000)
-#define WAIT_UNTIL_MUX_STABLE() busy_wait_at_least_cycles(MUX_SWITCH_ON_DELAY_CPU_CYCLES)
-#else
-#define WAIT_UNTIL_MUX_STABLE() {}
-#endif
-
-inline void DrumMux::setMuxEnabled(bool enable) {
-  if (enablePin != PIN_UNUSED) {
-    DrumIO::writeDigitalOutPin(enablePin, enable ? LOW : HIGH);
+bool DrumMux::hasSameSelectPins(const DrumMux& other) const {
+  if (selectPinsCount != other.selectPinsCount) {
+    return false;
   }
-}
-
-inline void DrumMux::selectChannel(channel_size_t channel) {
-  for (pin_size_t selectPinIndex = 0; selectPinIndex < selectPinsCount; selectPinIndex++) {
-    DrumIO::writeDigitalOutPin(selectPins[selectPinIndex], ((channel & (1 << selectPinIndex)) ? HIGH : LOW));
+  for (pin_size_t i = 0; i < selectPinsCount; i++) {
+    if (selectPins[i] != other.selectPins[i]) {
+      return false;
+    }
   }
+  return true;
 }
 
-// overwritten by simulation
-sensor_value_t __attribute__((weak)) readMuxChannel(channel_size_t channel, pin_size_t analogInPin) {
-  WAIT_UNTIL_MUX_STABLE();
-  return DrumIO::readAnalogInPin(analogInPin);
-}
-
-void DrumMux::scan() {
-  if (!initialized) {
-    return;
-  }
-
-  for (channel_size_t channel = 0; channel < channelCount; channel++) {
-    // switch channel when mux is disabled. Otherwise other channels may be read during switching
-    selectChannel(channel);
-    setMuxEnabled(true);
-    channelBuffer[channel] = readMuxChannel(channel, analogInPin);
-    setMuxEnabled(false);
+bool DrumMux::hasCommonSelectPins(const DrumMux& other) const {
+  for (pin_size_t i = 0; i < selectPinsCount; i++) {
+    for (pin_size_t j = 0; j < other.selectPinsCount; j++) {
+      if (selectPins[i] == other.selectPins[j]) {
+        return true;
+      }
+    }
   }
+  return false;
 }
 
 DrumMux::operator String() const {
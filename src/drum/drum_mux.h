@@ -8,6 +8,14 @@
 
 #define MAX_CHANNEL_COUNT 16 // max. 16 channels per mux
 
+#ifdef ARDUINO_ARCH_RP2040
+// switch-on-time for 3.3V between 45-225ns -> ~250ns. Delay might not be necessary
+#define MUX_SWITCH_ON_DELAY_CPU_CYCLES (250 * (F_CPU / 1000000L) / 1000)
+#define WAIT_UNTIL_MUX_STABLE() busy_wait_at_least_cycles(MUX_SWITCH_ON_DELAY_CPU_CYCLES)
+#else
+#define WAIT_UNTIL_MUX_STABLE() {}
+#endif
+
 enum class MuxType {
   HC4051,
   HC4067,
@@ -40,11 +48,9 @@ public:
     return selectPins[3] == PIN_UNUSED ? MuxType::HC4051 : MuxType::HC4067;
   }
 
-  channel_size_t getChannelCount() const { return channelCount; }
+  bool isInitialized() const { return initialized; }
 
-  sensor_value_t readChannel(channel_size_t channelIndex) const { return channelBuffer[channelIndex]; }
-  
-  void scan();
+  channel_size_t getChannelCount() const { return channelCount; }
 
   pin_size_t getAnalogInPin() const { return analogInPin; }
   pin_size_t getEnablePin() const { return enablePin; }
@@ -52,15 +58,29 @@ public:
   pin_size_t getSelectPinsCount() const { return selectPinsCount; }
   pin_size_t getSelectPin(pin_size_t index) const { return selectPins[index]; }
 
+  /** Returns true if both muxes are switched by the same select pins */
+  bool hasSameSelectPins(const DrumMux& other) const;
+
+  /** Returns true if at least one select pin is used by both muxes */
+  bool hasCommonSelectPins(const DrumMux& other) const;
+
+  void setMuxEnabled(bool enable) const {
+    if (enablePin != PIN_UNUSED) {
+      DrumIO::writeDigitalOutPin(enablePin, enable ? LOW : HIGH);
+    }
+  }
+
+  void selectChannel(channel_size_t channel) const {
+    for (pin_size_t selectPinIndex = 0; selectPinIndex < selectPinsCount; selectPinIndex++) {
+      DrumIO::writeDigitalOutPin(selectPins[selectPinIndex], ((channel & (1 << selectPinIndex)) ? HIGH : LOW));
+    }
+  }
+
   operator String() const;
 
 private:
   void init(pin_size_t selectPinsCount, const pin_size_t (&selectPins)[4], pin_size_t analogInPin, pin_size_t enablePin);
 
-  void setMuxEnabled(bool enable);
-
-  void selectChannel(channel_size_t channel);
-  
 private:
   bool initialized = false;
 
@@ -70,6 +90,4 @@ private:
 
   pin_size_t selectPinsCount;
   pin_size_t selectPins[4];
-
-  sensor_value_t channelBuffer[MAX_CHANNEL_COUNT];
 };
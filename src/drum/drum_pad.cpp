@@ -21,9 +21,9 @@ void DrumPad::init() {
 }
 
 sensor_value_t DrumPad::readInput(DrumPin& pin, InputFlags::Value flags) {
-  sensor_value_t result = pin.mux
-      ? pin.mux->readChannel(pin.index)
-      : DrumIO::readAnalogInPin(pin.index);
+  sensor_value_t result = pin.sample
+      ? *pin.sample
+      : (pin.mux ? MAX_SENSOR_VALUE / 2 : DrumIO::readAnalogInPin(pin.index)); // not part of the scan plan
 
   if (pin.getSignalType() == SignalType::VoltageOffset) {
     if (flags & InputFlags::AUTO_CALIBRATE) {
@@ -43,6 +43,31 @@ sensor_value_t DrumPad::readInput(DrumPin& pin, InputFlags::Value flags) {
   return result;
 }
 
+void DrumPad::readInputValues(time_us_t senseTimeUs) {
+  sampleTimeUs = senseTimeUs;
+  if (settings.zonesType == ZonesType::Zones1_Controller) {
+    return;
+  }
+
+  const pin_size_t pinCount = getActivePinCount();
+  if (pinCount > 0 && connector->getPin(0).sampleTimeUs) {
+    sampleTimeUs = *connector->getPin(0).sampleTimeUs;
+  }
+  for (pin_size_t pinIndex = 0; pinIndex < pinCount; ++pinIndex) {
+    bool autoCalibrate = (getPadType() == PadType::Drum) ? this->autoCalibrate : false;
+    sensor_value_t inputValue = readInput(connector->getPin(pinIndex),
+       autoCalibrate ? InputFlags::AUTO_CALIBRATE : InputFlags::NONE);
+
+    if (settings.zonesType == ZonesType::Zones3_PiezoAndSwitches_1TRS && pinIndex == 1) {
+      uint8_t sensorIndex = (inputValue >= settings.zoneThresholdsMin[2]) ? 2 : 1;
+      sensorValues[sensorIndex] = inputValue;
+      sensorValues[3 - sensorIndex] = 0; // set the other zone to 0
+    } else {
+      sensorValues[pinIndex] = inputValue;
+    }
+  }
+}
+
 void DrumPad::sense(time_us_t senseTimeUs) {
   switch (settings.zonesType) {
   case ZonesType::Zones1_Piezo:
@@ -65,4 +90,18 @@ void DrumPad::reinitializeSettings() {
   if (settings.chokeType != ChokeType::TouchSensor) {
     touchSensor = nullptr;
   }
+  updateCurveTable();
+}
+
+void DrumPad::updateCurveTable() {
+  if (settings.curveType != CurveType::Custom) {
+    curveTable = &::getCurveTable(settings.curveType);
+    return;
+  }
+
+  if (!customCurveTable) {
+    customCurveTable = std::make_unique<CurveTable>();
+  }
+  buildCustomCurveTable(*customCurveTable, settings.customCurvePoints, settings.customCurvePointsCount);
+  curveTable = customCurveTable.get();
 }
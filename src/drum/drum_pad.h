@@ -9,9 +9,13 @@
 #include "drum_settings.h"
 #include "event_log.h"
 #include "types.h"
+#include "sensing/scale.h"
 #include "sensing/sensing.h"
+#include "sensing/velocity_prediction.h"
 #include "touch.h"
 
+#include <memory>
+
 #define STRINGIFY(s) #s
 #define STRINGIFY_VALUE(s) STRINGIFY(s)
 
@@ -168,13 +172,22 @@ public:
 
   bool const areMappingsAssigned() const { return mappings != nullptr; }
 
-  void setCurve(CurveType curveType) { settings.curveType = curveType; }
+  void setCurve(CurveType curveType) {
+    settings.curveType = curveType;
+    updateCurveTable();
+  }
+
+  // velocity curve of the settings, either precomputed or baked from the custom curve points
+  const CurveTable& getCurveTable() const { return *curveTable; }
+
+  // hits recorded for the predictive velocity. Written by the sensing, so pause it before accessing.
+  VelocityCalibration& getVelocityCalibration() { return velocityCalibration; }
 
   DrumPad* getPedalPad() const { return pedalPad; }
   void setPedalPad(DrumPad& pad) { this->pedalPad = &pad; }
   void setPedalPad(DrumPad* pad) { this->pedalPad = pad; }
 
-  SensingState getSensingState() const { return sensingState; }
+  SensingState getSensingState() const { return *sensingState; }
 
   bool isHit() const {
     return hits[0] || hits[1] || hits[2];
@@ -184,6 +197,12 @@ public:
   bool operator!=(const DrumPad& other) const { return this != &other; }
 
 public:
+  /**
+   * Reads the values of all active zones into sensorValues. Only for piezo based pads, controllers read their input in sense().
+   * The time the main piezo was sampled is stored in sampleTimeUs. If it is unknown (e.g. for controllers) senseTimeUs is used.
+   */
+  void readInputValues(time_us_t senseTimeUs);
+
   void sense(time_us_t senseTimeUs);
 
 private:
@@ -202,6 +221,8 @@ private:
    */
   static sensor_value_t readInput(DrumPin& pin, InputFlags::Value flags = InputFlags::NONE);
 
+  void updateCurveTable();
+
 public: // state
   struct HiHatData {
     midi_velocity_t pedalCC = 0;
@@ -215,13 +236,23 @@ public: // state
     LastCymbalEventType lastEventType = LastCymbalEventType::None;
   } cymbal;
 
+  time_us_t sampleTimeUs = 0; // time of the sensorValues, all timing of the sensing is based on it
   time_us_t hitTimeUs = 0;
   time_us_t scanTimeEndUs = 0;
+  uint8_t samplesBelowPeakCount = 0; // consecutive samples below the peak for the early commit
+
+  // rising edge for the predictive velocity
+  uint8_t scanSampleCount = 0;
+  bool isHitPredicted = false;
+  zone_size_t predictedHitZone = 0;
+  sensor_value_t riseStartValues[MAX_ZONE_COUNT] = {};
+  sensor_value_t riseAmplitudes[MAX_ZONE_COUNT] = {};
 
-  sensor_value_t sensorValues[3] = {0, 0, 0};
-  sensor_value_t maxZoneValues[3] = {0, 0, 0};
-  midi_velocity_t hitVelocities[3] = {0, 0, 0};
-  bool hits[3] = {false, false, false};
+  // views onto the row of the pad in the SensingTable of the kit, with MAX_ZONE_COUNT entries each
+  sensor_value_t* sensorValues = nullptr;
+  sensor_value_t* maxZoneValues = nullptr;
+  midi_velocity_t* hitVelocities = nullptr;
+  bool* hits = nullptr;
 
 private:
   pad_size_t index = UNKNOWN_PAD;
@@ -234,12 +265,17 @@ private:
 
   DrumSettings settings;
 
+  const CurveTable* curveTable = &::getCurveTable(CURVE_TYPE_DEFAULT);
+  std::unique_ptr<CurveTable> customCurveTable; // only allocated for CurveType::Custom
+
+  VelocityCalibration velocityCalibration;
+
   DrumPad* pedalPad = nullptr;
   DrumConnector* connector = nullptr;
 
   DrumConnector* touchSensor = nullptr;
 
-  SensingState sensingState = SensingState::PeakDetect;
+  SensingState* sensingState = nullptr; // view onto the SensingTable
 
   DrumMappings* mappings = nullptr;
   static DrumMappings fallbackMappings;
@@ -250,4 +286,5 @@ private:
   friend class PiezoSwitchSensing;
   friend class LatencySensing;
   friend class PiezoSensing;
+  friend class SensingTable;
 };
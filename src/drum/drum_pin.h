@@ -26,6 +26,8 @@ struct DrumPin {
   uint8_t index;
   sensor_value_t offset = MAX_SENSOR_VALUE / 2;
   int16_t offsetBalance = 0;
+  const sensor_value_t* sample = nullptr; // location of the value in the frame of the DrumScanner
+  const time_us_t* sampleTimeUs = nullptr; // location of the time the value was read by the DrumScanner
 
   DrumPin()
     : mux(nullptr), muxIndex(MUX_UNUSED), index(PIN_UNUSED) {}
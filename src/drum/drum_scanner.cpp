@@ -0,0 +1,127 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "drum_scanner.h"
+
+#include "event_log.h"
+
+const sensor_value_t* DrumScanner::addMuxChannel(const DrumMux& mux, channel_size_t channel) {
+  return addSlot(&mux, channel, mux.getAnalogInPin());
+}
+
+const sensor_value_t* DrumScanner::addDirectPin(pin_size_t analogInPin) {
+  return addSlot(nullptr, PIN_UNUSED, analogInPin);
+}
+
+const sensor_value_t* DrumScanner::addSlot(const DrumMux* mux, channel_size_t channel, pin_size_t analogInPin) {
+  for (scan_slot_t index = 0; index < slotsCount; ++index) {
+    const ScanSlot& slot = slots[index];
+    if (slot.mux == mux && slot.channel == channel && slot.analogInPin == analogInPin) {
+      return &frame[index];
+    }
+  }
+
+  if (slotsCount >= MAX_SCAN_SLOTS) {
+    eventLog.log(Level::Error, String("Scan plan full, cannot add input: ") + analogInPin);
+    return nullptr;
+  }
+
+  bool needsSelect = true;
+  bool overlapsPrevious = false;
+  if (mux && slotsCount > 0) {
+    const ScanSlot& previous = slots[slotsCount - 1];
+    if (previous.mux) {
+      needsSelect = !(previous.channel == channel && previous.mux->hasSameSelectPins(*mux));
+      overlapsPrevious = previous.analogInPin != analogInPin
+          && !previous.mux->hasCommonSelectPins(*mux)
+          && (mux->getEnablePin() == PIN_UNUSED || previous.mux->getEnablePin() != mux->getEnablePin());
+    } else {
+      overlapsPrevious = previous.analogInPin != analogInPin;
+    }
+  }
+
+  slots[slotsCount] = {mux, channel, analogInPin, needsSelect, overlapsPrevious};
+  skipped[slotsCount] = false;
+  sampleTimesUs[slotsCount] = 0;
+  frame[slotsCount] = mux ? MAX_SENSOR_VALUE / 2 : 0;
+  return &frame[slotsCount++];
+}
+
+inline void DrumScanner::prepareSlot(const ScanSlot& slot, bool needsSelect) {
+  if (slot.mux) {
+    // switch channel when mux is disabled. Otherwise other channels may be read during switching
+    if (needsSelect) {
+      slot.mux->selectChannel(slot.channel);
+    }
+    slot.mux->setMuxEnabled(true);
+  }
+}
+
+void DrumScanner::sweep() {
+  scan_slot_t index = findNextSlot(0);
+  if (index >= slotsCount) {
+    return;
+  }
+
+  DrumIO::beginAnalogInFrame();
+
+  prepareSlot(slots[index], true);
+  WAIT_UNTIL_MUX_STABLE();
+
+  while (index < slotsCount) {
+    const ScanSlot& slot = slots[index];
+    const scan_slot_t nextIndex = findNextSlot(index + 1);
+    const ScanSlot* nextSlot = (nextIndex < slotsCount) ? &slots[nextIndex] : nullptr;
+
+    // the pipelining flags of a slot only hold if its predecessor was read
+    const bool isSuccessor = nextIndex == index + 1;
+    const bool overlapsCurrent = nextSlot && isSuccessor && nextSlot->overlapsPrevious;
+
+    sampleTimesUs[index] = micros();
+    DrumIO::startAnalogInFramePin(slot.analogInPin);
+    if (overlapsCurrent) {
+      prepareSlot(*nextSlot, nextSlot->needsSelect); // settles during the conversion
+    }
+    frame[index] = DrumIO::finishAnalogInFramePin();
+
+    if (slot.mux) {
+      slot.mux->setMuxEnabled(false);
+    }
+
+    if (nextSlot && !overlapsCurrent && nextSlot->mux) {
+      prepareSlot(*nextSlot, !isSuccessor || nextSlot->needsSelect);
+      WAIT_UNTIL_MUX_STABLE();
+    }
+
+    index = nextIndex;
+  }
+
+  DrumIO::endAnalogInFrame();
+}
+
+void DrumScanner::sweepSlots(const scan_slot_t* slotIndices, scan_slot_t count) {
+  if (count == 0) {
+    return;
+  }
+
+  DrumIO::beginAnalogInFrame();
+
+  for (scan_slot_t i = 0; i < count; ++i) {
+    const scan_slot_t index = slotIndices[i];
+    const ScanSlot& slot = slots[index];
+    if (slot.mux) {
+      prepareSlot(slot, true);
+      WAIT_UNTIL_MUX_STABLE();
+    }
+
+    sampleTimesUs[index] = micros();
+    DrumIO::startAnalogInFramePin(slot.analogInPin);
+    frame[index] = DrumIO::finishAnalogInFramePin();
+
+    if (slot.mux) {
+      slot.mux->setMuxEnabled(false);
+    }
+  }
+
+  DrumIO::endAnalogInFrame();
+}
@@ -0,0 +1,122 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "config/config_mapper.h"
+#include "drum_io.h"
+#include "drum_mux.h"
+
+#define MAX_DIRECT_SCAN_PINS 8
+#define MAX_SCAN_SLOTS (MAX_MUX_COUNT * MAX_CHANNEL_COUNT + MAX_DIRECT_SCAN_PINS)
+
+typedef uint8_t scan_slot_t;
+
+/**
+ * A single input that is read in each sweep: either a channel of a mux or an ADC pin
+ * that is connected directly.
+ */
+struct ScanSlot {
+  const DrumMux* mux; // nullptr for direct pins
+  channel_size_t channel;
+  pin_size_t analogInPin;
+
+  // false if the previous slot already selected the channel on the same select pins
+  bool needsSelect;
+
+  // true if the mux can be switched while the previous slot is converted, hiding the settle time
+  bool overlapsPrevious;
+};
+
+/**
+ * Reads all inputs of the scan plan in one sweep and stores the results in a contiguous sample frame,
+ * together with the time each input was read.
+ *
+ * The plan is built once whenever the kit configuration changes. The pins of the connectors point
+ * directly to their slot in the frame, so the sensing code does not need to know how the input was read.
+ *
+ * Mux channels should be added interleaved (channel 0 of all muxes, then channel 1, ...).
+ * The sweep is pipelined: while a slot is converted, the mux of the next slot is already switched if it
+ * neither shares the analog in pin nor the select pins with the current one.
+ * Muxes sharing the select pins only need a single channel selection for all of them.
+ *
+ * Slots can be skipped temporarily (e.g. while their pad is masked), they keep their last sample then.
+ * Single slots can be read again with sweepSlots() to sample them more often than the others.
+ */
+class DrumScanner {
+public:
+  DrumScanner() = default;
+
+  // disable shallow copies
+  DrumScanner(const DrumScanner&) = delete;
+  DrumScanner& operator=(const DrumScanner&) = delete;
+
+  // enable move semantic
+  DrumScanner(DrumScanner&& other) = default;
+  DrumScanner& operator=(DrumScanner&& other) = default;
+
+public:
+  /**
+   * Removes all slots from the scan plan.
+   */
+  void reset() {
+    slotsCount = 0;
+  }
+
+  /**
+   * Adds a mux channel to the scan plan if it was not added yet.
+   * @return the location of the sample in the frame or nullptr if the plan is full.
+   */
+  const sensor_value_t* addMuxChannel(const DrumMux& mux, channel_size_t channel);
+
+  /**
+   * Adds an ADC pin to the scan plan if it was not added yet.
+   * @return the location of the sample in the frame or nullptr if the plan is full.
+   */
+  const sensor_value_t* addDirectPin(pin_size_t analogInPin);
+
+  scan_slot_t getSlotsCount() const { return slotsCount; }
+  const ScanSlot& getSlot(scan_slot_t index) const { return slots[index]; }
+  sensor_value_t getSample(scan_slot_t index) const { return frame[index]; }
+  const sensor_value_t* getSamples() const { return frame; }
+
+  // location of the time the sample of a slot was read, the time is updated with each read
+  const time_us_t* getSampleTimeLocation(scan_slot_t index) const { return &sampleTimesUs[index]; }
+
+  // index of the slot of a sample location returned by addMuxChannel() or addDirectPin()
+  scan_slot_t getSlotIndex(const sensor_value_t* sample) const { return sample - frame; }
+
+  bool isSlotSkipped(scan_slot_t index) const { return skipped[index]; }
+  void setSlotSkipped(scan_slot_t index, bool skip) { skipped[index] = skip; }
+
+  /**
+   * Reads all inputs of the scan plan that are not skipped into the sample frame.
+   */
+  void sweep();
+
+  /**
+   * Reads only the given slots into the sample frame, e.g. to oversample the inputs of pads that are hit.
+   * The slots are not pipelined as they are usually not adjacent.
+   */
+  void sweepSlots(const scan_slot_t* slotIndices, scan_slot_t count);
+
+private:
+  const sensor_value_t* addSlot(const DrumMux* mux, channel_size_t channel, pin_size_t analogInPin);
+
+  scan_slot_t findNextSlot(scan_slot_t index) const {
+    while (index < slotsCount && skipped[index]) {
+      ++index;
+    }
+    return index;
+  }
+
+  static void prepareSlot(const ScanSlot& slot, bool needsSelect);
+
+private:
+  scan_slot_t slotsCount = 0;
+  ScanSlot slots[MAX_SCAN_SLOTS];
+  bool skipped[MAX_SCAN_SLOTS] = {};
+
+  sensor_value_t frame[MAX_SCAN_SLOTS];
+  time_us_t sampleTimesUs[MAX_SCAN_SLOTS] = {};
+};
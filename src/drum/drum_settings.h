@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include "fixed_point.h"
 #include "types.h"
 
 enum class PadType {
@@ -42,7 +43,8 @@ enum class CurveType {
   Exponential1,
   Exponential2,
   Logarithmic1,
-  Logarithmic2
+  Logarithmic2,
+  Custom // defined by control points
 };
 
 enum class DecayType {
@@ -55,6 +57,13 @@ enum class DecayType {
 #define CURVE_TYPE_DEFAULT CurveType::Linear
 #define DECAY_TYPE_DEFAULT DecayType::Linear
 
+#define MAX_CURVE_POINTS 8
+
+struct CurvePoint {
+  uint8_t input; // in % of the range between min and max threshold (0 .. 100)
+  midi_velocity_t velocity; // 1 .. 127
+};
+
 #define THRESHOLD_MIN_DEFAULT (MAX_SENSOR_VALUE / 2)
 #define THRESHOLD_MAX_DEFAULT MAX_SENSOR_VALUE
 
@@ -64,6 +73,8 @@ struct DrumSettings {
   ChokeType chokeType = CHOKE_TYPE_DEFAULT;
 
   CurveType curveType = CURVE_TYPE_DEFAULT;
+  CurvePoint customCurvePoints[MAX_CURVE_POINTS]; // CurveType::Custom only, sorted by input
+  uint8_t customCurvePointsCount = 0;
   sensor_value_t zoneThresholdsMin[3] = {THRESHOLD_MIN_DEFAULT, THRESHOLD_MIN_DEFAULT, THRESHOLD_MIN_DEFAULT};
   sensor_value_t zoneThresholdsMax[3] = {THRESHOLD_MAX_DEFAULT, THRESHOLD_MAX_DEFAULT, THRESHOLD_MAX_DEFAULT};
   uint16_t scanTimeUs = 3; // drum, cymbal
@@ -71,12 +82,24 @@ struct DrumSettings {
   uint8_t decayTimeMs = 0; // drum, cymbal
   DecayType decayType = DECAY_TYPE_DEFAULT;
 
+  // early commit: end the scan time as soon as the peak has passed (drum, cymbal)
+  uint8_t earlyCommitDropPercent = 0; // signal must drop by this % below the peak, 0: disabled
+  uint8_t earlyCommitSampleCount = 3; // number of consecutive samples below the peak
+  uint16_t earlyCommitMinTimeUs = 500; // minimum scan time
+
+  // predictive velocity: send the hit after the first samples of the scan time,
+  // the peak is estimated from the rising edge, see predictPeak() (drum, cymbal)
+  bool predictionEnabled = false;
+  uint8_t predictionSampleCount = 2; // samples after the first peak, hits are also recorded with it for the calibration
+  int16_t predictionAmplitudeGain = 100; // % of the max. value of the first samples
+  int16_t predictionRiseGain = 0; // % of the rise during the first samples
+
   int8_t headRimBias = 0; // -100 .. 100
   bool crossNoteEnabled = false;
 
   // pedal
-  float almostClosedThreshold = 90.f; // relative % to min-/max-range
-  float closedThreshold = 100.f; // relative % to min-/max-range
+  percent_q8_t almostClosedThreshold = 90 << PERCENT_Q8_BITS; // relative % to min-/max-range
+  percent_q8_t closedThreshold = 100 << PERCENT_Q8_BITS; // relative % to min-/max-range
   sensor_value_t moveDetectTolerance = 50;
   uint8_t chickDetectTimeoutMs = 20;
 
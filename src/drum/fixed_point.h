@@ -0,0 +1,44 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * Fixed-point types for the sensing code, as the supported MCUs (e.g. RP2040) have no FPU.
+ * Floats are only converted when the config is loaded or written.
+ */
+
+// fraction in Q0.16 format: 0 .. FRACTION_Q16_ONE (inclusive)
+typedef uint32_t fraction_q16_t;
+#define FRACTION_Q16_BITS 16
+#define FRACTION_Q16_ONE ((fraction_q16_t) 1 << FRACTION_Q16_BITS)
+
+// percentage in unsigned Q8.8 format: 0 .. 255.99 %
+typedef uint16_t percent_q8_t;
+#define PERCENT_Q8_BITS 8
+
+/**
+ * Returns numerator / denominator as fraction. The numerator must not be greater than the denominator.
+ * Only 32 bit operations are used, large values lose some of their lower bits.
+ */
+inline fraction_q16_t toFractionQ16(uint32_t numerator, uint32_t denominator) {
+  while (denominator > UINT16_MAX) {
+    numerator >>= 1;
+    denominator >>= 1;
+  }
+  return (numerator << FRACTION_Q16_BITS) / denominator;
+}
+
+inline percent_q8_t toPercentQ8(float percent) {
+  if (percent <= 0) {
+    return 0;
+  }
+  const float maxPercent = (float) UINT16_MAX / (1 << PERCENT_Q8_BITS);
+  return (percent >= maxPercent) ? UINT16_MAX : (percent_q8_t)(percent * (1 << PERCENT_Q8_BITS) + 0.5f);
+}
+
+inline float fromPercentQ8(percent_q8_t percent) {
+  return (float) percent / (1 << PERCENT_Q8_BITS);
+}
@@ -0,0 +1,157 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "types.h"
+
+#include <string.h>
+
+#define MIDI_NOTE_COUNT 128
+
+// number of buckets of the timing wheel, one per ms. Must be a power of two.
+#define NOTE_OFF_WHEEL_SIZE 64
+
+/**
+ * Schedules the note off messages of the notes that are played with a gate time.
+ *
+ * Every MIDI note has its own slot, so each note can be pending once without limiting the number
+ * of pending notes. The notes are sorted into a timing wheel with a bucket per ms by their due time.
+ * Notes that are due after a full turn of the wheel stay in their bucket until their round has come.
+ * Scheduling and cancelling a note is O(1), processExpired() only visits the buckets of the elapsed ms.
+ */
+class NoteOffScheduler {
+public:
+  NoteOffScheduler() {
+    memset(bucketOfNote, NO_BUCKET, sizeof(bucketOfNote));
+    memset(bucketHeads, NO_NOTE, sizeof(bucketHeads));
+    memset(bucketTails, NO_NOTE, sizeof(bucketTails));
+  }
+
+  // disable shallow copies
+  NoteOffScheduler(const NoteOffScheduler&) = delete;
+  NoteOffScheduler& operator=(const NoteOffScheduler&) = delete;
+
+  // enable move semantic
+  NoteOffScheduler(NoteOffScheduler&& other) = default;
+  NoteOffScheduler& operator=(NoteOffScheduler&& other) = default;
+
+  /**
+   * Schedules the note off of a note that was started at noteOnTimeMs. A pending note off of the same note is replaced.
+   * Notes with the same due time expire in the order they were scheduled.
+   */
+  void scheduleNoteOff(midi_note_t note, time_ms_t noteOnTimeMs, time_ms_t gateTimeMs) {
+    if (note >= MIDI_NOTE_COUNT) {
+      return;
+    }
+    cancel(note);
+
+    const time_ms_t dueTimeMs = noteOnTimeMs + gateTimeMs;
+    // a note that is already due is placed in the next visited bucket
+    const time_ms_t bucketTimeMs = isDue(dueTimeMs, lastProcessedTimeMs) ? lastProcessedTimeMs + 1 : dueTimeMs;
+    const uint8_t bucket = bucketTimeMs & (NOTE_OFF_WHEEL_SIZE - 1);
+
+    dueTimesMs[note] = dueTimeMs;
+    bucketOfNote[note] = bucket;
+    nextNotes[note] = NO_NOTE;
+    prevNotes[note] = bucketTails[bucket];
+    if (bucketTails[bucket] != NO_NOTE) {
+      nextNotes[bucketTails[bucket]] = note;
+    } else {
+      bucketHeads[bucket] = note;
+    }
+    bucketTails[bucket] = note;
+
+    if (++pendingCount > maxPendingCount) {
+      maxPendingCount = pendingCount;
+    }
+  }
+
+  /**
+   * Removes the pending note off of a note.
+   * @return false if the note was not pending
+   */
+  bool cancel(midi_note_t note) {
+    if (!isPending(note)) {
+      return false;
+    }
+
+    const uint8_t bucket = bucketOfNote[note];
+    const midi_note_t prev = prevNotes[note];
+    const midi_note_t next = nextNotes[note];
+    if (prev != NO_NOTE) {
+      nextNotes[prev] = next;
+    } else {
+      bucketHeads[bucket] = next;
+    }
+    if (next != NO_NOTE) {
+      prevNotes[next] = prev;
+    } else {
+      bucketTails[bucket] = prev;
+    }
+
+    bucketOfNote[note] = NO_BUCKET;
+    --pendingCount;
+    return true;
+  }
+
+  bool isPending(midi_note_t note) const {
+    return note < MIDI_NOTE_COUNT && bucketOfNote[note] != NO_BUCKET;
+  }
+
+  /**
+   * Calls sendNoteOff(note) for all notes that are due at nowMs and removes them.
+   */
+  template<typename F>
+  void processExpired(time_ms_t nowMs, F&& sendNoteOff) {
+    if (pendingCount == 0 || nowMs == lastProcessedTimeMs) {
+      lastProcessedTimeMs = nowMs;
+      return;
+    }
+
+    // each bucket has to be visited at most once, even if the last call was a long time ago
+    const time_ms_t elapsedMs = nowMs - lastProcessedTimeMs;
+    const uint32_t bucketCount = (elapsedMs < NOTE_OFF_WHEEL_SIZE) ? elapsedMs : NOTE_OFF_WHEEL_SIZE;
+    for (uint32_t i = 1; i <= bucketCount; ++i) {
+      const uint8_t bucket = (lastProcessedTimeMs + i) & (NOTE_OFF_WHEEL_SIZE - 1);
+      midi_note_t note = bucketHeads[bucket];
+      while (note != NO_NOTE) {
+        const midi_note_t next = nextNotes[note];
+        if (isDue(dueTimesMs[note], nowMs)) {
+          cancel(note);
+          sendNoteOff(note);
+        }
+        note = next;
+      }
+    }
+    lastProcessedTimeMs = nowMs;
+  }
+
+  uint8_t getPendingCount() const { return pendingCount; }
+
+  // max. number of notes that were pending at the same time
+  uint8_t getMaxPendingCount() const { return maxPendingCount; }
+
+private:
+  static bool isDue(time_ms_t dueTimeMs, time_ms_t nowMs) {
+    return (int32_t) (nowMs - dueTimeMs) >= 0;
+  }
+
+private:
+  static constexpr uint8_t NO_NOTE = 0xFF;
+  static constexpr uint8_t NO_BUCKET = 0xFF;
+
+  // per note
+  time_ms_t dueTimesMs[MIDI_NOTE_COUNT];
+  uint8_t bucketOfNote[MIDI_NOTE_COUNT];
+  midi_note_t prevNotes[MIDI_NOTE_COUNT]; // doubly linked list of the notes in a bucket
+  midi_note_t nextNotes[MIDI_NOTE_COUNT];
+
+  // per bucket
+  midi_note_t bucketHeads[NOTE_OFF_WHEEL_SIZE];
+  midi_note_t bucketTails[NOTE_OFF_WHEEL_SIZE];
+
+  time_ms_t lastProcessedTimeMs = 0;
+  uint8_t pendingCount = 0;
+  uint8_t maxPendingCount = 0;
+};
@@ -31,12 +31,12 @@ void ControllerSensing::hiHatPedalPositionAndChickSensing(time_us_t senseTimeUs,
   const DrumSettings& settings = pad.settings;
   DrumPad::HiHatData& hihat = pad.hihat;
 
-  const sensor_value_t range = settings.zoneThresholdsMax[0] - settings.zoneThresholdsMin[0];
-  float pedalValuePercent = ((int16_t)pedalValue - settings.zoneThresholdsMin[0]) * 100.f / range;
+  const sensor_value_t thresholdMin = settings.zoneThresholdsMin[0];
+  const sensor_value_t thresholdMax = settings.zoneThresholdsMax[0];
 
   // closedThreshold > almostClosedThreshold > [open] >= 0
-  bool isClosed = pedalValuePercent >= settings.closedThreshold;
-  bool isAlmostClosed = !isClosed && (pedalValuePercent >= settings.almostClosedThreshold);
+  bool isClosed = isAtRangePercent(pedalValue, thresholdMin, thresholdMax, settings.closedThreshold);
+  bool isAlmostClosed = !isClosed && isAtRangePercent(pedalValue, thresholdMin, thresholdMax, settings.almostClosedThreshold);
   bool isOpen = !isClosed && !isAlmostClosed;
 
   if (!isOpen && hihat.state == HiHatState::Open) { // closing: open -> almost closed
@@ -51,7 +51,7 @@ void ControllerSensing::hiHatPedalPositionAndChickSensing(time_us_t senseTimeUs,
     // map closingTimeMs == 0 -> 127, closingTimeMs == maxHitClosingTimeMs -> 1, closingTimeMs > maxHitClosingTimeMs -> [0 .. -inf]
     int32_t velocity = map(closingTimeMs, maxHitClosingTimeMs, 0, 1, 127);
     pad.hitVelocities[0] = (velocity < 0) ? 0 : velocity;
-    EDRUM_DEBUG("[Close] sensorValue: %d (%d%%) chick: %d/127 (%lu ms)\n", pedalValue, (int16_t)pedalValuePercent, hitVelocities[0], closingTimeMs);
+    EDRUM_DEBUG("[Close] sensorValue: %d chick: %d/127 (%lu ms)\n", pedalValue, hitVelocities[0], closingTimeMs);
 
     pad.hits[0] = pad.hitVelocities[0] > 0;
     hihat.state = HiHatState::Closed;
@@ -59,7 +59,7 @@ void ControllerSensing::hiHatPedalPositionAndChickSensing(time_us_t senseTimeUs,
 
   if ((!isClosed && hihat.state == HiHatState::Closed)
       || (isOpen && hihat.state == HiHatState::AlmostClosed)) { // opening: (almost) closed -> open
-    EDRUM_DEBUG("[Open] sensorValue: %d (%d%%)\n", pedalValue, (int16_t)pedalValuePercent);
+    EDRUM_DEBUG("[Open] sensorValue: %d\n", pedalValue);
     hihat.state = HiHatState::Open;
   }
 }
@@ -71,7 +71,7 @@ void ControllerSensing::hiHatPedalCCSensing(sensor_value_t pedalValue) {
   midi_velocity_t newPedalCC = scaleAndCurve(pedalValue,
     settings.zoneThresholdsMin[0],
     settings.zoneThresholdsMax[0],
-    settings.curveType);
+    pad.getCurveTable());
   if (newPedalCC != hihat.pedalCC) {
     EDRUM_DEBUG("[Move] pedalCC: %d/127 -> %d/127 (%d/" MAX_SENSOR_VALUE_STR "), hiHatClosed: %d\n", hihat.pedalCC, newPedalCC, pedalValue, hihat.state == HiHatState::Closed);
 
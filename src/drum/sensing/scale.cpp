@@ -2,77 +2,132 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "scale.h"
-#include <math.h>
+
+static const midi_velocity_t MAX_VELOCITY = 127;
+
+// pow() is not constexpr, the exponent is always an integer here
+static constexpr double powInt(double base, uint32_t exponent) {
+  double result = 1;
+  while (exponent > 0) {
+    if (exponent & 1) {
+      result *= base;
+    }
+    base *= base;
+    exponent >>= 1;
+  }
+  return result;
+}
 
 /**
  * @param value input value (1 .. 1023)
+ * @param base base of the exponential function, stored as float to match the previous runtime calculation
  * @result value adjusted by curve function (1 .. 127)
  */
-static inline midi_velocity_t curveFunc(sensor_value_t inputValue, float base) {
+static constexpr midi_velocity_t curveFunc(sensor_value_t inputValue, float base) {
   const sensor_value_t MAX_INPUT_VALUE = MAX_SENSOR_VALUE;
-  const midi_velocity_t MAX_OUTPUT_VALUE = 127;
-  float curveValue = pow(base, inputValue - 1) - 1; // TODO: use table?
-  float curveMax = pow(base, MAX_INPUT_VALUE - 1) - 1;
-  float outputValue = curveValue / curveMax * (MAX_OUTPUT_VALUE - 1);
-  return round(outputValue) + 1;
+  double curveValue = powInt(base, inputValue - 1) - 1;
+  double curveMax = powInt(base, MAX_INPUT_VALUE - 1) - 1;
+  double outputValue = curveValue / curveMax * (MAX_VELOCITY - 1);
+  return (midi_velocity_t)(outputValue + 0.5) + 1; // round, outputValue is never negative
 }
 
-sensor_value_t scale(sensor_value_t in_value, sensor_value_t in_min, sensor_value_t in_max) {
-  const sensor_value_t out_max = MAX_SENSOR_VALUE;
-  if (in_value == 0 || in_value < in_min) {
-    return 0;
-  } else if (in_value >= in_max) {
-    return out_max;
-  }
-
-  const sensor_value_t out_min = 1; // map value == minValue to 1 and not 0
-  sensor_value_t scaledValue = (uint32_t)(in_value - in_min) * (out_max - out_min) / (in_max - in_min);
-  return scaledValue + out_min;
+static constexpr midi_velocity_t linearFunc(sensor_value_t inputValue) {
+  sensor_value_t result = ((inputValue - 1) >> 3) + 1;  // 10 to 7 bit
+  return result == 128 ? 127 : result;
 }
 
-midi_velocity_t curve(sensor_value_t value, CurveType curveType) {
-  if (value == 0) {
-    return 0;
+static constexpr CurveTable createCurveTable(CurveType curveType) {
+  CurveTable table = {};
+  for (sensor_value_t value = 1; value < CURVE_TABLE_SIZE; ++value) {
+    switch (curveType) {
+    case CurveType::Exponential1:
+      table.velocities[value] = curveFunc(value, 1.002f);
+      break;
+    case CurveType::Exponential2:
+      table.velocities[value] = curveFunc(value, 1.004f);
+      break;
+    case CurveType::Logarithmic1:
+      table.velocities[value] = curveFunc(value, 0.998f);
+      break;
+    case CurveType::Logarithmic2:
+      table.velocities[value] = curveFunc(value, 0.996f);
+      break;
+    default:
+      table.velocities[value] = linearFunc(value);
+      break;
+    }
   }
+  return table;
+}
 
+// computed by the compiler and placed in flash
+static constexpr CurveTable linearTable = createCurveTable(CurveType::Linear);
+static constexpr CurveTable exponential1Table = createCurveTable(CurveType::Exponential1);
+static constexpr CurveTable exponential2Table = createCurveTable(CurveType::Exponential2);
+static constexpr CurveTable logarithmic1Table = createCurveTable(CurveType::Logarithmic1);
+static constexpr CurveTable logarithmic2Table = createCurveTable(CurveType::Logarithmic2);
+
+const CurveTable& getCurveTable(CurveType curveType) {
   switch (curveType) {
-  case CurveType::Linear: {
-    sensor_value_t result = ((value - 1) >> 3) + 1;  // 10 to 7 bit
-    return result == 128 ? 127 : result;
-  }
   case CurveType::Exponential1:
-    return curveFunc(value, 1.002);
+    return exponential1Table;
   case CurveType::Exponential2:
-    return curveFunc(value, 1.004);
+    return exponential2Table;
   case CurveType::Logarithmic1:
-    return curveFunc(value, 0.998);
+    return logarithmic1Table;
   case CurveType::Logarithmic2:
-    return curveFunc(value, 0.996);
+    return logarithmic2Table;
   default:
-    return 0;
+    return linearTable;
   };
 }
 
-midi_velocity_t scaleAndCurve(sensor_value_t value, sensor_value_t minValue, sensor_value_t maxValue, CurveType curveType) {
-  sensor_value_t scaledValue = scale(value, minValue, maxValue);
-  if (scaledValue == 0) {
-    return scaledValue;
+void buildCustomCurveTable(CurveTable& table, const CurvePoint* points, uint8_t pointsCount) {
+  if (pointsCount == 0) {
+    table = linearTable;
+    return;
   }
 
-  switch (curveType) {
-  case CurveType::Linear: {
-    sensor_value_t result = ((scaledValue - 1) >> 3) + 1;  // 10 to 7 bit
-    return result == 128 ? 127 : result;
+  table.velocities[0] = 0;
+
+  uint8_t nextPointIndex = 0;
+  for (sensor_value_t value = 1; value < CURVE_TABLE_SIZE; ++value) {
+    const uint32_t percentScaledValue = (uint32_t) value * 100; // value in % * MAX_SENSOR_VALUE
+    while (nextPointIndex < pointsCount && points[nextPointIndex].input * (uint32_t) MAX_SENSOR_VALUE <= percentScaledValue) {
+      ++nextPointIndex;
+    }
+
+    int32_t velocity;
+    if (nextPointIndex == 0) { // before first point
+      velocity = points[0].velocity;
+    } else if (nextPointIndex == pointsCount) { // behind last point
+      velocity = points[pointsCount - 1].velocity;
+    } else { // interpolate between both points
+      const CurvePoint& from = points[nextPointIndex - 1];
+      const CurvePoint& to = points[nextPointIndex];
+      const int32_t fromValue = from.input * (int32_t) MAX_SENSOR_VALUE;
+      const int32_t rangeValue = (to.input - from.input) * (int32_t) MAX_SENSOR_VALUE;
+      velocity = from.velocity + ((int32_t) percentScaledValue - fromValue) * (to.velocity - from.velocity) / rangeValue;
+    }
+
+    // 0 is reserved for "no hit"
+    table.velocities[value] = (velocity < 1) ? 1 : ((velocity > MAX_VELOCITY) ? MAX_VELOCITY : velocity);
   }
-  case CurveType::Exponential1:
-    return curveFunc(scaledValue, 1.002);
-  case CurveType::Exponential2:
-    return curveFunc(scaledValue, 1.004);
-  case CurveType::Logarithmic1:
-    return curveFunc(scaledValue, 0.998);
-  case CurveType::Logarithmic2:
-    return curveFunc(scaledValue, 0.996);
-  default:
+}
+
+sensor_value_t scale(sensor_value_t in_value, sensor_value_t in_min, sensor_value_t in_max) {
+  const sensor_value_t out_max = MAX_SENSOR_VALUE;
+  if (in_value == 0 || in_value < in_min) {
     return 0;
-  };
+  } else if (in_value >= in_max) {
+    return out_max;
+  }
+
+  const sensor_value_t out_min = 1; // map value == minValue to 1 and not 0
+  sensor_value_t scaledValue = (uint32_t)(in_value - in_min) * (out_max - out_min) / (in_max - in_min);
+  return scaledValue + out_min;
+}
+
+midi_velocity_t scaleAndCurve(sensor_value_t value, sensor_value_t minValue, sensor_value_t maxValue, const CurveTable& table) {
+  return curve(scale(value, minValue, maxValue), table);
 }
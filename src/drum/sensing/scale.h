@@ -4,9 +4,68 @@
 #pragma once
 
 #include "drum_settings.h"
+#include "fixed_point.h"
 
-midi_velocity_t curve(sensor_value_t value, CurveType curveType);
+#define CURVE_TABLE_SIZE (MAX_SENSOR_VALUE + 1)
 
-midi_velocity_t scaleAndCurve(sensor_value_t value, sensor_value_t minValue, sensor_value_t maxValue, CurveType curveType);
+/**
+ * Velocity for each scaled sensor value (0 .. MAX_SENSOR_VALUE). Only value 0 maps to velocity 0.
+ */
+struct CurveTable {
+  midi_velocity_t velocities[CURVE_TABLE_SIZE];
+};
+
+/**
+ * Returns the precomputed table of a curve type. CurveType::Custom has no fixed table and falls back to Linear.
+ */
+const CurveTable& getCurveTable(CurveType curveType);
+
+/**
+ * Computes the table of a custom curve by linear interpolation of the control points (sorted by input).
+ * Falls back to the Linear curve if there are no points.
+ */
+void buildCustomCurveTable(CurveTable& table, const CurvePoint* points, uint8_t pointsCount);
+
+inline midi_velocity_t curve(sensor_value_t value, const CurveTable& table) {
+  return table.velocities[value];
+}
+
+inline midi_velocity_t curve(sensor_value_t value, CurveType curveType) {
+  return curve(value, getCurveTable(curveType));
+}
+
+midi_velocity_t scaleAndCurve(sensor_value_t value, sensor_value_t minValue, sensor_value_t maxValue, const CurveTable& table);
+
+inline midi_velocity_t scaleAndCurve(sensor_value_t value, sensor_value_t minValue, sensor_value_t maxValue, CurveType curveType) {
+  return scaleAndCurve(value, minValue, maxValue, getCurveTable(curveType));
+}
 
 sensor_value_t scale(sensor_value_t in_value, sensor_value_t in_min, sensor_value_t in_max) ;
+
+/**
+ * Returns the threshold during the decay time. It is lowered linearly from the max value of the last hit (decayProgress 0)
+ * to thresholdMin (decayProgress 1).
+ */
+inline sensor_value_t decayThreshold(sensor_value_t maxValue, sensor_value_t thresholdMin, fraction_q16_t decayProgress) {
+  if (maxValue <= thresholdMin) {
+    return thresholdMin;
+  }
+  // round up, so the threshold is rounded down
+  uint32_t decrease = ((uint32_t)(maxValue - thresholdMin) * decayProgress + FRACTION_Q16_ONE - 1) >> FRACTION_Q16_BITS;
+  return maxValue - decrease;
+}
+
+/**
+ * Returns true if value is at or above the given percentage of the range minValue .. maxValue.
+ */
+inline bool isAtRangePercent(sensor_value_t value, sensor_value_t minValue, sensor_value_t maxValue, percent_q8_t percent) {
+  const int32_t offset = (int32_t) value - minValue;
+  if (offset < 0) {
+    return false;
+  }
+  const sensor_value_t range = maxValue - minValue;
+  if (range == 0) {
+    return offset > 0; // as with a float percentage, which is infinite above minValue and NaN at minValue
+  }
+  return (uint32_t) offset * (100 << PERCENT_Q8_BITS) >= (uint32_t) percent * range;
+}
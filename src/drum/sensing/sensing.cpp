@@ -6,6 +6,7 @@
 
 #include "sensing/sensing.h"
 #include "sensing/scale.h"
+#include "sensing/velocity_prediction.h"
 
 const uint32_t MAX_PREFERENCE_MULT = 5;
 
@@ -16,28 +17,28 @@ void PiezoSensing::sense(time_us_t senseTimeUs) {
   }
 
   resetHitInfo();
-  readInputValues();
 
-  if (pad.sensingState == SensingState::PeakDetect) { // check for first peak
-    pad.sensingState = detectPeak(senseTimeUs, pad.settings.zoneThresholdsMin)
+  SensingState& state = *pad.sensingState;
+  if (state == SensingState::PeakDetect) { // check for first peak
+    state = detectPeak(senseTimeUs, pad.settings.zoneThresholdsMin)
       ? SensingState::Scan : SensingState::PeakDetect;
-  } else if (pad.sensingState == SensingState::Scan) { // search highest peak
-    pad.sensingState = scan(senseTimeUs);
-  } else if (pad.sensingState == SensingState::Mask) {
+  } else if (state == SensingState::Scan) { // search highest peak
+    state = scan(senseTimeUs);
+  } else if (state == SensingState::Mask) {
     time_us_t timeSinceMaskBeginUs = senseTimeUs - pad.scanTimeEndUs;
     bool maskActive = timeSinceMaskBeginUs < pad.settings.maskTimeMs * 1000;
     if (!maskActive) {
-      pad.sensingState = (pad.settings.decayTimeMs > 0) ? SensingState::Decay : SensingState::PeakDetect;
+      state = (pad.settings.decayTimeMs > 0) ? SensingState::Decay : SensingState::PeakDetect;
     }
-  } else if (pad.sensingState == SensingState::Decay) {
+  } else if (state == SensingState::Decay) {
     time_us_t maskEndTimeUs = pad.scanTimeEndUs + pad.settings.maskTimeMs * 1000;
     time_us_t timeSinceDecayBeginUs = senseTimeUs - maskEndTimeUs;
     bool decayActive = timeSinceDecayBeginUs < pad.settings.decayTimeMs * 1000;
     if (!decayActive) {
-      pad.sensingState = SensingState::PeakDetect;
+      state = SensingState::PeakDetect;
     } else {
-      float decayProgress = (float) timeSinceDecayBeginUs / (pad.settings.decayTimeMs * 1000);
-      pad.sensingState = detectPeakWithDecay(senseTimeUs, decayProgress)
+      fraction_q16_t decayProgress = toFractionQ16(timeSinceDecayBeginUs, pad.settings.decayTimeMs * 1000);
+      state = detectPeakWithDecay(senseTimeUs, decayProgress)
       ? SensingState::Scan : SensingState::Decay;
     }
   }
@@ -52,23 +53,6 @@ void Sensing::resetHitInfo() {
   pad.cymbal.isChoked = false;
 }
 
-void Sensing::readInputValues() {
-  const pin_size_t pinCount = pad.getActivePinCount();
-  for (pin_size_t pinIndex = 0; pinIndex < pinCount; ++pinIndex) {
-    bool autoCalibrate = (pad.getPadType() == PadType::Drum) ? pad.autoCalibrate : false;
-    sensor_value_t inputValue = pad.readInput(pad.connector->getPin(pinIndex),
-       autoCalibrate ? InputFlags::AUTO_CALIBRATE : InputFlags::NONE);
-
-    if (pad.settings.zonesType == ZonesType::Zones3_PiezoAndSwitches_1TRS && pinIndex == 1) {
-      uint8_t sensorIndex = (inputValue >= pad.settings.zoneThresholdsMin[2]) ? 2 : 1;
-      pad.sensorValues[sensorIndex] = inputValue;
-      pad.sensorValues[3 - sensorIndex] = 0; // set the other zone to 0
-    } else {
-      pad.sensorValues[pinIndex] = inputValue;
-    }
-  }
-}
-
 bool Sensing::isChoked(zone_size_t activeZoneCount) {
   if (pad.getPadType() != PadType::Cymbal || pad.settings.chokeType == ChokeType::None) {
     return false;
@@ -126,6 +110,34 @@ bool Sensing::isZoneSwitchPressed(zone_size_t zone, zone_size_t activeZoneCount)
   return pad.sensorValues[zone] >= pad.settings.zoneThresholdsMin[zone];
 }
 
+// returns true if early commit is enabled and the signal of all piezos dropped far enough below their peak
+bool Sensing::isPeakPassed(time_us_t senseTimeUs, zone_size_t piezoZoneCount) {
+  const DrumSettings& settings = pad.settings;
+  if (settings.earlyCommitDropPercent == 0) {
+    return false;
+  }
+
+  const uint32_t remainingPercent = 100 - min(settings.earlyCommitDropPercent, (uint8_t) 100);
+  bool isBelowPeak = true;
+  for (zone_size_t zone = 0; zone < piezoZoneCount; ++zone) {
+    const sensor_value_t maxValue = pad.maxZoneValues[zone];
+    if (maxValue > 0) { // ignore zones that were not hit
+      isBelowPeak &= (uint32_t) pad.sensorValues[zone] * 100 <= maxValue * remainingPercent;
+    }
+  }
+
+  if (!isBelowPeak) {
+    pad.samplesBelowPeakCount = 0;
+    return false;
+  }
+
+  if (pad.samplesBelowPeakCount < UINT8_MAX) {
+    ++pad.samplesBelowPeakCount;
+  }
+  return pad.samplesBelowPeakCount >= settings.earlyCommitSampleCount
+    && senseTimeUs - pad.hitTimeUs >= settings.earlyCommitMinTimeUs;
+}
+
 zone_size_t Sensing::findMaxValueIndex(uint16_t* values, zone_size_t zoneCount, zone_size_t preferedIndex) {
   uint16_t maxValue = values[preferedIndex];
   zone_size_t maxIndex = preferedIndex;
@@ -156,12 +168,19 @@ bool PiezoSensing::detectPeak(time_us_t senseTimeUs, sensor_value_t* zoneThresho
 
   // peak detected or cymbal might be choked -> start scan time
   pad.hitTimeUs = senseTimeUs;
+  pad.samplesBelowPeakCount = 0;
+  pad.scanSampleCount = 0;
+  pad.isHitPredicted = false;
 
   for (zone_size_t zone = 0; zone < activeZoneCount; ++zone) {
     pad.maxZoneValues[zone] = 0;
   }
   updateMaxSensorValue(activeZoneCount);
 
+  for (zone_size_t zone = 0; zone < activeZoneCount; ++zone) {
+    pad.riseStartValues[zone] = pad.maxZoneValues[zone];
+  }
+
   return true;
 }
 
@@ -187,7 +206,18 @@ SensingState PiezoSensing::scan(time_us_t senseTimeUs) {
   const zone_size_t zoneCount = pad.getActiveZoneCount();
   updateMaxSensorValue(zoneCount);
 
-  bool scanInProgress = senseTimeUs - pad.hitTimeUs < pad.settings.scanTimeUs;
+  const uint8_t predictionSampleCount = pad.settings.predictionSampleCount;
+  if (pad.scanSampleCount < predictionSampleCount && ++pad.scanSampleCount == predictionSampleCount) {
+    for (zone_size_t zone = 0; zone < zoneCount; ++zone) {
+      pad.riseAmplitudes[zone] = pad.maxZoneValues[zone];
+    }
+    if (pad.settings.predictionEnabled) {
+      predictHit(senseTimeUs, zoneCount);
+    }
+  }
+
+  bool scanInProgress = senseTimeUs - pad.hitTimeUs < pad.settings.scanTimeUs
+    && !isPeakPassed(senseTimeUs, zoneCount);
   if (scanInProgress) {
     return SensingState::Scan;
   }
@@ -195,41 +225,90 @@ SensingState PiezoSensing::scan(time_us_t senseTimeUs) {
   // scan time end -> start of mask time
   pad.scanTimeEndUs = senseTimeUs;
 
+  if (pad.isHitPredicted) { // already sent, only the measured peak is needed for the calibration
+    pad.isHitPredicted = false;
+    recordCalibrationHit(pad.predictedHitZone);
+    return SensingState::Mask;
+  }
+
+  zone_size_t hitIndex = evaluateHit(pad.maxZoneValues, zoneCount);
+  if (pad.maxZoneValues[hitIndex] == 0) { // choked
+    return handleChoked();
+  }
+
+  recordCalibrationHit(hitIndex);
+
+  pad.hits[hitIndex] = true;
+  pad.cymbal.lastEventType = LastCymbalEventType::Hit;
+  logHit(hitIndex, zoneCount);
+
+  return SensingState::Mask;
+}
+
+// sets the velocities of all zones from their peak values and returns the zone that was hit
+zone_size_t PiezoSensing::evaluateHit(const sensor_value_t* peakValues, zone_size_t zoneCount) {
   sensor_value_t evaluationVelocities[3];
   for (zone_size_t zone = 0; zone < zoneCount; ++zone) {
-    sensor_value_t scaledValue = scale(pad.maxZoneValues[zone],
+    sensor_value_t scaledValue = scale(peakValues[zone],
       pad.settings.zoneThresholdsMin[zone],
       pad.settings.zoneThresholdsMax[zone]);
     evaluationVelocities[zone] = scaledValue;
-    pad.hitVelocities[zone] = curve(scaledValue, pad.settings.curveType);
+    pad.hitVelocities[zone] = curve(scaledValue, pad.getCurveTable());
   }
 
   // TODO: handle crossNoteEnabled
 
-  zone_size_t hitIndex = determineHitZone(evaluationVelocities, zoneCount, pad.settings.headRimBias);
-  if (pad.maxZoneValues[hitIndex] == 0) { // choked
-    return handleChoked();
+  return determineHitZone(evaluationVelocities, zoneCount, pad.settings.headRimBias);
+}
+
+// sends the hit with the peaks estimated from the rising edge, the scan continues to measure the real peaks
+void PiezoSensing::predictHit(time_us_t senseTimeUs, zone_size_t zoneCount) {
+  sensor_value_t predictedPeaks[3];
+  for (zone_size_t zone = 0; zone < zoneCount; ++zone) {
+    predictedPeaks[zone] = predictPeakOfZone(zone);
   }
 
+  zone_size_t hitIndex = evaluateHit(predictedPeaks, zoneCount);
+  if (predictedPeaks[hitIndex] == 0) { // maybe choked, decide at the end of the scan time
+    return;
+  }
+
+  pad.isHitPredicted = true;
+  pad.predictedHitZone = hitIndex;
+  pad.scanTimeEndUs = senseTimeUs; // time the hit is sent, updated again at the real end of the scan time
+
   pad.hits[hitIndex] = true;
   pad.cymbal.lastEventType = LastCymbalEventType::Hit;
   logHit(hitIndex, zoneCount);
+}
 
-  return SensingState::Mask;
+sensor_value_t PiezoSensing::predictPeakOfZone(zone_size_t zone) {
+  const sensor_value_t amplitude = pad.riseAmplitudes[zone];
+  return predictPeak(amplitude, amplitude - pad.riseStartValues[zone],
+    pad.settings.predictionAmplitudeGain, pad.settings.predictionRiseGain);
+}
+
+// records the rising edge and the measured peak of the hit zone, if the scan time was long enough to record the rising edge
+void PiezoSensing::recordCalibrationHit(zone_size_t hitIndex) {
+  if (pad.settings.predictionSampleCount == 0 || pad.scanSampleCount < pad.settings.predictionSampleCount) {
+    return;
+  }
+
+  const sensor_value_t amplitude = pad.riseAmplitudes[hitIndex];
+  pad.getVelocityCalibration().addHit(amplitude, amplitude - pad.riseStartValues[hitIndex],
+    pad.maxZoneValues[hitIndex], predictPeakOfZone(hitIndex));
 }
 
-// decayProgress: progress of decay in p.u. (0.0 .. 1.0). 0: start of decay, 1: end of decay 
+// decayProgress: progress of decay (0 .. FRACTION_Q16_ONE). 0: start of decay, FRACTION_Q16_ONE: end of decay 
 // returns true if peak detected
-bool PiezoSensing::detectPeakWithDecay(time_us_t senseTimeUs, float decayProgress) {
+bool PiezoSensing::detectPeakWithDecay(time_us_t senseTimeUs, fraction_q16_t decayProgress) {
   const zone_size_t activeZoneCount = pad.getActiveZoneCount();
   sensor_value_t zoneThresholdsMin[3];
   for (zone_size_t zone = 0; zone < activeZoneCount; ++zone) {
     sensor_value_t maxValue = pad.maxZoneValues[zone];
     sensor_value_t defaultThresholdMin = pad.settings.zoneThresholdsMin[zone];
 
-    zoneThresholdsMin[zone] = (maxValue > defaultThresholdMin)
-      ? maxValue - (maxValue - defaultThresholdMin) * decayProgress
-      : defaultThresholdMin;
+    zoneThresholdsMin[zone] = decayThreshold(maxValue, defaultThresholdMin, decayProgress);
   }
 
   return detectPeak(senseTimeUs, zoneThresholdsMin);
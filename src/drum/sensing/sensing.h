@@ -4,6 +4,7 @@
 #pragma once
 
 #include "sensing.h"
+#include "fixed_point.h"
 #include "types.h"
 
 enum class SensingState {
@@ -20,13 +21,14 @@ protected:
   Sensing(DrumPad& pad) : pad(pad) { }
 
   void resetHitInfo();
-  void readInputValues();
 
   bool isChoked(zone_size_t activeZoneCount);
   SensingState handleChoked();
 
   bool isZoneSwitchPressed(zone_size_t zone, zone_size_t activeZoneCount);
 
+  bool isPeakPassed(time_us_t senseTimeUs, zone_size_t piezoZoneCount);
+
   void logHit(zone_size_t hitIndex, zone_size_t zoneCount);
 
   static zone_size_t findMaxValueIndex(sensor_value_t* values, zone_size_t zoneCount, zone_size_t preferedIndex);
@@ -43,8 +45,13 @@ public:
 
 private:
   bool detectPeak(time_us_t senseTimeUs, sensor_value_t* zoneThresholdsMin);
-  bool detectPeakWithDecay(time_us_t senseTimeUs, float decayProgress);
+  bool detectPeakWithDecay(time_us_t senseTimeUs, fraction_q16_t decayProgress);
   SensingState scan(time_us_t senseTimeUs);
+  zone_size_t evaluateHit(const sensor_value_t* peakValues, zone_size_t zoneCount);
+
+  void predictHit(time_us_t senseTimeUs, zone_size_t zoneCount);
+  sensor_value_t predictPeakOfZone(zone_size_t zone);
+  void recordCalibrationHit(zone_size_t hitIndex);
 
   static zone_size_t determineHitZone(sensor_value_t* evaluationVelocities, zone_size_t zoneCount, int8_t headRimBias);
   
@@ -59,7 +66,7 @@ public:
 
 private:
   bool detectPeak(time_us_t senseTimeUs, sensor_value_t zoneThresholdMin);
-  bool detectPeakWithDecay(time_us_t senseTimeUs, float decayProgress);
+  bool detectPeakWithDecay(time_us_t senseTimeUs, fraction_q16_t decayProgress);
   SensingState scan(time_us_t senseTimeUs);
 
   zone_size_t determineHitZone();
@@ -16,27 +16,27 @@ void PiezoSwitchSensing::sense(time_us_t senseTimeUs) {
   }
 
   resetHitInfo();
-  readInputValues();
 
-  if (pad.sensingState == SensingState::PeakDetect) { // search for first peak
-    pad.sensingState = detectPeak(senseTimeUs, pad.settings.zoneThresholdsMin[MAIN_PIEZO_INDEX])
+  SensingState& state = *pad.sensingState;
+  if (state == SensingState::PeakDetect) { // search for first peak
+    state = detectPeak(senseTimeUs, pad.settings.zoneThresholdsMin[MAIN_PIEZO_INDEX])
       ? SensingState::Scan : SensingState::PeakDetect;
-  } else if (pad.sensingState == SensingState::Scan) { // search highest peak
-    pad.sensingState = scan(senseTimeUs);
-  } else if (pad.sensingState == SensingState::Mask) { // mask: ignore hits
+  } else if (state == SensingState::Scan) { // search highest peak
+    state = scan(senseTimeUs);
+  } else if (state == SensingState::Mask) { // mask: ignore hits
     bool maskActive = senseTimeUs - pad.scanTimeEndUs < pad.settings.maskTimeMs * 1000;
     if (!maskActive) {
-      pad.sensingState = (pad.settings.decayTimeMs > 0) ? SensingState::Decay : SensingState::PeakDetect;
+      state = (pad.settings.decayTimeMs > 0) ? SensingState::Decay : SensingState::PeakDetect;
     }
-  } else if (pad.sensingState == SensingState::Decay) {
+  } else if (state == SensingState::Decay) {
     time_us_t maskEndTimeUs = pad.scanTimeEndUs + pad.settings.maskTimeMs * 1000;
     time_us_t timeSinceDecayBeginUs = senseTimeUs - maskEndTimeUs;
     bool decayActive = timeSinceDecayBeginUs < pad.settings.decayTimeMs * 1000;
     if (!decayActive) {
-      pad.sensingState = SensingState::PeakDetect;
+      state = SensingState::PeakDetect;
     } else {
-      float decayProgress = (float) timeSinceDecayBeginUs / (pad.settings.decayTimeMs * 1000);
-      pad.sensingState = detectPeakWithDecay(senseTimeUs, decayProgress)
+      fraction_q16_t decayProgress = toFractionQ16(timeSinceDecayBeginUs, pad.settings.decayTimeMs * 1000);
+      state = detectPeakWithDecay(senseTimeUs, decayProgress)
       ? SensingState::Scan : SensingState::Decay;
     }
   }
@@ -56,6 +56,7 @@ bool PiezoSwitchSensing::detectPeak(time_us_t senseTimeUs, sensor_value_t zoneTh
 
   // peak detected or cymbal might be choked -> start scan time
   pad.hitTimeUs = senseTimeUs;
+  pad.samplesBelowPeakCount = 0;
 
   for (zone_size_t zone = 0; zone < activeZoneCount; ++zone) {
     pad.maxZoneValues[zone] = 0;
@@ -68,7 +69,8 @@ bool PiezoSwitchSensing::detectPeak(time_us_t senseTimeUs, sensor_value_t zoneTh
 SensingState PiezoSwitchSensing::scan(time_us_t senseTimeUs) {
   updateMaxSensorValue();
 
-  bool scanInProgress = senseTimeUs - pad.hitTimeUs < pad.settings.scanTimeUs;
+  bool scanInProgress = senseTimeUs - pad.hitTimeUs < pad.settings.scanTimeUs
+    && !isPeakPassed(senseTimeUs, MAIN_PIEZO_INDEX + 1); // switches have no peak
   if (scanInProgress) {
     return SensingState::Scan;
   }
@@ -85,7 +87,7 @@ SensingState PiezoSwitchSensing::scan(time_us_t senseTimeUs) {
   }
   
   zone_size_t hitIndex = determineHitZone();
-  pad.hitVelocities[hitIndex] = scaleAndCurve(maxPiezoValue, piezoThresholdMin, piezoThresholdMax, pad.settings.curveType);
+  pad.hitVelocities[hitIndex] = scaleAndCurve(maxPiezoValue, piezoThresholdMin, piezoThresholdMax, pad.getCurveTable());
   pad.hits[hitIndex] = true;
   pad.cymbal.lastEventType = LastCymbalEventType::Hit;
   logHit(hitIndex, pad.getActiveZoneCount());
@@ -93,15 +95,13 @@ SensingState PiezoSwitchSensing::scan(time_us_t senseTimeUs) {
   return SensingState::Mask;
 }
 
-// decayProgress: progress of decay in p.u. (0.0 .. 1.0). 0: start of decay, 1: end of decay 
+// decayProgress: progress of decay (0 .. FRACTION_Q16_ONE). 0: start of decay, FRACTION_Q16_ONE: end of decay 
 // returns true if peak detected
-bool PiezoSwitchSensing::detectPeakWithDecay(time_us_t senseTimeUs, float decayProgress) {
+bool PiezoSwitchSensing::detectPeakWithDecay(time_us_t senseTimeUs, fraction_q16_t decayProgress) {
   sensor_value_t maxValue = pad.maxZoneValues[MAIN_PIEZO_INDEX];
   sensor_value_t defaultThresholdMin = pad.settings.zoneThresholdsMin[MAIN_PIEZO_INDEX];
   
-  sensor_value_t zoneThresholdMin = (maxValue > defaultThresholdMin)
-    ? maxValue - (maxValue - defaultThresholdMin) * decayProgress
-    : defaultThresholdMin;
+  sensor_value_t zoneThresholdMin = decayThreshold(maxValue, defaultThresholdMin, decayProgress);
 
   return detectPeak(senseTimeUs, zoneThresholdMin);
 }
@@ -0,0 +1,58 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "velocity_prediction.h"
+
+#include <math.h>
+
+// the two-factor model is only fitted if the rise explains enough of the peak on its own
+const double MIN_RELATIVE_DETERMINANT = 1e-6;
+
+static int16_t toGain(double factor) {
+  const double gain = round(factor * 100);
+  return (gain >= INT16_MAX) ? INT16_MAX : ((gain <= INT16_MIN) ? INT16_MIN : (int16_t) gain);
+}
+
+void VelocityCalibration::addHit(sensor_value_t amplitude, sensor_value_t rise, sensor_value_t peak, sensor_value_t predictedPeak) {
+  ++hitCount;
+  sumAA += (uint32_t) amplitude * amplitude;
+  sumAR += (uint32_t) amplitude * rise;
+  sumRR += (uint32_t) rise * rise;
+  sumAP += (uint32_t) amplitude * peak;
+  sumRP += (uint32_t) rise * peak;
+  sumPP += (uint32_t) peak * peak;
+
+  const sensor_value_t error = (predictedPeak > peak) ? predictedPeak - peak : peak - predictedPeak;
+  errorSum += error;
+  if (error > errorMax) {
+    errorMax = error;
+  }
+}
+
+bool VelocityCalibration::fit(VelocityModelFit& result) const {
+  if (hitCount == 0 || sumAA == 0) {
+    return false;
+  }
+
+  // normal equations: [AA AR; AR RR] * [a; r] = [AP; RP]
+  const double aa = sumAA, ar = sumAR, rr = sumRR, ap = sumAP, rp = sumRP;
+  const double determinant = aa * rr - ar * ar;
+
+  double amplitudeFactor, riseFactor;
+  if (determinant > MIN_RELATIVE_DETERMINANT * aa * rr) {
+    amplitudeFactor = (ap * rr - rp * ar) / determinant;
+    riseFactor = (rp * aa - ap * ar) / determinant;
+  } else { // all hits have (almost) the same shape
+    amplitudeFactor = ap / aa;
+    riseFactor = 0;
+  }
+
+  result.amplitudeGain = toGain(amplitudeFactor);
+  result.riseGain = toGain(riseFactor);
+
+  // sum of squared residuals: PP - 2 * (a * AP + r * RP) + a^2 * AA + 2 * a * r * AR + r^2 * RR
+  const double a = result.amplitudeGain / 100.0, r = result.riseGain / 100.0;
+  const double squaredErrorSum = (double) sumPP - 2 * (a * ap + r * rp) + a * a * aa + 2 * a * r * ar + r * r * rr;
+  result.rmsError = (float) sqrt(fmax(squaredErrorSum, 0) / hitCount);
+  return true;
+}
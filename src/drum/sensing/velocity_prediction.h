@@ -0,0 +1,72 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "types.h"
+
+/**
+ * Estimates the peak of a hit from its rising edge, i.e. the first samples of the scan time:
+ *   peak = amplitudeGain % * amplitude + riseGain % * rise
+ *
+ * @param amplitude max. value of the first samples
+ * @param rise increase of the value during the first samples (slope)
+ * @result estimated peak, never below the amplitude as this value was already measured
+ */
+inline sensor_value_t predictPeak(sensor_value_t amplitude, sensor_value_t rise, int16_t amplitudeGain, int16_t riseGain) {
+  const int32_t peak = ((int32_t) amplitude * amplitudeGain + (int32_t) rise * riseGain) / 100;
+  if (peak <= amplitude) {
+    return amplitude;
+  }
+  return (peak >= MAX_SENSOR_VALUE) ? MAX_SENSOR_VALUE : (sensor_value_t) peak;
+}
+
+struct VelocityModelFit {
+  int16_t amplitudeGain; // %
+  int16_t riseGain; // %
+  float rmsError; // root-mean-square error of the fitted model for the recorded hits
+};
+
+/**
+ * Records the rising edges and the measured peaks of hits to calibrate the predictive velocity of a pad.
+ *
+ * The model is fitted with least squares. Only the sums of the normal equations are kept,
+ * so recording a hit needs a few additions and no memory for each hit.
+ * Independent of the model, the error of the current prediction is tracked.
+ */
+class VelocityCalibration {
+public:
+  void addHit(sensor_value_t amplitude, sensor_value_t rise, sensor_value_t peak, sensor_value_t predictedPeak);
+
+  /**
+   * Fits the model to the recorded hits. Falls back to an amplitude-only model if the rise does not vary enough.
+   * Returns false if no hits were recorded.
+   */
+  bool fit(VelocityModelFit& result) const;
+
+  uint32_t getHitCount() const { return hitCount; }
+  float getMeanError() const { return hitCount ? (float) errorSum / hitCount : 0; }
+  sensor_value_t getMaxError() const { return errorMax; }
+
+  // resets the prediction error, e.g. after the model changed. The recorded hits are kept.
+  void resetError() {
+    errorSum = 0;
+    errorMax = 0;
+  }
+
+  void reset() { *this = VelocityCalibration(); }
+
+private:
+  uint32_t hitCount = 0;
+
+  // sums of the normal equations (a: amplitude, r: rise, p: peak)
+  uint64_t sumAA = 0;
+  uint64_t sumAR = 0;
+  uint64_t sumRR = 0;
+  uint64_t sumAP = 0;
+  uint64_t sumRP = 0;
+  uint64_t sumPP = 0;
+
+  uint64_t errorSum = 0;
+  sensor_value_t errorMax = 0;
+};
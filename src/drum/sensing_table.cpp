@@ -0,0 +1,129 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "sensing_table.h"
+
+// never reached by a sensor value, used for zones that cannot start a hit
+#define NO_PEAK_THRESHOLD UINT16_MAX
+
+void SensingTable::build(DrumPad* pads, pad_size_t padsCount) {
+  // save the state by pad, as the rows will be reordered
+  struct PadState {
+    SensingState sensingState;
+    sensor_value_t sensorValues[MAX_ZONE_COUNT];
+    sensor_value_t maxZoneValues[MAX_ZONE_COUNT];
+    midi_velocity_t hitVelocities[MAX_ZONE_COUNT];
+    bool hits[MAX_ZONE_COUNT];
+  } padStates[MAX_PAD_COUNT];
+
+  for (pad_size_t padIndex = 0; padIndex < MAX_PAD_COUNT; ++padIndex) {
+    const pad_size_t row = rows[padIndex];
+    PadState& padState = padStates[padIndex];
+    padState.sensingState = sensingStates[row];
+    for (zone_size_t zone = 0; zone < MAX_ZONE_COUNT; ++zone) {
+      padState.sensorValues[zone] = sensorValues[row][zone];
+      padState.maxZoneValues[zone] = maxZoneValues[row][zone];
+      padState.hitVelocities[zone] = hitVelocities[row][zone];
+      padState.hits[zone] = hits[row][zone];
+    }
+  }
+
+  // active pads first, then all others
+  pad_size_t rowsCount = 0;
+  for (pad_size_t padIndex = 0; padIndex < padsCount; ++padIndex) {
+    if (isActive(pads[padIndex])) {
+      padIndices[rowsCount++] = padIndex;
+    }
+  }
+  activePadsCount = rowsCount;
+  for (pad_size_t padIndex = 0; padIndex < MAX_PAD_COUNT; ++padIndex) {
+    if (padIndex >= padsCount || !isActive(pads[padIndex])) {
+      padIndices[rowsCount++] = padIndex;
+    }
+  }
+
+  for (pad_size_t row = 0; row < MAX_PAD_COUNT; ++row) {
+    const pad_size_t padIndex = padIndices[row];
+    const PadState& padState = padStates[padIndex];
+    rows[padIndex] = row;
+
+    sensingStates[row] = padState.sensingState;
+    for (zone_size_t zone = 0; zone < MAX_ZONE_COUNT; ++zone) {
+      sensorValues[row][zone] = padState.sensorValues[zone];
+      maxZoneValues[row][zone] = padState.maxZoneValues[zone];
+      hitVelocities[row][zone] = padState.hitVelocities[zone];
+      hits[row][zone] = padState.hits[zone];
+    }
+
+    DrumPad& pad = pads[padIndex];
+    pad.sensingState = &sensingStates[row];
+    pad.sensorValues = sensorValues[row];
+    pad.maxZoneValues = maxZoneValues[row];
+    pad.hitVelocities = hitVelocities[row];
+    pad.hits = hits[row];
+
+    if (row < activePadsCount) {
+      permanentEvaluation[row] = needsPermanentEvaluation(pad);
+      updatePeakThresholds(row, pad);
+    }
+  }
+}
+
+pad_size_t SensingTable::findPadsToEvaluate(pad_size_t* padIndices) const {
+  pad_size_t count = 0;
+  for (pad_size_t row = 0; row < activePadsCount; ++row) {
+    // bitwise operators to avoid branches, all arrays are only read sequentially
+    const bool isIdle = (sensingStates[row] == SensingState::PeakDetect)
+      & !permanentEvaluation[row]
+      & !(hits[row][0] | hits[row][1] | hits[row][2]);
+    const bool isPeak = (sensorValues[row][0] >= peakThresholds[row][0])
+      | (sensorValues[row][1] >= peakThresholds[row][1])
+      | (sensorValues[row][2] >= peakThresholds[row][2]);
+
+    padIndices[count] = this->padIndices[row];
+    count += !isIdle | isPeak;
+  }
+  return count;
+}
+
+pad_size_t SensingTable::findScanningPads(pad_size_t* padIndices) const {
+  pad_size_t count = 0;
+  for (pad_size_t row = 0; row < activePadsCount; ++row) {
+    const bool isScanning = (sensingStates[row] == SensingState::Scan)
+      & !(hits[row][0] | hits[row][1] | hits[row][2]);
+
+    padIndices[count] = this->padIndices[row];
+    count += isScanning;
+  }
+  return count;
+}
+
+bool SensingTable::isActive(const DrumPad& pad) {
+  // pedals are evaluated together with their hi-hat
+  return pad.isEnabled() && pad.isConnectorActive() && pad.getPadType() != PadType::Pedal;
+}
+
+bool SensingTable::needsPermanentEvaluation(const DrumPad& pad) {
+  const DrumSettings& settings = pad.getSettings();
+  if (settings.zonesType == ZonesType::Zones1_Controller) {
+    return true; // reads its input itself
+  }
+
+  // pedal movements and choke switches/sensors must be checked even if the cymbal is not hit
+  return pad.getPadType() == PadType::Cymbal
+    && (pad.getPedalPad() || settings.chokeType != ChokeType::None);
+}
+
+void SensingTable::updatePeakThresholds(pad_size_t row, const DrumPad& pad) {
+  const DrumSettings& settings = pad.getSettings();
+
+  // pads with switches can only be hit by the piezo, the switches are evaluated afterwards
+  const bool hasSwitches = settings.zonesType == ZonesType::Zones2_PiezoAndSwitch
+    || settings.zonesType == ZonesType::Zones3_PiezoAndSwitches_1TRS
+    || settings.zonesType == ZonesType::Zones3_PiezoAndSwitches_2TRS;
+  const zone_size_t peakZoneCount = hasSwitches ? min(pad.getActiveZoneCount(), (zone_size_t) 1) : pad.getActiveZoneCount();
+
+  for (zone_size_t zone = 0; zone < MAX_ZONE_COUNT; ++zone) {
+    peakThresholds[row][zone] = (zone < peakZoneCount) ? settings.zoneThresholdsMin[zone] : NO_PEAK_THRESHOLD;
+  }
+}
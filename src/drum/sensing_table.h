@@ -0,0 +1,78 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "config/config_mapper.h"
+#include "drum_pad.h"
+
+/**
+ * Hot sensing state of all pads in a structure-of-arrays layout.
+ *
+ * Each pad owns one row. The rows of the active pads (enabled, connected and not a pedal) come first,
+ * so the evaluation pass only walks a few contiguous arrays instead of the DrumPad objects with their names,
+ * settings and pointers. The DrumPads keep views (sensorValues, hits, ...) onto their row.
+ *
+ * The table is built once whenever the kit configuration changes.
+ */
+class SensingTable {
+public:
+  SensingTable() {
+    for (pad_size_t index = 0; index < MAX_PAD_COUNT; ++index) {
+      padIndices[index] = index;
+      rows[index] = index;
+    }
+  }
+
+  // disable shallow copies
+  SensingTable(const SensingTable&) = delete;
+  SensingTable& operator=(const SensingTable&) = delete;
+
+  // enable move semantic
+  SensingTable(SensingTable&& other) = default;
+  SensingTable& operator=(SensingTable&& other) = default;
+
+public:
+  /**
+   * Assigns a row to each of the MAX_PAD_COUNT pads and binds the views of the pads to it.
+   * The sensing state of the pads is kept.
+   */
+  void build(DrumPad* pads, pad_size_t padsCount);
+
+  pad_size_t getActivePadsCount() const { return activePadsCount; }
+  pad_size_t getActivePadIndex(pad_size_t row) const { return padIndices[row]; }
+
+  /**
+   * Writes the indices of all active pads that must be evaluated in this iteration to padIndices and returns their count.
+   *
+   * Pads that wait for a peak, have no input above their threshold and no pending hit info are skipped.
+   * The sensor values must have been read before.
+   */
+  pad_size_t findPadsToEvaluate(pad_size_t* padIndices) const;
+
+  /**
+   * Writes the indices of all active pads in the scan time without a pending hit info to padIndices and returns their count.
+   */
+  pad_size_t findScanningPads(pad_size_t* padIndices) const;
+
+private:
+  static bool isActive(const DrumPad& pad);
+  static bool needsPermanentEvaluation(const DrumPad& pad);
+  void updatePeakThresholds(pad_size_t row, const DrumPad& pad);
+
+private:
+  pad_size_t activePadsCount = 0;
+  pad_size_t padIndices[MAX_PAD_COUNT]; // pad of each row
+  pad_size_t rows[MAX_PAD_COUNT]; // row of each pad
+
+  // config, only valid for the rows of the active pads
+  bool permanentEvaluation[MAX_PAD_COUNT] = {};
+  sensor_value_t peakThresholds[MAX_PAD_COUNT][MAX_ZONE_COUNT] = {};
+
+  // state
+  SensingState sensingStates[MAX_PAD_COUNT] = {};
+  sensor_value_t sensorValues[MAX_PAD_COUNT][MAX_ZONE_COUNT] = {};
+  sensor_value_t maxZoneValues[MAX_PAD_COUNT][MAX_ZONE_COUNT] = {};
+  midi_velocity_t hitVelocities[MAX_PAD_COUNT][MAX_ZONE_COUNT] = {};
+  bool hits[MAX_PAD_COUNT][MAX_ZONE_COUNT] = {};
+};
@@ -0,0 +1,62 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "settling_tracker.h"
+
+void SettlingTracker::reset() {
+  for (scan_slot_t slot = 0; slot < MAX_SCAN_SLOTS; ++slot) {
+    pins[slot] = nullptr;
+    unsettled[slot] = false;
+  }
+  unsettledCount = 0;
+}
+
+void SettlingTracker::addPin(scan_slot_t slot, const DrumPin& pin) {
+  if (pin.getSignalType() == SignalType::VoltageOffset && !pins[slot]) {
+    pins[slot] = &pin;
+  }
+}
+
+void SettlingTracker::startSettling(time_us_t timeUs) {
+  unsettledCount = 0;
+  for (scan_slot_t slot = 0; slot < MAX_SCAN_SLOTS; ++slot) {
+    unsettled[slot] = pins[slot] != nullptr;
+    stableSampleCounts[slot] = 0;
+    unsettledCount += unsettled[slot];
+  }
+  settlingStartTimeUs = timeUs;
+  lastUpdateTimeUs = timeUs;
+}
+
+void SettlingTracker::update(const DrumScanner& scanner, time_us_t timeUs) {
+  if (unsettledCount == 0) {
+    return;
+  }
+
+  suppressedTimeUs += (uint64_t) (timeUs - lastUpdateTimeUs) * unsettledCount;
+  lastUpdateTimeUs = timeUs;
+
+  const bool isTimeout = timeUs - settlingStartTimeUs >= SETTLE_TIMEOUT_US;
+  for (scan_slot_t slot = 0; slot < scanner.getSlotsCount(); ++slot) {
+    if (!unsettled[slot] || scanner.isSlotSkipped(slot)) {
+      continue;
+    }
+
+    const sensor_value_t sample = scanner.getSample(slot);
+    const sensor_value_t offset = pins[slot]->getOffset();
+    const sensor_value_t deviation = (sample > offset) ? sample - offset : offset - sample;
+    stableSampleCounts[slot] = (deviation <= SETTLE_TOLERANCE) ? stableSampleCounts[slot] + 1 : 0;
+
+    if (stableSampleCounts[slot] >= SETTLE_SAMPLE_COUNT || isTimeout) {
+      unsettled[slot] = false;
+      --unsettledCount;
+    }
+  }
+
+  if (isTimeout) { // slots that were skipped during the whole time
+    for (scan_slot_t slot = 0; slot < MAX_SCAN_SLOTS; ++slot) {
+      unsettled[slot] = false;
+    }
+    unsettledCount = 0;
+  }
+}
@@ -0,0 +1,75 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "drum_pin.h"
+#include "drum_scanner.h"
+
+// max. deviation from the offset of the pin that is considered as settled
+#define SETTLE_TOLERANCE (MAX_SENSOR_VALUE / 20)
+// number of consecutive samples within the tolerance until an input is settled
+#define SETTLE_SAMPLE_COUNT 4
+// inputs are considered as settled after this time even if they still deviate (e.g. because a pad is hit)
+#define SETTLE_TIMEOUT_US (100 * 1000)
+
+/**
+ * Tracks the inputs with a voltage offset that have to settle after they were not read for a longer time.
+ *
+ * If the multiplexers are not read for a longer time (e.g. because the main loop is busy with webui tasks),
+ * the line capacitance of the multiplexer input pins can cause wrong readings as the voltage drops to 0V and
+ * needs to be stabilized to the bias voltage first (~1.5V if no pad is hit or switch is pressed).
+ * This will take longer the higher the capacitance and resistance of a line is.
+ *
+ * Instead of reading all inputs until the slowest one is stable, each slot of the scan plan is tracked separately
+ * with the samples of the normal sweeps. Only the pads using unsettled slots have to be suppressed.
+ */
+class SettlingTracker {
+public:
+  SettlingTracker() = default;
+
+  // disable shallow copies
+  SettlingTracker(const SettlingTracker&) = delete;
+  SettlingTracker& operator=(const SettlingTracker&) = delete;
+
+  // enable move semantic
+  SettlingTracker(SettlingTracker&& other) = default;
+  SettlingTracker& operator=(SettlingTracker&& other) = default;
+
+public:
+  /**
+   * Removes all slots, must be called when the scan plan is rebuilt.
+   */
+  void reset();
+
+  /**
+   * Tracks the slot of a pin if the pin has a voltage offset.
+   */
+  void addPin(scan_slot_t slot, const DrumPin& pin);
+
+  /**
+   * Marks all tracked slots as unsettled.
+   */
+  void startSettling(time_us_t timeUs);
+
+  /**
+   * Checks the samples of the last sweep of all unsettled slots.
+   */
+  void update(const DrumScanner& scanner, time_us_t timeUs);
+
+  bool isSettling() const { return unsettledCount > 0; }
+  bool isSettled(scan_slot_t slot) const { return !unsettled[slot]; }
+
+  // sum of the time each slot was suppressed while settling
+  uint64_t getSuppressedTimeUs() const { return suppressedTimeUs; }
+
+private:
+  const DrumPin* pins[MAX_SCAN_SLOTS] = {}; // only slots with a voltage offset
+  bool unsettled[MAX_SCAN_SLOTS] = {};
+  uint8_t stableSampleCounts[MAX_SCAN_SLOTS] = {};
+  scan_slot_t unsettledCount = 0;
+
+  time_us_t settlingStartTimeUs = 0;
+  time_us_t lastUpdateTimeUs = 0;
+  uint64_t suppressedTimeUs = 0;
+};
@@ -8,6 +8,8 @@
 #define MAX_SENSOR_VALUE ((sensor_value_t) 1023)
 #define INVALID_SENSOR_VALUE UINT16_MAX
 
+#define MAX_ZONE_COUNT 3
+
 #define MAX_MIDI_NOTE 127
 #define MIDI_NOTE_UNASSIGNED 255
 
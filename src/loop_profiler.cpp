@@ -0,0 +1,103 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "loop_profiler.h"
+
+#include <stdio.h>
+
+#ifdef ENABLE_LOOP_PROFILER
+LoopProfiler loopProfiler;
+#endif
+
+uint8_t CostHistogram::getBucketIndex(uint32_t valueUs) {
+  if (valueUs < COST_HISTOGRAM_LINEAR_LIMIT) {
+    return valueUs;
+  }
+
+  valueUs = min(valueUs, (uint32_t) (1 << COST_HISTOGRAM_MAX_BITS) - 1);
+  const uint8_t exponent = 31 - __builtin_clz(valueUs); // 4 .. MAX_BITS-1
+  const uint8_t subBucket = (valueUs >> (exponent - 2)) & 0x3; // the two bits after the leading one
+  return COST_HISTOGRAM_LINEAR_LIMIT + (exponent - 4) * 4 + subBucket;
+}
+
+uint32_t CostHistogram::getBucketUpperBoundUs(uint8_t bucketIndex) {
+  if (bucketIndex < COST_HISTOGRAM_LINEAR_LIMIT) {
+    return bucketIndex;
+  }
+
+  const uint8_t exponent = 4 + (bucketIndex - COST_HISTOGRAM_LINEAR_LIMIT) / 4;
+  const uint8_t subBucket = (bucketIndex - COST_HISTOGRAM_LINEAR_LIMIT) % 4;
+  const uint32_t lowerBound = (4 + subBucket) << (exponent - 2);
+  return lowerBound + (1 << (exponent - 2)) - 1;
+}
+
+void CostHistogram::record(uint32_t valueUs) {
+  ++buckets[getBucketIndex(valueUs)];
+  ++count;
+  sumUs += valueUs;
+  if (valueUs < minUs) {
+    minUs = valueUs;
+  }
+  if (valueUs > maxUs) {
+    maxUs = valueUs;
+  }
+}
+
+void CostHistogram::reset() {
+  *this = CostHistogram();
+}
+
+uint32_t CostHistogram::getPercentileUs(uint8_t percent) const {
+  if (count == 0) {
+    return 0;
+  }
+
+  const uint32_t rank = ((uint64_t) count * percent + 99) / 100; // rounded up
+  uint32_t cumulatedCount = 0;
+  for (uint8_t i = 0; i < COST_HISTOGRAM_BUCKET_COUNT; ++i) {
+    cumulatedCount += buckets[i];
+    if (cumulatedCount >= rank) {
+      return min(getBucketUpperBoundUs(i), maxUs);
+    }
+  }
+  return maxUs;
+}
+
+void LoopProfiler::startSensing(time_us_t timeUs) {
+  if (!isFirstSensing) {
+    sensingPeriod.record(timeUs - lastSensingTimeUs);
+  }
+  lastSensingTimeUs = timeUs;
+  isFirstSensing = false;
+}
+
+void LoopProfiler::endPhase(LoopPhase phase, time_us_t& phaseStartUs) {
+  const time_us_t nowUs = micros();
+  phaseCosts[(uint8_t) phase].record(nowUs - phaseStartUs);
+  phaseStartUs = nowUs;
+}
+
+void LoopProfiler::reset() {
+  sensingPeriod.reset();
+  for (CostHistogram& histogram : phaseCosts) {
+    histogram.reset();
+  }
+  isFirstSensing = true;
+}
+
+static String histogramToString(const String& name, const CostHistogram& histogram) {
+  char text[120];
+  snprintf(text, sizeof(text), "%-14s count: %8u  min: %6u  avg: %6u  p99: %6u  max: %6u us",
+    name.c_str(), (unsigned) histogram.getCount(), (unsigned) histogram.getMinUs(), (unsigned) histogram.getAvgUs(),
+    (unsigned) histogram.getPercentileUs(99), (unsigned) histogram.getMaxUs());
+  return String(text);
+}
+
+String LoopProfiler::toString() const {
+  String result = histogramToString("SensingPeriod", sensingPeriod);
+  for (uint8_t phase = 0; phase < LOOP_PHASE_COUNT; ++phase) {
+    result += "\n";
+    result += histogramToString(loopPhaseToString((LoopPhase) phase), phaseCosts[phase]);
+  }
+  return result;
+}
@@ -0,0 +1,121 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "types.h"
+#include "util.h"
+
+#include <Arduino.h>
+
+enum class LoopPhase : uint8_t {
+  // sensing core, see DrumKit::updateDrums()
+  MuxRead,
+  PadEvaluation, // including the oversampling of pads in the scan time
+  Monitor,
+  // main core, see loop()
+  Network,
+  MidiTransport,
+  UsbDevice
+};
+
+#define LOOP_PHASE_COUNT 6
+
+inline String loopPhaseToString(LoopPhase value) {
+  using enum LoopPhase;
+  MAP_ENUM_TO_STRING(MuxRead);
+  MAP_ENUM_TO_STRING(PadEvaluation);
+  MAP_ENUM_TO_STRING(Monitor);
+  MAP_ENUM_TO_STRING(Network);
+  MAP_ENUM_TO_STRING(MidiTransport);
+  MAP_ENUM_TO_STRING(UsbDevice);
+  return ENUM_TO_STRING(MuxRead);
+}
+
+// values below are counted exactly, above with 4 buckets per power of two (max. error 25%)
+#define COST_HISTOGRAM_LINEAR_LIMIT 16
+#define COST_HISTOGRAM_MAX_BITS 24 // values are clamped to ~16s
+#define COST_HISTOGRAM_BUCKET_COUNT (COST_HISTOGRAM_LINEAR_LIMIT + (COST_HISTOGRAM_MAX_BITS - 4) * 4)
+
+/**
+ * Histogram of durations in us with a fixed number of logarithmic buckets, so that recording
+ * does not allocate and takes constant time.
+ */
+class CostHistogram {
+public:
+  void record(uint32_t valueUs);
+  void reset();
+
+  uint32_t getCount() const { return count; }
+  uint32_t getMinUs() const { return count ? minUs : 0; }
+  uint32_t getMaxUs() const { return maxUs; }
+  uint32_t getAvgUs() const { return count ? sumUs / count : 0; }
+
+  /**
+   * Upper bound of the bucket that contains the given percentile, e.g. 99 for the p99.
+   */
+  uint32_t getPercentileUs(uint8_t percent) const;
+
+  static uint8_t getBucketIndex(uint32_t valueUs);
+  static uint32_t getBucketUpperBoundUs(uint8_t bucketIndex);
+
+private:
+  uint32_t buckets[COST_HISTOGRAM_BUCKET_COUNT] = {};
+  uint32_t count = 0;
+  uint32_t minUs = UINT32_MAX;
+  uint32_t maxUs = 0;
+  uint64_t sumUs = 0;
+};
+
+/**
+ * Measures the cost of the phases of the main and the sensing loop and the period of the sensing,
+ * e.g. to find out which subsystem delayed the sensing if hits were missed.
+ *
+ * The histograms of a phase are only written by the core that runs the phase. They must be read or
+ * reset by the main core while the sensing is paused.
+ *
+ * The profiler is only compiled if ENABLE_LOOP_PROFILER is defined, use the LOOP_PROFILER_* macros
+ * to instrument the code.
+ */
+class LoopProfiler {
+public:
+  /**
+   * Records the time since the start of the last sensing iteration.
+   */
+  void startSensing(time_us_t timeUs);
+
+  /**
+   * Records the cost of a phase that started at phaseStartUs and sets phaseStartUs to the end of the phase.
+   */
+  void endPhase(LoopPhase phase, time_us_t& phaseStartUs);
+
+  void reset();
+
+  const CostHistogram& getSensingPeriod() const { return sensingPeriod; }
+  const CostHistogram& getPhaseCost(LoopPhase phase) const { return phaseCosts[(uint8_t) phase]; }
+
+  // human readable report, one line per histogram
+  String toString() const;
+
+private:
+  CostHistogram sensingPeriod;
+  CostHistogram phaseCosts[LOOP_PHASE_COUNT];
+  time_us_t lastSensingTimeUs = 0;
+  bool isFirstSensing = true;
+};
+
+#ifdef ENABLE_LOOP_PROFILER
+
+extern LoopProfiler loopProfiler;
+
+#define LOOP_PROFILER_START_SENSING(timeUs) loopProfiler.startSensing(timeUs)
+#define LOOP_PROFILER_START(timeUs) time_us_t loopPhaseStartUs = (timeUs)
+#define LOOP_PROFILER_END_PHASE(phase) loopProfiler.endPhase(phase, loopPhaseStartUs)
+
+#else
+
+#define LOOP_PROFILER_START_SENSING(timeUs)
+#define LOOP_PROFILER_START(timeUs)
+#define LOOP_PROFILER_END_PHASE(phase)
+
+#endif
@@ -5,8 +5,10 @@
 #include "drum_kit.h"
 #include "event_log.h"
 #include "log.h"
+#include "loop_profiler.h"
 #include "midi_transport.h"
 #include "network_connection.h"
+#include "sensing_core.h"
 #include "usb_device.h"
 #include "version.h"
 #include "webui.h"
@@ -36,7 +38,6 @@ void setup() {
 
   networkConnection.begin();
 
-  // TODO: move WebUI server to core1
   webUI.setup(drumKit);
 
 #if ENABLE_MASS_STORAGE
@@ -44,15 +45,24 @@ void setup() {
 #endif
 
   midiTransport.update();
+
+  SensingCore::start();
 }
 
 void loop() {
-  drumKit.updateDrums();
+  if (!SensingCore::isRunningOnOwnCore()) {
+    SensingCore::update();
+  }
+  SensingCore::forwardOutput();
 
+  LOOP_PROFILER_START(micros());
   networkConnection.update();
+  LOOP_PROFILER_END_PHASE(LoopPhase::Network);
   midiTransport.update();
+  LOOP_PROFILER_END_PHASE(LoopPhase::MidiTransport);
 
   UsbDevice::update();
+  LOOP_PROFILER_END_PHASE(LoopPhase::UsbDevice);
 
   DrumIO::update();
 }
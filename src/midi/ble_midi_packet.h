@@ -0,0 +1,114 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "midi_message.h"
+
+#include <stddef.h>
+
+// ATT default MTU (23) minus the 3 bytes of the ATT header
+#define BLE_MIDI_DEFAULT_PACKET_SIZE 20
+
+// header, timestamp and a message with two data bytes
+#define BLE_MIDI_MIN_PACKET_SIZE 5
+
+// enough for about a dozen simultaneous hits if the connection has a larger MTU
+#define BLE_MIDI_PACKET_BUFFER_SIZE 64
+
+#define BLE_MIDI_TIMESTAMP_MASK 0x1FFF
+
+/**
+ * Encodes channel messages as a BLE-MIDI packet (BLE-MIDI 1.0 spec, chapter 3.1):
+ * a header byte with the bits 12..7 of the 13-bit millisecond timestamp, followed by the messages,
+ * each with a timestamp byte with the bits 6..0 of its timestamp.
+ *
+ * Every message gets the time of its event as timestamp (MidiMessage::timeUs), so the receiver can
+ * play the hits of a packet with their original spacing.
+ * - the status byte is omitted if it is the same as the one of the previous message (running status)
+ * - the timestamps within a packet must not decrease, an earlier message gets the timestamp of its predecessor
+ * - the receiver detects the overflow of the low timestamp bits, so a message that is more than 127ms
+ *   after its predecessor does not fit and has to be sent in the next packet
+ */
+class BleMidiPacketEncoder {
+public:
+  /**
+   * Sets the max. size of the packet, e.g. the ATT MTU of the connection - 3.
+   * 0 (e.g. not connected) selects the size of the default MTU.
+   */
+  void setMaxPacketSize(size_t size) {
+    if (size == 0) {
+      size = BLE_MIDI_DEFAULT_PACKET_SIZE;
+    } else if (size < BLE_MIDI_MIN_PACKET_SIZE) {
+      size = BLE_MIDI_MIN_PACKET_SIZE;
+    } else if (size > BLE_MIDI_PACKET_BUFFER_SIZE) {
+      size = BLE_MIDI_PACKET_BUFFER_SIZE;
+    }
+    maxPacketSize = size;
+  }
+
+  size_t getMaxPacketSize() const { return maxPacketSize; }
+
+  /**
+   * Adds the message to the packet.
+   * @return false if the message does not fit, the packet has to be sent first
+   */
+  bool addMessage(const MidiMessage& message) {
+    uint16_t timestamp = toTimestamp(message.timeUs);
+    if (size > 0) {
+      const uint16_t delta = (timestamp - lastTimestamp) & BLE_MIDI_TIMESTAMP_MASK;
+      if (delta > BLE_MIDI_TIMESTAMP_MASK / 2) {
+        timestamp = lastTimestamp; // earlier than the previous message
+      } else if (delta > 0x7F) {
+        return false;
+      }
+    }
+
+    const uint8_t status = toMidiStatus(message.type, message.channel);
+    const bool isRunningStatus = size > 0 && status == runningStatus;
+    const uint8_t dataSize = (message.type == MidiMessageType::ChannelAfterTouch) ? 1 : 2;
+    const size_t messageSize = (size == 0 ? 1 : 0) + 1 + (isRunningStatus ? 0 : 1) + dataSize;
+    if (size + messageSize > maxPacketSize) {
+      return false;
+    }
+
+    if (size == 0) {
+      packet[size++] = 0x80 | ((timestamp >> 7) & 0x3F);
+    }
+    packet[size++] = 0x80 | (timestamp & 0x7F);
+    if (!isRunningStatus) {
+      packet[size++] = status;
+      runningStatus = status;
+    }
+    packet[size++] = message.data1 & 0x7F;
+    if (dataSize == 2) {
+      packet[size++] = message.data2 & 0x7F;
+    }
+    lastTimestamp = timestamp;
+    ++messageCount;
+    return true;
+  }
+
+  void clear() {
+    size = 0;
+    messageCount = 0;
+    runningStatus = 0;
+  }
+
+  bool isEmpty() const { return size == 0; }
+  const uint8_t* getPacket() const { return packet; }
+  size_t getPacketSize() const { return size; }
+  uint8_t getMessageCount() const { return messageCount; }
+
+  static uint16_t toTimestamp(time_us_t timeUs) {
+    return (timeUs / 1000) & BLE_MIDI_TIMESTAMP_MASK;
+  }
+
+private:
+  uint8_t packet[BLE_MIDI_PACKET_BUFFER_SIZE];
+  size_t size = 0;
+  size_t maxPacketSize = BLE_MIDI_DEFAULT_PACKET_SIZE;
+  uint8_t messageCount = 0;
+  uint8_t runningStatus = 0;
+  uint16_t lastTimestamp = 0;
+};
@@ -0,0 +1,128 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "midi_transport.h"
+
+// max. number of messages per batch, NoteOffs are counted separately
+#define DIN_MIDI_BATCH_SIZE 32
+
+/**
+ * Encodes a batch of channel messages for the serial DIN port, where every byte takes 320us at 31.25 kbaud.
+ *
+ * To keep the messages short:
+ * - NoteOffs with velocity 0 are sent as NoteOn with velocity 0, so that they share the status byte with the NoteOns
+ * - the status byte is omitted if it is the same as the one of the previous message (running status)
+ * - NoteOffs are deferred to the end of the batch, so that all NoteOns of a chord arrive as early as possible.
+ *   A NoteOff is only sent earlier if its note is started again in the same batch.
+ *
+ * The running status starts new with each batch, so a receiver that missed a status byte resyncs on the next batch.
+ */
+class DinMidiEncoder {
+public:
+  void addNoteOn(uint8_t note, uint8_t velocity, midi_channel_t channel) {
+    const uint8_t status = toMidiStatus(MidiMessageType::NoteOn, channel);
+    // the note has to stop before it is started again
+    for (uint8_t i = 0; i < deferredCount; ++i) {
+      if (deferredNoteOffs[i].data1 == (note & 0x7F) && (deferredNoteOffs[i].status & 0x0F) == (status & 0x0F)) {
+        addMessage(messages, messageCount, deferredNoteOffs[i]);
+        removeDeferredNoteOff(i);
+        break;
+      }
+    }
+    addMessage(messages, messageCount, {status, (uint8_t) (note & 0x7F), (uint8_t) (velocity & 0x7F)});
+  }
+
+  void addNoteOff(uint8_t note, uint8_t velocity, midi_channel_t channel) {
+    if (velocity == 0) {
+      addMessage(deferredNoteOffs, deferredCount, {toMidiStatus(MidiMessageType::NoteOn, channel), (uint8_t) (note & 0x7F), 0});
+    } else {
+      // keep the release velocity
+      addMessage(deferredNoteOffs, deferredCount, {toMidiStatus(MidiMessageType::NoteOff, channel), (uint8_t) (note & 0x7F), (uint8_t) (velocity & 0x7F)});
+    }
+  }
+
+  void addPolyAfterTouch(uint8_t note, uint8_t pressure, midi_channel_t channel) {
+    addMessage(messages, messageCount, {toMidiStatus(MidiMessageType::PolyAfterTouch, channel), (uint8_t) (note & 0x7F), (uint8_t) (pressure & 0x7F)});
+  }
+
+  void addControlChange(uint8_t controlNumber, uint8_t controlValue, midi_channel_t channel) {
+    addMessage(messages, messageCount, {toMidiStatus(MidiMessageType::ControlChange, channel), (uint8_t) (controlNumber & 0x7F), (uint8_t) (controlValue & 0x7F)});
+  }
+
+  void addChannelAfterTouch(uint8_t pressure, midi_channel_t channel) {
+    addMessage(messages, messageCount, {toMidiStatus(MidiMessageType::ChannelAfterTouch, channel), (uint8_t) (pressure & 0x7F), 0});
+  }
+
+  bool isEmpty() const { return messageCount == 0 && deferredCount == 0; }
+  bool isFull() const { return messageCount == DIN_MIDI_BATCH_SIZE || deferredCount == DIN_MIDI_BATCH_SIZE; }
+
+  uint32_t getDroppedCount() const { return droppedCount; }
+
+  // upper bound of the encoded size of the messages in the batch
+  size_t getMaxEncodedSize() const { return (messageCount + deferredCount) * MIDI_MAX_MESSAGE_SIZE; }
+
+  /**
+   * Encodes the batch and clears it.
+   * @param buffer must have room for getMaxBatchSize() bytes
+   * @return number of bytes written to buffer
+   */
+  size_t encodeBatch(uint8_t* buffer) {
+    size_t size = 0;
+    uint8_t runningStatus = 0;
+    for (uint8_t i = 0; i < messageCount; ++i) {
+      size += encodeMessage(messages[i], runningStatus, buffer + size);
+    }
+    for (uint8_t i = 0; i < deferredCount; ++i) {
+      size += encodeMessage(deferredNoteOffs[i], runningStatus, buffer + size);
+    }
+    messageCount = 0;
+    deferredCount = 0;
+    return size;
+  }
+
+  static constexpr size_t getMaxBatchSize() { return 2 * DIN_MIDI_BATCH_SIZE * MIDI_MAX_MESSAGE_SIZE; }
+
+private:
+  struct Message {
+    uint8_t status;
+    uint8_t data1;
+    uint8_t data2;
+  };
+
+  void addMessage(Message* list, uint8_t& count, const Message& message) {
+    if (count == DIN_MIDI_BATCH_SIZE) {
+      ++droppedCount;
+      return;
+    }
+    list[count++] = message;
+  }
+
+  void removeDeferredNoteOff(uint8_t index) {
+    for (uint8_t i = index + 1; i < deferredCount; ++i) {
+      deferredNoteOffs[i - 1] = deferredNoteOffs[i];
+    }
+    --deferredCount;
+  }
+
+  static size_t encodeMessage(const Message& message, uint8_t& runningStatus, uint8_t* buffer) {
+    size_t size = 0;
+    if (message.status != runningStatus) {
+      buffer[size++] = message.status;
+      runningStatus = message.status;
+    }
+    buffer[size++] = message.data1;
+    if ((message.status & 0xF0) != 0xD0) { // channel aftertouch has only one data byte
+      buffer[size++] = message.data2;
+    }
+    return size;
+  }
+
+private:
+  Message messages[DIN_MIDI_BATCH_SIZE];
+  uint8_t messageCount = 0;
+  Message deferredNoteOffs[DIN_MIDI_BATCH_SIZE];
+  uint8_t deferredCount = 0;
+  uint32_t droppedCount = 0;
+};
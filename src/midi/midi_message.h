@@ -0,0 +1,54 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "types.h"
+
+#include <stdint.h>
+
+typedef uint8_t midi_channel_t;
+
+// status byte and up to two data bytes
+#define MIDI_MAX_MESSAGE_SIZE 3
+
+enum class MidiMessageType : uint8_t {
+  NoteOn,
+  NoteOff,
+  ChannelAfterTouch,
+  PolyAfterTouch,
+  ControlChange
+};
+
+struct MidiMessage {
+  MidiMessageType type;
+  uint8_t data1;
+  uint8_t data2;
+  midi_channel_t channel;
+  time_us_t timeUs = 0; // time of the event that caused the message, e.g. the sensing time of a hit
+};
+
+/**
+ * Status byte of a channel message. The channel is 1-based as in the MIDI library.
+ */
+inline uint8_t toMidiStatus(MidiMessageType type, midi_channel_t channel) {
+  uint8_t statusType;
+  switch (type) {
+  case MidiMessageType::NoteOn:
+    statusType = 0x90;
+    break;
+  case MidiMessageType::NoteOff:
+    statusType = 0x80;
+    break;
+  case MidiMessageType::ChannelAfterTouch:
+    statusType = 0xD0;
+    break;
+  case MidiMessageType::PolyAfterTouch:
+    statusType = 0xA0;
+    break;
+  default:
+    statusType = 0xB0;
+    break;
+  }
+  return statusType | ((channel - 1) & 0x0F);
+}
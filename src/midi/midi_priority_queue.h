@@ -0,0 +1,203 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "midi_message.h"
+
+// max. number of queued messages of all priority classes
+#define MIDI_PRIORITY_QUEUE_SIZE 64
+
+enum class MidiPriorityClass : uint8_t {
+  NoteOn,
+  Choke, // aftertouch
+  NoteOff,
+  ControlChange
+};
+
+#define MIDI_PRIORITY_CLASS_COUNT 4
+
+/**
+ * Output queue in front of a transport that cannot send all messages at once.
+ *
+ * If the transport cannot take all queued messages, they are sent by priority (NoteOn > choke > NoteOff > CC),
+ * in order of arrival within a priority class. Otherwise they are sent in order of arrival, so e.g. the hi-hat
+ * pedal position is sent before the NoteOn that depends on it.
+ * A CC replaces a queued CC of the same controller, so that a note never waits behind outdated pedal positions.
+ * A CC that was queued before a NoteOn is kept, as it is the pedal position of the hit.
+ * If a note is started again, its queued choke and NoteOff messages get the priority of the NoteOn,
+ * so the reordering never stops a new note.
+ *
+ * Messages that end a note (NoteOff and choke) are never dropped, as this would leave a stuck note:
+ * if the queue is full, the oldest CC or NoteOn is dropped to make room for them. NoteOns and CCs
+ * are dropped if the queue is full.
+ */
+class MidiPriorityQueue {
+public:
+  /**
+   * @return false if the message was not queued. A message that ends a note is only rejected if the queue
+   *   is full of such messages. Then there is no queued NoteOn it could overtake, so it can be sent directly.
+   */
+  bool push(const MidiMessage& message) {
+    MidiPriorityClass priorityClass = getPriorityClass(message.type);
+    if (priorityClass == MidiPriorityClass::ControlChange && coalesceControlChange(message)) {
+      return true;
+    }
+    if (message.type == MidiMessageType::NoteOn) {
+      promoteEndOfNote(message);
+    }
+
+    if (size == MIDI_PRIORITY_QUEUE_SIZE) {
+      if (!endsNote(message.type)) {
+        ++droppedCount;
+        return false;
+      }
+      if (!removeOldest(MidiPriorityClass::ControlChange) && !removeOldest(MidiPriorityClass::NoteOn)) {
+        return false;
+      }
+      ++droppedCount;
+    }
+
+    entries[size++] = {message, priorityClass};
+    if (size > maxSize) {
+      maxSize = size;
+    }
+    return true;
+  }
+
+  /**
+   * Removes the next message whose event (MidiMessage::timeUs) is at least minAgeUs before nowUs.
+   * @param byPriority the due message with the highest priority, otherwise the oldest due message
+   * @return false if no message is due
+   */
+  bool pop(MidiMessage& message, bool byPriority = true, time_us_t nowUs = 0, uint32_t minAgeUs = 0) {
+    const int index = findNext(byPriority, nowUs, minAgeUs);
+    if (index < 0) {
+      return false;
+    }
+    message = entries[index].message;
+    removeAt(index);
+    return true;
+  }
+
+  uint8_t getDueCount(time_us_t nowUs, uint32_t minAgeUs) const {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < size; ++i) {
+      if (isDue(entries[i].message, nowUs, minAgeUs)) {
+        ++count;
+      }
+    }
+    return count;
+  }
+
+  void clear() {
+    size = 0;
+  }
+
+  bool isEmpty() const { return size == 0; }
+  uint8_t getSize() const { return size; }
+  uint8_t getMaxSize() const { return maxSize; }
+  uint32_t getDroppedCount() const { return droppedCount; }
+  uint32_t getCoalescedCount() const { return coalescedCount; }
+
+  static MidiPriorityClass getPriorityClass(MidiMessageType type) {
+    switch (type) {
+    case MidiMessageType::NoteOn:
+      return MidiPriorityClass::NoteOn;
+    case MidiMessageType::ChannelAfterTouch:
+    case MidiMessageType::PolyAfterTouch:
+      return MidiPriorityClass::Choke;
+    case MidiMessageType::NoteOff:
+      return MidiPriorityClass::NoteOff;
+    default:
+      return MidiPriorityClass::ControlChange;
+    }
+  }
+
+  static bool endsNote(MidiMessageType type) {
+    const MidiPriorityClass priorityClass = getPriorityClass(type);
+    return priorityClass == MidiPriorityClass::Choke || priorityClass == MidiPriorityClass::NoteOff;
+  }
+
+private:
+  // the entries are kept in order of arrival, a message that was sent is removed from the middle
+  struct Entry {
+    MidiMessage message;
+    MidiPriorityClass priorityClass; // NoteOn for the end of a note that is started again
+  };
+
+  static bool isDue(const MidiMessage& message, time_us_t nowUs, uint32_t minAgeUs) {
+    return minAgeUs == 0 || nowUs - message.timeUs >= minAgeUs;
+  }
+
+  // index of the next due message, -1 if no message is due
+  int findNext(bool byPriority, time_us_t nowUs, uint32_t minAgeUs) const {
+    int nextIndex = -1;
+    for (uint8_t i = 0; i < size; ++i) {
+      if (!isDue(entries[i].message, nowUs, minAgeUs)) {
+        continue;
+      }
+      if (!byPriority) {
+        return i;
+      }
+      if (nextIndex < 0 || entries[i].priorityClass < entries[nextIndex].priorityClass) {
+        nextIndex = i;
+      }
+    }
+    return nextIndex;
+  }
+
+  void removeAt(uint8_t index) {
+    for (uint8_t i = index + 1; i < size; ++i) {
+      entries[i - 1] = entries[i];
+    }
+    --size;
+  }
+
+  // removes the oldest message of the class that does not end a note
+  bool removeOldest(MidiPriorityClass priorityClass) {
+    for (uint8_t i = 0; i < size; ++i) {
+      if (entries[i].priorityClass == priorityClass && !endsNote(entries[i].message.type)) {
+        removeAt(i);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool coalesceControlChange(const MidiMessage& message) {
+    for (int i = size - 1; i >= 0; --i) {
+      MidiMessage& queuedMessage = entries[i].message;
+      if (queuedMessage.type == MidiMessageType::NoteOn) {
+        return false;
+      }
+      // other message types without a priority of their own are in the class of the CCs as well
+      if (queuedMessage.type == message.type && queuedMessage.data1 == message.data1
+          && queuedMessage.channel == message.channel) {
+        queuedMessage.data2 = message.data2;
+        queuedMessage.timeUs = message.timeUs;
+        ++coalescedCount;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // gives the queued messages that end the note of noteOn the priority of the NoteOn
+  void promoteEndOfNote(const MidiMessage& noteOn) {
+    for (uint8_t i = 0; i < size; ++i) {
+      const MidiMessage& message = entries[i].message;
+      if (endsNote(message.type) && message.type != MidiMessageType::ChannelAfterTouch
+          && message.data1 == noteOn.data1 && message.channel == noteOn.channel) {
+        entries[i].priorityClass = MidiPriorityClass::NoteOn;
+      }
+    }
+  }
+
+private:
+  Entry entries[MIDI_PRIORITY_QUEUE_SIZE];
+  uint8_t size = 0;
+  uint8_t maxSize = 0;
+  uint32_t droppedCount = 0;
+  uint32_t coalescedCount = 0;
+};
@@ -7,6 +7,9 @@
 #include <vector>
 #include "util.h"
 #include "log.h"
+#include "midi_message.h"
+#include "midi_priority_queue.h"
+#include "loop_profiler.h"
 
 enum class MidiOutputMode {
   UsbDevice,
@@ -48,8 +51,6 @@ inline MidiOutputMode parseMidiOutputMode(String value) {
   return UsbDevice;
 }
 
-typedef uint8_t midi_channel_t;
-
 class MidiTransport {
 public:
   virtual void start(MidiOutputMode mode) = 0;
@@ -58,6 +59,21 @@ public:
 
   virtual void update() {}
 
+  /**
+   * Sends messages that were buffered by the transport. Called after the messages of a sensing iteration were sent.
+   */
+  virtual void flush() {}
+
+  /**
+   * Number of bytes that can be sent without blocking. Transports that do not know it never block the output.
+   */
+  virtual size_t getWriteCapacity() { return SIZE_MAX; }
+
+  /**
+   * Number of messages the transport dropped after they left the output queue.
+   */
+  virtual uint32_t getDroppedCount() const { return 0; }
+
   virtual void sendNoteOn(uint8_t inNoteNumber, uint8_t inVelocity, midi_channel_t inChannel) = 0;
 
   virtual void sendNoteOff(uint8_t inNoteNumber, uint8_t inVelocity, midi_channel_t inChannel) = 0;
@@ -67,6 +83,30 @@ public:
   virtual void sendAfterTouch(uint8_t inNoteNumber, uint8_t inPressure, midi_channel_t inChannel) = 0;
 
   virtual void sendControlChange(uint8_t inControlNumber, uint8_t inControlValue, midi_channel_t inChannel) = 0;
+
+  /**
+   * Sends a message with the time of its event (MidiMessage::timeUs). Transports that can use the time
+   * override this, the others send the message immediately.
+   */
+  virtual void sendMessage(const MidiMessage& message) {
+    switch (message.type) {
+    case MidiMessageType::NoteOn:
+      sendNoteOn(message.data1, message.data2, message.channel);
+      break;
+    case MidiMessageType::NoteOff:
+      sendNoteOff(message.data1, message.data2, message.channel);
+      break;
+    case MidiMessageType::ChannelAfterTouch:
+      sendAfterTouch(message.data1, message.channel);
+      break;
+    case MidiMessageType::PolyAfterTouch:
+      sendAfterTouch(message.data1, message.data2, message.channel);
+      break;
+    case MidiMessageType::ControlChange:
+      sendControlChange(message.data1, message.data2, message.channel);
+      break;
+    }
+  }
 };
 
 struct MidiTransportInstances {
@@ -81,25 +121,105 @@ struct MidiTransportInstances {
   MidiTransport* gamepad = nullptr;
 };
 
+// the selected output and the fan-out outputs
+#define MAX_MIDI_OUTPUT_COUNT 3
+
+#define MAX_MIDI_CONSTANT_LATENCY_US 20000
+
+/**
+ * Sends the messages to the selected transport and to the fan-out transports, e.g. USB for recording
+ * and DIN for a hardware sound module at the same time.
+ *
+ * Every output has its own queue (see MidiPriorityQueue). The messages are sent on flush() and update()
+ * as long as the transport can take them without blocking, so a stalled transport does not delay the others.
+ *
+ * In the constant latency mode the messages are held back until a fixed time after their event, so the
+ * latency of a hit does not depend on the position of the pad in the scan order or the load of the loop.
+ */
 class MidiTransportMultiplexer : public MidiTransport {
 public:
   MidiTransportMultiplexer(MidiTransportInstances& instances)
-    : instances(instances),
-      selectedMode(MidiOutputMode::UsbDevice),
-      selectedTransport(instances.usbDevice) {}
+    : instances(instances) {
+    outputs[0].mode = MidiOutputMode::UsbDevice;
+    outputs[0].transport = instances.usbDevice;
+  }
 
   void setOutputMode(MidiOutputMode mode) {
-    if (mode == selectedMode) {
+    if (mode == outputs[0].mode) {
       return;
     }
 
+    // a transport must not be started twice and only one BLE role can run at a time
+    std::vector<MidiOutputMode> fanOutModes = getFanOutModes();
+    std::erase_if(fanOutModes, [mode](MidiOutputMode fanOutMode) {
+      return fanOutMode == mode || (isBleMode(fanOutMode) && isBleMode(mode));
+    });
+    setFanOutModes(fanOutModes);
+
     MidiTransport* newMidiTransport = getTransportInstance(mode);
     if (initialized) {
-      selectedTransport->stop();      
+      outputs[0].transport->stop();      
       newMidiTransport->start(mode);
     }
-    selectedMode = mode;
-    selectedTransport = newMidiTransport;
+    outputs[0].mode = mode;
+    outputs[0].transport = newMidiTransport;
+    outputs[0].queue.clear();
+  }
+
+  /**
+   * Sets the modes that get all messages in addition to the selected output mode.
+   * Modes that are not supported as fan-out (see getSupportedFanOutModes()) or exceed MAX_MIDI_OUTPUT_COUNT are ignored.
+   * Only one BLE role (client or server) can run at a time as they share the Bluetooth stack.
+   */
+  void setFanOutModes(const std::vector<MidiOutputMode>& modes) {
+    MidiOutputMode newModes[MAX_MIDI_OUTPUT_COUNT - 1];
+    uint8_t newModeCount = 0;
+    for (MidiOutputMode mode : modes) {
+      if (mode == outputs[0].mode || !getTransportInstance(mode) || !isFanOutSupported(mode)
+          || containsMode(newModes, newModeCount, mode)) {
+        continue;
+      }
+      if (isBleMode(mode) && (isBleMode(outputs[0].mode) || containsBleMode(newModes, newModeCount))) {
+        logWarn("Only one BLE MIDI output can be active, ignoring %s\n", midiOutputModeToString(mode).c_str());
+        continue;
+      }
+      if (newModeCount == MAX_MIDI_OUTPUT_COUNT - 1) {
+        logWarn("Too many MIDI fan-out outputs, ignoring %s\n", midiOutputModeToString(mode).c_str());
+        break;
+      }
+      newModes[newModeCount++] = mode;
+    }
+
+    if (initialized) {
+      for (uint8_t i = 1; i < outputCount; ++i) {
+        if (!containsMode(newModes, newModeCount, outputs[i].mode)) {
+          outputs[i].transport->stop();
+        }
+      }
+      for (uint8_t i = 0; i < newModeCount; ++i) {
+        if (!isFanOutMode(newModes[i])) {
+          getTransportInstance(newModes[i])->start(newModes[i]);
+        }
+      }
+    }
+
+    for (uint8_t i = 0; i < newModeCount; ++i) {
+      MidiOutput& output = outputs[i + 1];
+      if (i + 1 >= outputCount || output.mode != newModes[i]) {
+        output.mode = newModes[i];
+        output.transport = getTransportInstance(newModes[i]);
+        output.queue.clear();
+      }
+    }
+    outputCount = newModeCount + 1;
+  }
+
+  std::vector<MidiOutputMode> getFanOutModes() const {
+    std::vector<MidiOutputMode> modes;
+    for (uint8_t i = 1; i < outputCount; ++i) {
+      modes.push_back(outputs[i].mode);
+    }
+    return modes;
   }
   
   std::vector<MidiOutputMode> getSupportedOutputModes() const {
@@ -134,9 +254,20 @@ public:
     return supportedModes;
   }
 
+  std::vector<MidiOutputMode> getSupportedFanOutModes() const {
+    std::vector<MidiOutputMode> supportedModes = getSupportedOutputModes();
+    const bool isBleSelected = isBleMode(outputs[0].mode);
+    std::erase_if(supportedModes, [isBleSelected](MidiOutputMode mode) {
+      return !isFanOutSupported(mode) || (isBleSelected && isBleMode(mode));
+    });
+    return supportedModes;
+  }
+
   void start() {
     initialized = true;
-    selectedTransport->start(selectedMode);
+    for (uint8_t i = 0; i < outputCount; ++i) {
+      outputs[i].transport->start(outputs[i].mode);
+    }
   }
 
   void start(MidiOutputMode mode) override {
@@ -149,34 +280,159 @@ public:
 
   void stop() override {
     initialized = false;
-    selectedTransport->stop();
+    for (uint8_t i = 0; i < outputCount; ++i) {
+      outputs[i].queue.clear();
+      outputs[i].transport->stop();
+    }
   }
 
   virtual void update() {
-    selectedTransport->update();
+    for (uint8_t i = 0; i < outputCount; ++i) {
+      sendQueuedMessages(outputs[i]); // messages that did not fit on the last flush
+      outputs[i].transport->update();
+    }
+  }
+
+  void flush() override {
+    for (uint8_t i = 0; i < outputCount; ++i) {
+      sendQueuedMessages(outputs[i]);
+      outputs[i].transport->flush();
+    }
   }
 
   virtual void sendNoteOn(uint8_t inNoteNumber, uint8_t inVelocity, midi_channel_t inChannel) {
-    selectedTransport->sendNoteOn(inNoteNumber, inVelocity, inChannel);
+    queueMessage({MidiMessageType::NoteOn, inNoteNumber, inVelocity, inChannel, micros()});
   }
 
   virtual void sendNoteOff(uint8_t inNoteNumber, uint8_t inVelocity, midi_channel_t inChannel) {
-    selectedTransport->sendNoteOff(inNoteNumber, inVelocity, inChannel);
+    queueMessage({MidiMessageType::NoteOff, inNoteNumber, inVelocity, inChannel, micros()});
   }
 
   virtual void sendAfterTouch(uint8_t inPressure, midi_channel_t inChannel) {
-    selectedTransport->sendAfterTouch(inPressure, inChannel);
+    queueMessage({MidiMessageType::ChannelAfterTouch, inPressure, 0, inChannel, micros()});
   }
 
   virtual void sendAfterTouch(uint8_t inNoteNumber, uint8_t inPressure, midi_channel_t inChannel) {
-    selectedTransport->sendAfterTouch(inNoteNumber, inPressure, inChannel);
+    queueMessage({MidiMessageType::PolyAfterTouch, inNoteNumber, inPressure, inChannel, micros()});
   }
 
   virtual void sendControlChange(uint8_t inControlNumber, uint8_t inControlValue, midi_channel_t inChannel) {
-    selectedTransport->sendControlChange(inControlNumber, inControlValue, inChannel);
+    queueMessage({MidiMessageType::ControlChange, inControlNumber, inControlValue, inChannel, micros()});
+  }
+
+  void sendMessage(const MidiMessage& message) override {
+    queueMessage(message);
+  }
+
+  uint32_t getConstantLatency() const { return constantLatencyUs; }
+
+  /**
+   * Delays every message to the time of its event + latencyUs. The latency must be higher than the
+   * scan time of the pads, otherwise the hits are sent as soon as possible. 0 disables the mode.
+   */
+  void setConstantLatency(uint32_t latencyUs) {
+    constantLatencyUs = min(latencyUs, (uint32_t) MAX_MIDI_CONSTANT_LATENCY_US);
+  }
+
+  /**
+   * Time from the hit to the NoteOn being passed to the selected transport. The spread between min. and max.
+   * is the jitter that the constant latency mode removes.
+   */
+  const CostHistogram& getHitLatency() const { return hitLatency; }
+  void resetHitLatency() { hitLatency.reset(); }
+
+  // output 0 is the selected output mode, the others are the fan-out outputs
+  uint8_t getOutputCount() const { return outputCount; }
+  MidiOutputMode getOutputMode(uint8_t index) const { return outputs[index].mode; }
+  const MidiPriorityQueue& getOutputQueue(uint8_t index) const { return outputs[index].queue; }
+  uint32_t getOutputDroppedCount(uint8_t index) const { return outputs[index].transport->getDroppedCount(); }
+
+  /**
+   * Only MIDI transports can run next to another transport, the game controller modes change the USB device or
+   * have a fixed mapping.
+   */
+  static bool isFanOutSupported(MidiOutputMode mode) {
+    switch (mode) {
+    case MidiOutputMode::UsbDevice:
+    case MidiOutputMode::UsbHost:
+    case MidiOutputMode::SerialDin:
+    case MidiOutputMode::BleClient:
+    case MidiOutputMode::BleServer:
+      return true;
+    default:
+      return false;
+    }
   }
 
 private:
+  struct MidiOutput {
+    MidiOutputMode mode;
+    MidiTransport* transport;
+    MidiPriorityQueue queue;
+  };
+
+  // the BLE client and server use the same Bluetooth stack with different GATT profiles
+  static bool isBleMode(MidiOutputMode mode) {
+    return mode == MidiOutputMode::BleClient || mode == MidiOutputMode::BleServer;
+  }
+
+  static bool containsBleMode(const MidiOutputMode* modes, uint8_t count) {
+    for (uint8_t i = 0; i < count; ++i) {
+      if (isBleMode(modes[i])) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  static bool containsMode(const MidiOutputMode* modes, uint8_t count, MidiOutputMode mode) {
+    for (uint8_t i = 0; i < count; ++i) {
+      if (modes[i] == mode) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool isFanOutMode(MidiOutputMode mode) const {
+    for (uint8_t i = 1; i < outputCount; ++i) {
+      if (outputs[i].mode == mode) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void queueMessage(const MidiMessage& message) {
+    for (uint8_t i = 0; i < outputCount; ++i) {
+      if (!outputs[i].queue.push(message) && MidiPriorityQueue::endsNote(message.type)) {
+        outputs[i].transport->sendMessage(message); // a stuck note is worse than a blocked transport
+      }
+    }
+  }
+
+  void sendQueuedMessages(MidiOutput& output) {
+    if (output.queue.isEmpty()) {
+      return;
+    }
+
+    // in the constant latency mode every message is released on its own due time, in order of arrival
+    const time_us_t nowUs = micros();
+    MidiMessage message;
+    size_t capacity;
+    while ((capacity = output.transport->getWriteCapacity()) >= MIDI_MAX_MESSAGE_SIZE) {
+      // only reorder if the transport cannot take all due messages
+      const bool byPriority = capacity < output.queue.getDueCount(nowUs, constantLatencyUs) * MIDI_MAX_MESSAGE_SIZE;
+      if (!output.queue.pop(message, byPriority, nowUs, constantLatencyUs)) {
+        break;
+      }
+      if (message.type == MidiMessageType::NoteOn && &output == &outputs[0]) {
+        hitLatency.record((uint32_t) (nowUs - message.timeUs));
+      }
+      output.transport->sendMessage(message);
+    }
+  }
+
   MidiTransport* getTransportInstance(MidiOutputMode mode) {
     switch (mode) {
     case MidiOutputMode::UsbDevice:
@@ -204,9 +460,11 @@ private:
 
 private:
   MidiTransportInstances& instances;
-  MidiOutputMode selectedMode;
-  MidiTransport* selectedTransport;
+  MidiOutput outputs[MAX_MIDI_OUTPUT_COUNT];
+  uint8_t outputCount = 1;
   bool initialized = false;
+  uint32_t constantLatencyUs = 0;
+  CostHistogram hitLatency;
 };
 
 extern MidiTransportMultiplexer midiTransport;
@@ -0,0 +1,76 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "midi_transport.h"
+#include "midi_message.h"
+#include "spsc_queue.h"
+
+#define MIDI_QUEUE_SIZE 64
+
+/**
+ * Transport that queues all messages so that they can be sent by another core with forwardTo().
+ * Messages are dropped if the queue is full.
+ *
+ * Messages are stamped with the time they were queued unless the time of the hit is passed.
+ */
+class MidiTransport_Queue : public MidiTransport {
+public:
+  void start(MidiOutputMode) override {}
+
+  void sendNoteOn(uint8_t inNoteNumber, uint8_t inVelocity, midi_channel_t inChannel) override {
+    sendNoteOn(inNoteNumber, inVelocity, inChannel, micros());
+  }
+
+  void sendNoteOn(uint8_t inNoteNumber, uint8_t inVelocity, midi_channel_t inChannel, time_us_t hitTimeUs) {
+    queueMessage({MidiMessageType::NoteOn, inNoteNumber, inVelocity, inChannel, hitTimeUs});
+  }
+
+  void sendNoteOff(uint8_t inNoteNumber, uint8_t inVelocity, midi_channel_t inChannel) override {
+    sendNoteOff(inNoteNumber, inVelocity, inChannel, micros());
+  }
+
+  void sendNoteOff(uint8_t inNoteNumber, uint8_t inVelocity, midi_channel_t inChannel, time_us_t hitTimeUs) {
+    queueMessage({MidiMessageType::NoteOff, inNoteNumber, inVelocity, inChannel, hitTimeUs});
+  }
+
+  void sendAfterTouch(uint8_t inPressure, midi_channel_t inChannel) override {
+    queueMessage({MidiMessageType::ChannelAfterTouch, inPressure, 0, inChannel, micros()});
+  }
+
+  void sendAfterTouch(uint8_t inNoteNumber, uint8_t inPressure, midi_channel_t inChannel) override {
+    queueMessage({MidiMessageType::PolyAfterTouch, inNoteNumber, inPressure, inChannel, micros()});
+  }
+
+  void sendControlChange(uint8_t inControlNumber, uint8_t inControlValue, midi_channel_t inChannel) override {
+    queueMessage({MidiMessageType::ControlChange, inControlNumber, inControlValue, inChannel, micros()});
+  }
+
+  void sendMessage(const MidiMessage& message) override {
+    queueMessage(message);
+  }
+
+  /**
+   * Sends all queued messages to the given transport. Must only be called by the consumer core.
+   */
+  void forwardTo(MidiTransport& transport) {
+    MidiMessage message;
+    while (queue.pop(message)) {
+      transport.sendMessage(message);
+    }
+  }
+
+  uint32_t getDroppedCount() const override { return droppedCount; }
+
+private:
+  void queueMessage(const MidiMessage& message) {
+    if (!queue.push(message)) {
+      ++droppedCount;
+    }
+  }
+
+private:
+  SpscQueue<MidiMessage, MIDI_QUEUE_SIZE> queue;
+  uint32_t droppedCount = 0;
+};
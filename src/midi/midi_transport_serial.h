@@ -4,18 +4,23 @@
 #pragma once
 
 #include "drum_io.h"
-#include "midi_transport_arduino_midi.h"
-#include "serialMIDI.h"
+#include "midi_transport.h"
+#include "din_midi_encoder.h"
 
+#define MIDI_DIN_BAUD_RATE 31250
+
+/**
+ * Sends the messages to the serial DIN port. The messages are collected until flush() is called
+ * and then encoded as a batch, see DinMidiEncoder.
+ */
 template<typename SerialType>
-class MidiTransport_Serial : public MidiTransport_ArduinoMidi {
+class MidiTransport_Serial : public MidiTransport {
 public:
   MidiTransport_Serial(SerialType& serial, bool isSerialPortUsedForLogging = false)
-    : MidiTransport_ArduinoMidi(),
-      serial(serial),
+    : serial(serial),
       isSerialPortUsedForLogging(isSerialPortUsedForLogging) {}
 
-  void begin() override {
+  void start(MidiOutputMode mode) override {
     DrumIO::led(LedId::MidiConnected, true);
 
     pin_size_t txPin = DrumIO::getMidiTxPin(serial);
@@ -35,10 +40,11 @@ public:
     if (txPin != PIN_UNUSED) {
       serial.setTX(txPin);
     }    
-    serial.begin(settings.BaudRate);
+    serial.begin(MIDI_DIN_BAUD_RATE);
   }
 
   void stop() override {
+    flush();
     DrumIO::led(LedId::MidiConnected, false);
 
 #ifdef ENABLE_SERIAL_DEBUG
@@ -53,12 +59,60 @@ public:
     serial.end();
   }
 
-  size_t write(uint8_t b) override {
-    return serial.write(b);
+  void flush() override {
+    if (encoder.isEmpty()) {
+      return;
+    }
+    uint8_t buffer[DinMidiEncoder::getMaxBatchSize()];
+    const size_t size = encoder.encodeBatch(buffer);
+    serial.write(buffer, size);
+  }
+
+  size_t getWriteCapacity() override {
+    // the batch is written on the next flush
+    const size_t available = serial.availableForWrite();
+    const size_t pending = encoder.getMaxEncodedSize();
+    return (available > pending) ? available - pending : 0;
+  }
+
+  uint32_t getDroppedCount() const override {
+    return encoder.getDroppedCount();
+  }
+
+  void sendNoteOn(uint8_t inNoteNumber, uint8_t inVelocity, midi_channel_t inChannel) override {
+    flushIfFull();
+    encoder.addNoteOn(inNoteNumber, inVelocity, inChannel);
+  }
+
+  void sendNoteOff(uint8_t inNoteNumber, uint8_t inVelocity, midi_channel_t inChannel) override {
+    flushIfFull();
+    encoder.addNoteOff(inNoteNumber, inVelocity, inChannel);
+  }
+
+  void sendAfterTouch(uint8_t inPressure, midi_channel_t inChannel) override {
+    flushIfFull();
+    encoder.addChannelAfterTouch(inPressure, inChannel);
+  }
+
+  void sendAfterTouch(uint8_t inNoteNumber, uint8_t inPressure, midi_channel_t inChannel) override {
+    flushIfFull();
+    encoder.addPolyAfterTouch(inNoteNumber, inPressure, inChannel);
+  }
+
+  void sendControlChange(uint8_t inControlNumber, uint8_t inControlValue, midi_channel_t inChannel) override {
+    flushIfFull();
+    encoder.addControlChange(inControlNumber, inControlValue, inChannel);
+  }
+
+private:
+  void flushIfFull() {
+    if (encoder.isFull()) {
+      flush();
+    }
   }
 
 private:
   SerialType& serial;
   bool isSerialPortUsedForLogging; // set to true if the serial port is shared with logging to disable logging and avoid conflicts
-  MIDI_NAMESPACE::DefaultSerialSettings settings;
+  DinMidiEncoder encoder;
 };
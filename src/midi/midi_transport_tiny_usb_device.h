@@ -12,12 +12,22 @@
 
 #ifdef ENABLE_MIDI_USB_DEVICE
 
-#include "midi_transport_arduino_midi.h"
+#include "midi_transport.h"
+#include "usb_midi_packet.h"
 #include "drum_io.h"
 
-class MidiTransport_UsbDevice : public MidiTransport_ArduinoMidi {
+/**
+ * Sends the messages as USB-MIDI event packets. The packets are collected until flush() is called
+ * after the messages of a sensing iteration were forwarded, so that all notes of a chord are
+ * written to the endpoint in a single burst.
+ *
+ * tud_midi_packet_write() starts a transfer with the first packet if the endpoint is idle, so the other
+ * packets had to wait for the next transfer. tud_midi_packet_write_n() writes all packets that fit into
+ * the FIFO before it starts the transfer.
+ */
+class MidiTransport_UsbDevice : public MidiTransport {
 public:
-  void begin() override {
+  void start(MidiOutputMode mode) override {
     DrumIO::led(LedId::MidiConnected, true);
   }
 
@@ -25,9 +35,58 @@ public:
     DrumIO::led(LedId::MidiConnected, false);
   }
 
-  size_t write(uint8_t b) override {
-    return tud_midi_stream_write(0, &b, 1);
+  void update() override {
+    flush(); // packets that did not fit into the FIFO on the last flush
   }
+
+  void flush() override {
+    if (packetBuffer.isEmpty()) {
+      return;
+    }
+    const uint32_t writtenSize = tud_midi_packet_write_n(packetBuffer.getPacket(0),
+        packetBuffer.getPacketCount() * USB_MIDI_PACKET_SIZE);
+    // only complete packets are written, the rest did not fit into the FIFO, retry on next update
+    packetBuffer.removePackets(writtenSize / USB_MIDI_PACKET_SIZE);
+  }
+
+  uint32_t getDroppedCount() const override {
+    return packetBuffer.getDroppedCount();
+  }
+
+  void sendNoteOn(uint8_t inNoteNumber, uint8_t inVelocity, midi_channel_t inChannel) override {
+    flushIfFull();
+    packetBuffer.addNoteOn(inNoteNumber, inVelocity, inChannel);
+  }
+
+  void sendNoteOff(uint8_t inNoteNumber, uint8_t inVelocity, midi_channel_t inChannel) override {
+    flushIfFull();
+    packetBuffer.addNoteOff(inNoteNumber, inVelocity, inChannel);
+  }
+
+  void sendAfterTouch(uint8_t inPressure, midi_channel_t inChannel) override {
+    flushIfFull();
+    packetBuffer.addChannelAfterTouch(inPressure, inChannel);
+  }
+
+  void sendAfterTouch(uint8_t inNoteNumber, uint8_t inPressure, midi_channel_t inChannel) override {
+    flushIfFull();
+    packetBuffer.addPolyAfterTouch(inNoteNumber, inPressure, inChannel);
+  }
+
+  void sendControlChange(uint8_t inControlNumber, uint8_t inControlValue, midi_channel_t inChannel) override {
+    flushIfFull();
+    packetBuffer.addControlChange(inControlNumber, inControlValue, inChannel);
+  }
+
+private:
+  void flushIfFull() {
+    if (packetBuffer.isFull()) {
+      flush();
+    }
+  }
+
+private:
+  UsbMidiPacketBuffer packetBuffer;
 };
 
 #endif
@@ -0,0 +1,89 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "midi_transport.h"
+
+#include <string.h>
+
+#define USB_MIDI_PACKET_SIZE 4
+
+// enough for the NoteOn/NoteOff pairs of all pads that are hit in a sensing iteration
+#define USB_MIDI_PACKET_BUFFER_SIZE 32
+
+/**
+ * Encodes channel messages as 4-byte USB-MIDI event packets (USB MIDI 1.0 spec, chapter 4):
+ * the cable number and the code index number (CIN), followed by the 3 bytes of the MIDI message.
+ * For channel messages the CIN is the high nibble of the status byte.
+ * Messages with only one data byte (channel aftertouch) are padded with 0.
+ */
+inline void encodeUsbMidiPacket(uint8_t* packet, uint8_t status, uint8_t data1, uint8_t data2, uint8_t cable = 0) {
+  packet[0] = (cable << 4) | (status >> 4);
+  packet[1] = status;
+  packet[2] = data1 & 0x7F;
+  packet[3] = data2 & 0x7F;
+}
+
+/**
+ * Collects the USB-MIDI event packets of several messages, so that they can be written in a single burst.
+ * The packets are built directly from the messages without the byte stream parser of the MIDI library.
+ * Messages are dropped if the buffer is full.
+ */
+class UsbMidiPacketBuffer {
+public:
+  void addNoteOn(uint8_t note, uint8_t velocity, midi_channel_t channel) {
+    addPacket(MidiMessageType::NoteOn, note, velocity, channel);
+  }
+
+  void addNoteOff(uint8_t note, uint8_t velocity, midi_channel_t channel) {
+    addPacket(MidiMessageType::NoteOff, note, velocity, channel);
+  }
+
+  void addPolyAfterTouch(uint8_t note, uint8_t pressure, midi_channel_t channel) {
+    addPacket(MidiMessageType::PolyAfterTouch, note, pressure, channel);
+  }
+
+  void addControlChange(uint8_t controlNumber, uint8_t controlValue, midi_channel_t channel) {
+    addPacket(MidiMessageType::ControlChange, controlNumber, controlValue, channel);
+  }
+
+  void addChannelAfterTouch(uint8_t pressure, midi_channel_t channel) {
+    addPacket(MidiMessageType::ChannelAfterTouch, pressure, 0, channel);
+  }
+
+  // the packets are stored back to back, so all of them can be written from getPacket(0)
+  const uint8_t* getPacket(uint8_t index) const { return packets[index]; }
+  uint8_t getPacketCount() const { return packetCount; }
+  bool isEmpty() const { return packetCount == 0; }
+  bool isFull() const { return packetCount == USB_MIDI_PACKET_BUFFER_SIZE; }
+
+  /**
+   * Removes the first count packets, e.g. after they were written.
+   */
+  void removePackets(uint8_t count) {
+    if (count >= packetCount) {
+      packetCount = 0;
+      return;
+    }
+    memmove(packets[0], packets[count], (packetCount - count) * USB_MIDI_PACKET_SIZE);
+    packetCount -= count;
+  }
+
+  uint32_t getDroppedCount() const { return droppedCount; }
+
+private:
+  void addPacket(MidiMessageType type, uint8_t data1, uint8_t data2, midi_channel_t channel) {
+    if (isFull()) {
+      ++droppedCount;
+      return;
+    }
+    encodeUsbMidiPacket(packets[packetCount], toMidiStatus(type, channel), data1, data2);
+    ++packetCount;
+  }
+
+private:
+  uint8_t packets[USB_MIDI_PACKET_BUFFER_SIZE][USB_MIDI_PACKET_SIZE];
+  uint8_t packetCount = 0;
+  uint32_t droppedCount = 0;
+};
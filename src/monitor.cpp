@@ -6,11 +6,22 @@
 #include "drum_kit.h"
 #include "log.h"
 #include "midi_transport.h"
+#include "spsc_queue.h"
 #include "webui.h"
 #include "drum/sensing/latency.h"
 
 #define HISTORY_MIN_WRITE_INTERVAL_US 200
 
+#define MONITOR_QUEUE_SIZE 4
+
+struct QueuedMonitorMessage {
+  size_t size;
+  MonitorMessage message;
+};
+
+// messages are sent by the main core as the web server must not be accessed by the sensing core
+static SpscQueue<QueuedMonitorMessage, MONITOR_QUEUE_SIZE> messageQueue;
+
 bool DrumMonitor::checkAndSendMonitoredPadHitInfo() {
   DrumPad* monitoredPad = getMonitoredPad();
   if (!monitoredPad) {
@@ -186,6 +197,9 @@ MonitorHitInfo DrumMonitor::prepareDrumHitInfo(const DrumPad& pad) {
   hitInfo.maskTimeMs = settings.maskTimeMs;
   hitInfo.decayTimeMs = settings.decayTimeMs;
 
+  const time_us_t scanTimeUs = pad.scanTimeEndUs - pad.hitTimeUs;
+  hitInfo.scanTimeSavedUs = (scanTimeUs < settings.scanTimeUs) ? settings.scanTimeUs - scanTimeUs : 0;
+
   for (int i = 0; i < pad.getActiveZoneCount(); ++i) {
     hitInfo.hits[i] = pad.hits[i];
     hitInfo.velocities[i] = pad.hitVelocities[i];
@@ -223,28 +237,40 @@ MonitorHitInfo DrumMonitor::preparePedalHitInfo(const DrumPad& pedal) {
   // chick detection
   hitInfo.hits[1] = pedal.hits[0];
   hitInfo.velocities[1] = pedal.hitVelocities[0];
-  hitInfo.zoneThresholdsMin[1] = settings.almostClosedThreshold;
-  hitInfo.zoneThresholdsMax[1] = settings.closedThreshold;
+  hitInfo.zoneThresholdsMin[1] = settings.almostClosedThreshold >> PERCENT_Q8_BITS; // in %
+  hitInfo.zoneThresholdsMax[1] = settings.closedThreshold >> PERCENT_Q8_BITS;
 
   return hitInfo;
 }
 
 void DrumMonitor::sendHitMessage(const MonitorHitInfo& hitInfo, bool includeHistoryData) {
+  QueuedMonitorMessage* queuedMessage = messageQueue.beginPush();
+  if (!queuedMessage) {
+    return; // UI is not fast enough, drop the message
+  }
+
+  MonitorMessage& msgBuffer = queuedMessage->message;
   memcpy(&msgBuffer.hitInfo, &hitInfo, sizeof(hitInfo));
 
-  size_t messageSize;
   if (includeHistoryData) {
     history.copyTo(msgBuffer.history);
     msgBuffer.hitInfo.triggerStartIndex = history.getRelativeTriggerStartPos();
     msgBuffer.hitInfo.triggerEndIndex = history.getRelativeTriggerEndPos();
-    messageSize = sizeof(msgBuffer);
+    queuedMessage->size = sizeof(msgBuffer);
   } else {
     msgBuffer.hitInfo.triggerStartIndex = -1;
     msgBuffer.hitInfo.triggerEndIndex = -1;
-    messageSize = sizeof(hitInfo);
+    queuedMessage->size = sizeof(hitInfo);
   }
 
-  webUI.sendBinaryToWebSocket((uint8_t*)&msgBuffer, messageSize);
+  messageQueue.commitPush();
+}
+
+void DrumMonitor::forwardQueuedMessages() {
+  while (const QueuedMonitorMessage* queuedMessage = messageQueue.peek()) {
+    webUI.sendBinaryToWebSocket((uint8_t*)&queuedMessage->message, queuedMessage->size);
+    messageQueue.pop();
+  }
 }
 
 void DrumMonitor::startLatencyTest(bool preview, sensor_value_t threshold, midi_note_t midiNote) {
@@ -38,6 +38,7 @@ struct MonitorHitInfo {
   uint8_t maskTimeMs;
   uint8_t decayTimeMs;
   uint32_t latencyUs;
+  uint16_t scanTimeSavedUs; // by early commit
   enum_uint8_t padType;
   enum_uint8_t zonesType;
   enum_uint8_t chokeType;
@@ -92,8 +93,16 @@ public:
     triggeredByAllPads = value;
   }
 
+  /**
+   * Queues the hit message. It will be sent to the UI by forwardQueuedMessages().
+   */
   void sendHitMessage(const MonitorHitInfo& monitorInfo, bool includeHistoryData);
 
+  /**
+   * Sends the queued hit messages to the UI. Must be called by the main core.
+   */
+  static void forwardQueuedMessages();
+
   void startLatencyTest(bool preview, sensor_value_t threshold, midi_note_t midiNote);
   
   void stopLatencyTest() {
@@ -133,8 +142,6 @@ private:
 
   time_us_t lastHistoryUpdateTimeUs = 0;
 
-  MonitorMessage msgBuffer;
-
   bool isTriggeredByUser = false;
 
   LatencyTestInfo latencyTest;
@@ -0,0 +1,73 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "sensing_core.h"
+
+#include "drum_kit.h"
+#include "event_log.h"
+#include "monitor.h"
+
+#include <atomic>
+
+MidiTransport_Queue midiOutputQueue;
+
+static std::atomic<bool> runningOnOwnCore = false;
+static std::atomic<bool> pauseRequested = false;
+static std::atomic<bool> paused = false;
+
+static uint8_t pauseDepth = 0; // only accessed by the main core
+
+void SensingCore::start() {
+  // set before the core is started, so that the main loop and the sensing core never update at the same time
+  runningOnOwnCore.store(true, std::memory_order_release);
+  if (startOwnCore()) {
+    eventLog.log(Level::Info, "Sensing runs on its own core");
+  } else {
+    runningOnOwnCore.store(false, std::memory_order_release);
+  }
+}
+
+bool SensingCore::isRunningOnOwnCore() {
+  return runningOnOwnCore.load(std::memory_order_acquire);
+}
+
+void SensingCore::update() {
+  if (pauseRequested.load(std::memory_order_acquire)) {
+    paused.store(true, std::memory_order_release);
+    while (pauseRequested.load(std::memory_order_acquire)) {
+      yield(); // wait for resume
+    }
+    paused.store(false, std::memory_order_release);
+  }
+
+  drumKit.updateDrums();
+}
+
+void SensingCore::forwardOutput() {
+  midiOutputQueue.forwardTo(midiTransport);
+  midiTransport.flush();
+  DrumMonitor::forwardQueuedMessages();
+  AdcTraceCapture::forwardQueuedChunks();
+}
+
+void SensingCore::pause() {
+  if (!isRunningOnOwnCore() || pauseDepth++ > 0) {
+    return;
+  }
+
+  pauseRequested.store(true, std::memory_order_release);
+  while (!paused.load(std::memory_order_acquire)) {
+    yield(); // wait until the current iteration is finished
+  }
+}
+
+void SensingCore::resume() {
+  if (!isRunningOnOwnCore() || pauseDepth == 0 || --pauseDepth > 0) {
+    return;
+  }
+
+  pauseRequested.store(false, std::memory_order_release);
+  while (paused.load(std::memory_order_acquire)) {
+    yield(); // wait until the sensing core has left the pause, otherwise the next pause() might return too early
+  }
+}
@@ -0,0 +1,67 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "midi_transport_queue.h"
+
+/**
+ * Runs the sensing (DrumKit::updateDrums()) on its own core, so that the scan loop is not blocked
+ * by the web UI, network or USB handling on the main core.
+ *
+ * MIDI and monitor messages are passed to the main core with lock-free queues and sent by forwardOutput().
+ * Code on the main core that accesses the drum kit must pause the sensing core first (see SensingPause).
+ * If the platform cannot run the sensing on its own core, the main loop has to call update() itself.
+ */
+class SensingCore {
+public:
+  SensingCore() = delete;
+
+public:
+  /**
+   * Starts sensing on its own core if supported. Must be called after the config was loaded.
+   */
+  static void start();
+
+  static bool isRunningOnOwnCore();
+
+  /**
+   * Performs a single sensing iteration. Called by the sensing core or by the main loop.
+   */
+  static void update();
+
+  /**
+   * Sends the queued MIDI and monitor messages. Must be called by the main loop.
+   */
+  static void forwardOutput();
+
+  /**
+   * Waits until the sensing core is paused at the end of an iteration.
+   * Calls can be nested, the sensing core continues after the last resume().
+   */
+  static void pause();
+
+  static void resume();
+
+private:
+  // platform specific, returns false if there is no core available for sensing
+  static bool startOwnCore();
+};
+
+/**
+ * Pauses the sensing core while in scope.
+ */
+class SensingPause {
+public:
+  SensingPause() { SensingCore::pause(); }
+  ~SensingPause() { SensingCore::resume(); }
+
+  // disable copies
+  SensingPause(const SensingPause&) = delete;
+  SensingPause& operator=(const SensingPause&) = delete;
+};
+
+/**
+ * MIDI output of the drum kit. Forwarded to midiTransport by the main core.
+ */
+extern MidiTransport_Queue midiOutputQueue;
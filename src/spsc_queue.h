@@ -0,0 +1,98 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * Lock-free ring buffer for exactly one producer and one consumer, e.g. running on different cores.
+ *
+ * Only atomic loads and stores of the indices are used, which are available on all supported MCUs (incl. Cortex-M0+).
+ * One item is kept free to distinguish a full from an empty queue, so at most Capacity - 1 items can be queued.
+ */
+template <typename T, uint32_t Capacity>
+class SpscQueue {
+  static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+
+public:
+  SpscQueue() = default;
+
+  // disable shallow copies
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+public: // producer
+  /**
+   * Returns the next free item that can be filled in-place or nullptr if the queue is full.
+   * The item will be visible to the consumer after commitPush().
+   */
+  T* beginPush() {
+    uint32_t writeIndex = writePos.load(std::memory_order_relaxed);
+    if (nextIndex(writeIndex) == readPos.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+    return &items[writeIndex];
+  }
+
+  void commitPush() {
+    uint32_t writeIndex = writePos.load(std::memory_order_relaxed);
+    writePos.store(nextIndex(writeIndex), std::memory_order_release);
+  }
+
+  // returns false if the queue is full
+  bool push(const T& item) {
+    T* slot = beginPush();
+    if (!slot) {
+      return false;
+    }
+    *slot = item;
+    commitPush();
+    return true;
+  }
+
+public: // consumer
+  /**
+   * Returns the oldest item or nullptr if the queue is empty.
+   * The item stays valid until pop() is called.
+   */
+  const T* peek() const {
+    uint32_t readIndex = readPos.load(std::memory_order_relaxed);
+    if (readIndex == writePos.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+    return &items[readIndex];
+  }
+
+  void pop() {
+    uint32_t readIndex = readPos.load(std::memory_order_relaxed);
+    readPos.store(nextIndex(readIndex), std::memory_order_release);
+  }
+
+  // returns false if the queue is empty
+  bool pop(T& item) {
+    const T* slot = peek();
+    if (!slot) {
+      return false;
+    }
+    item = *slot;
+    pop();
+    return true;
+  }
+
+  bool isEmpty() const {
+    return readPos.load(std::memory_order_acquire) == writePos.load(std::memory_order_acquire);
+  }
+
+private:
+  static uint32_t nextIndex(uint32_t index) {
+    return (index + 1) & (Capacity - 1);
+  }
+
+private:
+  std::atomic<uint32_t> writePos = 0;
+  std::atomic<uint32_t> readPos = 0;
+
+  T items[Capacity];
+};
@@ -7,8 +7,10 @@
 #include "drum_kit.h"
 #include "event_log.h"
 #include "log.h"
+#include "loop_profiler.h"
 #include "midi_transport.h"
 #include "monitor.h"
+#include "sensing_core.h"
 #include "version.h"
 #include "usb_host.h"
 #if HAS_BLUETOOTH
@@ -95,9 +97,15 @@ void WebUI::setAvailableMidiOutputModes(JsonObject& infoNode) {
   for (MidiOutputMode mode : midiTransport.getSupportedOutputModes()) {
     midiOutputsNode.add(midiOutputModeToString(mode));
   }
+
+  JsonArray midiFanOutsNode = infoNode["midiFanOutModes"].to<JsonArray>();
+  for (MidiOutputMode mode : midiTransport.getSupportedFanOutModes()) {
+    midiFanOutsNode.add(midiOutputModeToString(mode));
+  }
 }
 
 void WebUI::handleSetMonitor(JsonObjectConst configNode) {
+  SensingPause sensingPause;
   DrumMonitor& monitor = drumKit->getMonitor();
 
   if (!configNode[CONFIG_INFO_MONITOR_PAD].isUnbound()) {
@@ -114,6 +122,7 @@ void WebUI::handleSetMonitor(JsonObjectConst configNode) {
       monitor.setMonitoredPad(monitorPad);
       logDebug("Monitor: %s\n", monitorPad->getName().c_str());
     }
+    drumKit->rebuildScanPlan(); // the monitored pad is read even if it is disabled
   }
 
   if (configNode[CONFIG_INFO_MONITOR_TRIGGERED_BY_ALL_PADS].is<bool>()) {
@@ -123,6 +132,14 @@ void WebUI::handleSetMonitor(JsonObjectConst configNode) {
 }
 
 void WebUI::handleSetPadConfig(JsonObjectConst configNode, AsyncWebSocketClient* client) {
+  if (applyPadConfig(configNode)) {
+    sendConfig(client);
+  }
+}
+
+// returns true if the config has to be sent to the client
+bool WebUI::applyPadConfig(JsonObjectConst configNode) {
+  SensingPause sensingPause;
   bool sendConfigRequired = false;
 
   for (JsonPairConst pair : configNode) {
@@ -145,6 +162,8 @@ void WebUI::handleSetPadConfig(JsonObjectConst configNode, AsyncWebSocketClient*
         }
       }
       pad.setConnector(connector);
+      drumKit->rebuildScanPlan();
+      drumKit->rebuildSensingTable();
       isConfigDirty = true;
       sendConfigRequired = true;
     }
@@ -181,6 +200,8 @@ void WebUI::handleSetPadConfig(JsonObjectConst configNode, AsyncWebSocketClient*
     if (nodeValue[CONFIG_ENABLED_PROP].is<bool>()) {
       bool enabled = nodeValue[CONFIG_ENABLED_PROP];
       pad.setEnabled(enabled);
+      drumKit->rebuildScanPlan();
+      drumKit->rebuildSensingTable();
       isConfigDirty = true;
     }
 
@@ -191,12 +212,11 @@ void WebUI::handleSetPadConfig(JsonObjectConst configNode, AsyncWebSocketClient*
     }
   }
 
-  if (sendConfigRequired) {
-    sendConfig(client);
-  }
+  return sendConfigRequired;
 }
 
 void WebUI::handleSetSettingsRequest(AsyncWebSocketClient* client, JsonObjectConst settingsNode) {
+  SensingPause sensingPause;
   for (JsonPairConst keyValuePair : settingsNode) {
     pad_size_t padIndex = atoi(keyValuePair.key().c_str());
     DrumPad* pad = drumKit->getPad(padIndex);
@@ -207,6 +227,9 @@ void WebUI::handleSetSettingsRequest(AsyncWebSocketClient* client, JsonObjectCon
     DrumConfigMapper::applyPadSettings(*pad, keyValuePair.value());
     isConfigDirty = true;
   }
+  // thresholds, zones or pad type might have changed
+  drumKit->rebuildScanPlan();
+  drumKit->rebuildSensingTable();
 }
 
 void WebUI::handleSetConfigRequest(AsyncWebSocketClient* client, JsonObjectConst configNode) {
@@ -248,6 +271,7 @@ void WebUI::handleSetMappingsRequest(JsonObject mappingsNode) {
   // if there is more than one mapping we assume that the user wants to replace all mappings (e.g. EZDrummer by Addictive Drums).
   // We have to delete all existing mappings first as not all old roles might be defined in the new config
   bool replaceAll = replace && (mappingsNode.size() - 1) > 1;
+  SensingPause sensingPause; // the pads use the mappings while sensing
   if (replaceAll) {
     drumKit->deleteAllMappings();
     replace = false; // no need to replace individual mappings as we already deleted everything
@@ -258,16 +282,19 @@ void WebUI::handleSetMappingsRequest(JsonObject mappingsNode) {
 }
 
 void WebUI::handleSetGeneralConfigRequest(JsonObjectConst generalConfigNode) {
+  SensingPause sensingPause;
   DrumConfigMapper::applyGeneralConfig(*drumKit, generalConfigNode);
   isConfigDirty = true;
 }
 
 void WebUI::handleTriggerMonitor() {
+  SensingPause sensingPause;
   drumKit->getMonitor().triggerMonitor();
 }
 
 void WebUI::handlePlayNote(JsonObjectConst argsNode) {
   midi_note_t midiNote = argsNode["note"];
+  SensingPause sensingPause; // the sensing core is the only producer of the MIDI output queue
   drumKit->sendMidiNoteOnOffMessage(midiNote, 100);
 }
 
@@ -283,7 +310,29 @@ void WebUI::handleEventLogRequest(AsyncWebSocketClient* client) {
   sendJsonToWebSocket(doc, client);
 }
 
-void WebUI::handleStatsRequest(AsyncWebSocketClient* client) {
+static void addCostHistogram(JsonObject parentNode, const char* name, const CostHistogram& histogram) {
+  JsonObject node = parentNode[name].to<JsonObject>();
+  node["count"] = histogram.getCount();
+  node["minUs"] = histogram.getMinUs();
+  node["avgUs"] = histogram.getAvgUs();
+  node["p99Us"] = histogram.getPercentileUs(99);
+  node["maxUs"] = histogram.getMaxUs();
+}
+
+#ifdef ENABLE_LOOP_PROFILER
+static void addLoopProfile(JsonObject statsNode) {
+  JsonObject profileNode = statsNode["loopProfile"].to<JsonObject>();
+  addCostHistogram(profileNode, "sensingPeriod", loopProfiler.getSensingPeriod());
+  JsonObject phasesNode = profileNode["phases"].to<JsonObject>();
+  for (uint8_t phase = 0; phase < LOOP_PHASE_COUNT; ++phase) {
+    addCostHistogram(phasesNode, loopPhaseToString((LoopPhase) phase).c_str(), loopProfiler.getPhaseCost((LoopPhase) phase));
+  }
+}
+#endif
+
+// the statistics of the sensing core are read without pausing it, a value might be from an older loop than another.
+// Only the loop profile pauses the sensing as its histograms are not consistent while they are written.
+void WebUI::handleStatsRequest(JsonObjectConst argsNode, AsyncWebSocketClient* client) {
   JsonDocument doc;
   JsonObject statsNode = doc["stats"].to<JsonObject>();
 
@@ -294,14 +343,124 @@ void WebUI::handleStatsRequest(AsyncWebSocketClient* client) {
     statsNode["updateCountPer30s"] = nullptr;
   }
 
+  // sum of the time the inputs were suppressed while they settled after the multiplexers were idle
+  statsNode["settlingSuppressedMs"] = (uint32_t) (drumKit->getSettlingTracker().getSuppressedTimeUs() / 1000);
+  statsNode["muxSettleCount"] = drumKit->statistics.muxSettleCount;
+
+  const NoteOffScheduler& noteOffScheduler = drumKit->getNoteOffScheduler();
+  JsonObject notesNode = statsNode["notes"].to<JsonObject>();
+  notesNode["pending"] = noteOffScheduler.getPendingCount();
+  notesNode["maxPending"] = noteOffScheduler.getMaxPendingCount();
+  notesNode["retriggered"] = drumKit->statistics.retriggeredNoteCount;
+
+  // messages dropped before they were passed to the outputs
+  statsNode["midiDropped"] = midiOutputQueue.getDroppedCount();
+  JsonArray midiOutputsNode = statsNode["midiOutputs"].to<JsonArray>();
+  for (uint8_t i = 0; i < midiTransport.getOutputCount(); ++i) {
+    const MidiPriorityQueue& outputQueue = midiTransport.getOutputQueue(i);
+    JsonObject midiNode = midiOutputsNode.add<JsonObject>();
+    midiNode["mode"] = midiOutputModeToString(midiTransport.getOutputMode(i));
+    midiNode["queued"] = outputQueue.getSize();
+    midiNode["maxQueued"] = outputQueue.getMaxSize();
+    midiNode["dropped"] = outputQueue.getDroppedCount() + midiTransport.getOutputDroppedCount(i);
+    midiNode["coalesced"] = outputQueue.getCoalescedCount();
+  }
+  // time from the hit to the NoteOn on the selected output, max - min is the jitter
+  addCostHistogram(statsNode, "midiLatency", midiTransport.getHitLatency());
+
   statsNode["cpuFreq"] = DrumIO::getCpuFrequency();
 
   uint32_t totalHeap, freeHeap;
   DrumIO::getMemoryStats(totalHeap, freeHeap);
   JsonObject memNode = statsNode["mem"].to<JsonObject>();
   memNode["freeHeap"] = freeHeap;
+  memNode["minFreeHeap"] = DrumIO::getMinFreeHeap();
   memNode["totalHeap"] = totalHeap;
 
+  const bool resetProfile = argsNode["resetProfile"] | false;
+  if (resetProfile) {
+    midiTransport.resetHitLatency();
+  }
+
+#ifdef ENABLE_LOOP_PROFILER
+  {
+    // the histograms are written by the sensing core while it runs, see LoopProfiler
+    SensingPause sensingPause;
+    addLoopProfile(statsNode);
+    if (resetProfile) {
+      loopProfiler.reset();
+    }
+  }
+#endif
+
+  sendJsonToWebSocket(doc, client);
+}
+
+void WebUI::handleVelocityCalibrationRequest(JsonObjectConst argsNode, AsyncWebSocketClient* client) {
+  pad_size_t padIndex = argsNode["pad"];
+  if (padIndex >= drumKit->getPadsCount()) {
+    eventLog.log(Level::Error, String("Invalid velocity calibration pad: ") + padIndex);
+    return;
+  }
+
+  String action = argsNode["action"] | "get";
+  bool sendConfigRequired = false;
+  VelocityModelFit fit;
+  bool isFitted;
+  uint32_t hitCount;
+  float meanError;
+  sensor_value_t maxError;
+  { // the calibration is recorded by the sensing core
+    SensingPause sensingPause;
+    DrumPad& pad = *drumKit->getPad(padIndex);
+    VelocityCalibration& calibration = pad.getVelocityCalibration();
+    isFitted = calibration.fit(fit);
+
+    if (action == "apply") {
+      if (!isFitted) {
+        eventLog.log(Level::Warn, String("No hits recorded for the velocity calibration of pad ") + padIndex);
+      } else {
+        DrumSettings& settings = pad.getSettings();
+        settings.predictionAmplitudeGain = fit.amplitudeGain;
+        settings.predictionRiseGain = fit.riseGain;
+        settings.predictionEnabled = true;
+        calibration.resetError(); // the error of the new model is tracked from now on
+        isConfigDirty = true;
+        sendConfigRequired = true;
+      }
+    } else if (action == "disable") {
+      pad.getSettings().predictionEnabled = false;
+      isConfigDirty = true;
+      sendConfigRequired = true;
+    } else if (action == "reset") {
+      calibration.reset();
+      isFitted = false;
+    }
+
+    hitCount = calibration.getHitCount();
+    meanError = calibration.getMeanError();
+    maxError = calibration.getMaxError();
+  }
+
+  if (sendConfigRequired) {
+    sendConfig(client);
+  }
+
+  JsonDocument doc;
+  JsonObject calibrationNode = doc["velocityCalibration"].to<JsonObject>();
+  calibrationNode["pad"] = padIndex;
+  calibrationNode["hitCount"] = hitCount;
+  calibrationNode["meanError"] = meanError;
+  calibrationNode["maxError"] = maxError;
+  if (isFitted) {
+    JsonObject fitNode = calibrationNode["fit"].to<JsonObject>();
+    fitNode["amplitudeGain"] = fit.amplitudeGain;
+    fitNode["riseGain"] = fit.riseGain;
+    fitNode["rmsError"] = fit.rmsError;
+  } else {
+    calibrationNode["fit"] = nullptr;
+  }
+
   sendJsonToWebSocket(doc, client);
 }
 
@@ -322,22 +481,56 @@ void WebUI::handleRestoreConfigRequest(AsyncWebSocketClient* client) {
 void WebUI::handleLatencyTestRequest(JsonObjectConst argsNode, AsyncWebSocketClient* client) {
   DrumMonitor& monitor = drumKit->getMonitor();
   bool enabled = argsNode["enabled"];
-  if (enabled) {
-    bool preview = argsNode["preview"];
-    sensor_value_t threshold = argsNode["threshold"];
-    midi_note_t midiNote = argsNode["midiNote"] | 38;
-    monitor.startLatencyTest(preview, threshold, midiNote);
-    if (preview) {
-      // send config as the latency test might not be started if no monitored pad was selected
-      // but only send it in preview mode to not interfer with the test
-      sendConfig(client);
+  bool preview = argsNode["preview"];
+  {
+    SensingPause sensingPause;
+    if (enabled) {
+      sensor_value_t threshold = argsNode["threshold"];
+      midi_note_t midiNote = argsNode["midiNote"] | 38;
+      monitor.startLatencyTest(preview, threshold, midiNote);
+    } else {
+      monitor.stopLatencyTest();
     }
-  } else {
-    monitor.stopLatencyTest();
+  }
+
+  // send config as the latency test might not be started if no monitored pad was selected
+  // but only send it in preview mode to not interfer with the test
+  if (!enabled || preview) {
     sendConfig(client);
   }
 }
 
+void WebUI::handleAdcTraceRequest(JsonObjectConst argsNode, AsyncWebSocketClient* client) {
+  AdcTraceCapture& capture = drumKit->getAdcTraceCapture();
+  bool enabled = argsNode["enabled"];
+  if (enabled) {
+    time_us_t minIntervalUs = argsNode["minIntervalUs"] | 0;
+    uint8_t header[sizeof(AdcTraceHeader) + MAX_SCAN_SLOTS * sizeof(AdcTraceSlotInfo)];
+    size_t headerSize;
+    {
+      SensingPause sensingPause;
+      headerSize = capture.start(*drumKit, minIntervalUs, header, sizeof(header));
+    }
+    sendBinaryToWebSocket(header, headerSize);
+  } else if (capture.isActive()) {
+    {
+      SensingPause sensingPause;
+      capture.stop();
+    }
+    AdcTraceCapture::forwardQueuedChunks(); // the trace must be complete before the status is sent
+  }
+
+  sendAdcTraceStatus(capture, client);
+}
+
+void WebUI::sendAdcTraceStatus(const AdcTraceCapture& capture, AsyncWebSocketClient* client) {
+  JsonDocument doc;
+  JsonObject traceNode = doc["adcTrace"].to<JsonObject>();
+  traceNode["active"] = capture.isActive();
+  traceNode["droppedFrames"] = capture.getDroppedFrameCount();
+  sendJsonToWebSocket(doc, client);
+}
+
 void WebUI::handleScanBleDevicesRequest(AsyncWebSocketClient* client) {
 #if HAS_BLUETOOTH
   bleClient.startDeviceScan();
@@ -416,6 +609,10 @@ void WebUI::sendUsbHostStatus(const String& deviceName, AsyncWebSocketClient* cl
   sendJsonToWebSocket(doc, client);
 }
 
+/**
+ * Only the handlers that change the drum kit pause the sensing core, and only while they change it.
+ * The config is only written by the main core, so it can be read and sent while the sensing runs.
+ */
 void WebUI::handleCommand(String cmd, JsonObject& argsNode, AsyncWebSocketClient* client) {
   if (cmd == "getConfig") {
     handleGetConfigRequest(client);
@@ -444,7 +641,11 @@ void WebUI::handleCommand(String cmd, JsonObject& argsNode, AsyncWebSocketClient
   } else if (cmd == "getEvents") {
     handleEventLogRequest(client);
   } else if (cmd == "getStats") {
-    handleStatsRequest(client);
+    handleStatsRequest(argsNode, client);
+  } else if (cmd == "velocityCalibration") {
+    handleVelocityCalibrationRequest(argsNode, client);
+  } else if (cmd == "adcTrace") {
+    handleAdcTraceRequest(argsNode, client);
   } else if (cmd == "scanBleDevices") {
     handleScanBleDevicesRequest(client);
   } else if (cmd == "blePair") {
@@ -26,6 +26,7 @@ public:
   void sendBleScanResult(const std::vector<BleDeviceInfo>& results);
   void sendBleStatus(BleClientStatus status, bool isScanning, AsyncWebSocketClient* client = nullptr);
   void sendUsbHostStatus(const String& deviceName, AsyncWebSocketClient* client = nullptr);
+  void sendAdcTraceStatus(const AdcTraceCapture& capture, AsyncWebSocketClient* client = nullptr);
 
 private:
   void initHttpServer();
@@ -40,6 +41,7 @@ private:
   void handleSetGeneralConfigRequest(JsonObjectConst generalConfigNode);
   void handleSetMonitor(JsonObjectConst configNode);
   void handleSetPadConfig(JsonObjectConst configNode, AsyncWebSocketClient* client);
+  bool applyPadConfig(JsonObjectConst configNode);
   void handleTriggerMonitor();
   void handleSaveConfigRequest(AsyncWebSocketClient* client);
   void handleRestoreConfigRequest(AsyncWebSocketClient* client);
@@ -47,7 +49,9 @@ private:
   void handlePlayNote(JsonObjectConst argsNode);
   void handleEventLogRequest(AsyncWebSocketClient* client);
   void handleLatencyTestRequest(JsonObjectConst argsNode, AsyncWebSocketClient* client);
-  void handleStatsRequest(AsyncWebSocketClient* client);
+  void handleStatsRequest(JsonObjectConst argsNode, AsyncWebSocketClient* client);
+  void handleVelocityCalibrationRequest(JsonObjectConst argsNode, AsyncWebSocketClient* client);
+  void handleAdcTraceRequest(JsonObjectConst argsNode, AsyncWebSocketClient* client);
   void handleScanBleDevicesRequest(AsyncWebSocketClient* client);
   void handleSetBlePairingRequest(JsonObjectConst argsNode, AsyncWebSocketClient* client);
   void handleGetBleStatusRequest(AsyncWebSocketClient* client);
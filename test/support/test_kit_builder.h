@@ -0,0 +1,101 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "simulation.h"
+
+/**
+ * Builds the drum kits of the tests on the simulated inputs. Only used by the tests, so it is header-only and
+ * not part of the simulation.
+ *
+ * The pads with typical settings are connected to the first mux, so that the synthetic hits (see HitPattern)
+ * are detected. The MIDI notes are left to the tests.
+ */
+class TestKitBuilder {
+public:
+  TestKitBuilder(DrumKit& kit)
+    : kit(kit) {}
+
+  // enabled pad with the default settings, e.g. for a direct pin or another mux
+  DrumPad& addPad(const char* name, const DrumPin* pins, pin_size_t pinCount) {
+    DrumConnector connector;
+    connector.setId(name);
+    connector.setPins(pins, pinCount);
+    kit.addConnector(connector);
+
+    DrumPad& pad = kit.addPad();
+    pad.setName(name);
+    pad.setConnector(kit.getConnectorById(name));
+    pad.setEnabled(true);
+    return pad;
+  }
+
+  // enabled pad with the default settings on a channel of the first mux
+  DrumPad& addPad(const char* name, channel_size_t channel) {
+    const DrumPin pins[] = {DrumPin(kit.getMux(0), 0, channel)};
+    return addPad(name, pins, 1);
+  }
+
+  // zone thresholds 100 - 900, 2ms scan time and 30ms mask time
+  DrumPad& addPad(const char* name, const channel_size_t* channels, pin_size_t pinCount,
+      PadType padType, ZonesType zonesType) {
+    DrumPin pins[2];
+    for (pin_size_t i = 0; i < pinCount; ++i) {
+      pins[i] = DrumPin(kit.getMux(0), 0, channels[i]);
+    }
+    DrumPad& pad = addPad(name, pins, pinCount);
+    pad.setMappings(kit.getOrCreateMappings(name));
+
+    DrumSettings& settings = pad.getSettings();
+    settings.padType = padType;
+    settings.zonesType = zonesType;
+    for (zone_size_t zone = 0; zone < 3; ++zone) {
+      settings.zoneThresholdsMin[zone] = 100;
+      settings.zoneThresholdsMax[zone] = 900;
+    }
+    settings.scanTimeUs = 2000;
+    settings.maskTimeMs = 30;
+    return pad;
+  }
+
+  // single piezo
+  DrumPad& addDrum(const char* name, channel_size_t channel) {
+    return addPad(name, &channel, 1, PadType::Drum, ZonesType::Zones1_Piezo);
+  }
+
+  // head and rim piezo
+  DrumPad& addSnare(channel_size_t headChannel, channel_size_t rimChannel) {
+    const channel_size_t channels[] = {headChannel, rimChannel};
+    return addPad("snare", channels, 2, PadType::Drum, ZonesType::Zones2_Piezos);
+  }
+
+  // bow piezo and edge switch, choked by the edge switch
+  DrumPad& addRide(channel_size_t bowChannel, channel_size_t edgeChannel) {
+    const channel_size_t channels[] = {bowChannel, edgeChannel};
+    DrumPad& ride = addPad("ride", channels, 2, PadType::Cymbal, ZonesType::Zones2_PiezoAndSwitch);
+    ride.getSettings().chokeType = ChokeType::Switch_Edge;
+    return ride;
+  }
+
+  // controller over the full range of the sensor
+  DrumPad& addHihatPedal(channel_size_t channel) {
+    DrumPad& pedal = addPad("hihatPedal", &channel, 1, PadType::Pedal, ZonesType::Zones1_Controller);
+    pedal.getSettings().zoneThresholdsMin[0] = 0;
+    pedal.getSettings().zoneThresholdsMax[0] = MAX_SENSOR_VALUE;
+    return pedal;
+  }
+
+  DrumPad& addHihat(channel_size_t channel, DrumPad& pedal) {
+    DrumPad& hihat = addPad("hihat", &channel, 1, PadType::Cymbal, ZonesType::Zones1_Piezo);
+    hihat.setPedalPad(pedal);
+    return hihat;
+  }
+
+  DrumMappings& getMappings(const DrumPad& pad) const {
+    return *kit.getMappings(pad.getName());
+  }
+
+private:
+  DrumKit& kit;
+};
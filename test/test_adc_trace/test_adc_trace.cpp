@@ -0,0 +1,204 @@
+#include "adc_trace_replay.h"
+#include "../support/test_kit_builder.h"
+
+#include <string.h>
+#include <vector>
+
+#include <unity.h>
+
+#define MUX_ANALOG_IN_PIN 26
+#define DIRECT_ANALOG_IN_PIN 27
+
+static TestKitBuilder kit(drumKit);
+
+static void startTrace(std::vector<uint8_t>& trace, time_us_t minIntervalUs) {
+  uint8_t header[sizeof(AdcTraceHeader) + MAX_SCAN_SLOTS * sizeof(AdcTraceSlotInfo)];
+  size_t headerSize = drumKit.getAdcTraceCapture().start(drumKit, minIntervalUs, header, sizeof(header));
+  TEST_ASSERT_TRUE(headerSize > 0);
+  trace.assign(header, header + headerSize);
+}
+
+// the trace file contains the frames of the chunks without their magic
+static void stopTrace(std::vector<uint8_t>& trace) {
+  drumKit.getAdcTraceCapture().stop();
+  while (const AdcTraceChunk* chunk = AdcTraceCapture::peekQueuedChunk()) {
+    const size_t magicSize = strlen(ADC_TRACE_DATA_MAGIC);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(chunk->data, ADC_TRACE_DATA_MAGIC, magicSize));
+    trace.insert(trace.end(), chunk->data + magicSize, chunk->data + chunk->size);
+    AdcTraceCapture::popQueuedChunk();
+  }
+}
+
+void setUp(void) {
+  drumKit.reset();
+  DrumIO::setup(false);
+
+  DrumMux mux;
+  mux.initHC4067(11, 12, 13, 14, MUX_ANALOG_IN_PIN, 10);
+  drumKit.addMux(mux);
+  enableVirtualClock(1000000);
+}
+
+void tearDown(void) {
+  disableVirtualClock();
+}
+
+void test_adcTrace_frameRoundTrip() {
+  // GIVEN
+  const sensor_value_t samples[] = {0, 1, 511, 1023, 700, INVALID_SENSOR_VALUE, 3};
+  const uint8_t count = sizeof(samples) / sizeof(samples[0]);
+  uint8_t buffer[32];
+
+  // WHEN
+  size_t encodedSize = encodeAdcTraceFrame(buffer, 70000, samples, count);
+  time_us_t deltaUs;
+  sensor_value_t decoded[count];
+  size_t decodedSize = decodeAdcTraceFrame(buffer, deltaUs, decoded, count);
+
+  // THEN
+  TEST_ASSERT_EQUAL_UINT(2 + 4 + 9, encodedSize); // long delta and 70 bits
+  TEST_ASSERT_EQUAL_UINT(encodedSize, decodedSize);
+  TEST_ASSERT_EQUAL_UINT(70000, deltaUs);
+  for (uint8_t i = 0; i < count; ++i) {
+    const sensor_value_t expected = (samples[i] == INVALID_SENSOR_VALUE) ? MAX_SENSOR_VALUE : samples[i];
+    TEST_ASSERT_EQUAL_UINT16(expected, decoded[i]);
+  }
+}
+
+void test_adcTrace_captureAndReplay() {
+  // GIVEN
+  const DrumPin directPin(DIRECT_ANALOG_IN_PIN);
+  DrumPad& pad0 = kit.addPad("pad0", 3);
+  DrumPad& pad1 = kit.addPad("pad1", &directPin, 1);
+  drumKit.init();
+  std::vector<uint8_t> trace;
+  startTrace(trace, 0);
+
+  const sensor_value_t values[] = {0, 400, 800};
+  for (sensor_value_t value : values) {
+    setPadPinValue(pad0, 0, value);
+    setPadPinValue(pad1, 0, value / 2);
+    drumKit.updateDrums();
+    advanceVirtualClock(250);
+  }
+  stopTrace(trace);
+  setPadPinValue(pad0, 0, 0);
+  setPadPinValue(pad1, 0, 0);
+
+  // WHEN
+  AdcTraceReplay replay;
+  TEST_ASSERT_TRUE(replay.load(trace.data(), trace.size()));
+
+  // THEN
+  TEST_ASSERT_EQUAL_UINT8(2, replay.getSlotsCount());
+  TEST_ASSERT_EQUAL_UINT8(0, replay.getSlotInfo(0).muxIndex);
+  TEST_ASSERT_EQUAL_UINT8(3, replay.getSlotInfo(0).channel);
+  TEST_ASSERT_EQUAL_UINT8(0, replay.getSlotInfo(0).padIndex);
+  TEST_ASSERT_EQUAL_UINT8(ADC_TRACE_DIRECT_PIN, replay.getSlotInfo(1).muxIndex);
+  TEST_ASSERT_EQUAL_UINT8(DIRECT_ANALOG_IN_PIN, replay.getSlotInfo(1).channel);
+  TEST_ASSERT_EQUAL_UINT8(1, replay.getSlotInfo(1).padIndex);
+  TEST_ASSERT_EQUAL_UINT(3, replay.getFrameCount());
+
+  const time_us_t startTimeUs = micros();
+  for (sensor_value_t value : values) {
+    TEST_ASSERT_TRUE(replay.nextFrame());
+    drumKit.getScanner().sweep();
+    TEST_ASSERT_EQUAL_UINT16(ZERO_OFFSET + value / 2, drumKit.getScanner().getSample(0));
+    TEST_ASSERT_EQUAL_UINT16(value / 2, drumKit.getScanner().getSample(1));
+  }
+  TEST_ASSERT_FALSE(replay.nextFrame());
+  TEST_ASSERT_TRUE(micros() - startTimeUs >= 2 * 250); // replayed with the recorded timing
+}
+
+void test_adcTrace_longDelta() {
+  // GIVEN
+  const sensor_value_t samples[] = {100, 200};
+  uint8_t buffer[32];
+  time_us_t deltaUs;
+  sensor_value_t decoded[2];
+
+  // WHEN
+  size_t shortSize = encodeAdcTraceFrame(buffer, ADC_TRACE_LONG_DELTA - 1, samples, 2);
+  decodeAdcTraceFrame(buffer, deltaUs, decoded, 2);
+
+  // THEN
+  TEST_ASSERT_EQUAL_UINT(2 + 3, shortSize);
+  TEST_ASSERT_FALSE(isAdcTraceLongDelta(buffer));
+  TEST_ASSERT_EQUAL_UINT(ADC_TRACE_LONG_DELTA - 1, deltaUs);
+
+  // WHEN
+  size_t longSize = encodeAdcTraceFrame(buffer, ADC_TRACE_LONG_DELTA, samples, 2);
+  decodeAdcTraceFrame(buffer, deltaUs, decoded, 2);
+
+  // THEN
+  TEST_ASSERT_EQUAL_UINT(2 + 4 + 3, longSize);
+  TEST_ASSERT_TRUE(isAdcTraceLongDelta(buffer));
+  TEST_ASSERT_EQUAL_UINT(ADC_TRACE_LONG_DELTA, deltaUs);
+  TEST_ASSERT_EQUAL_UINT16(200, decoded[1]);
+}
+
+void test_adcTrace_replayLongGap() {
+  // GIVEN
+  DrumPad& pad = kit.addPad("pad0", 0);
+  drumKit.init();
+  std::vector<uint8_t> trace;
+  startTrace(trace, 0);
+  setPadPinValue(pad, 0, 100);
+  drumKit.updateDrums();
+  advanceVirtualClock(500000); // e.g. frames were dropped
+  setPadPinValue(pad, 0, 200);
+  drumKit.updateDrums();
+  advanceVirtualClock(250);
+  drumKit.updateDrums();
+  stopTrace(trace);
+
+  // WHEN
+  AdcTraceReplay replay;
+  TEST_ASSERT_TRUE(replay.load(trace.data(), trace.size()));
+
+  // THEN
+  TEST_ASSERT_EQUAL_UINT(3, replay.getFrameCount());
+  TEST_ASSERT_TRUE(replay.nextFrame());
+  TEST_ASSERT_TRUE(replay.nextFrame());
+  TEST_ASSERT_EQUAL_UINT(500000, replay.getTimeUs());
+  TEST_ASSERT_TRUE(replay.nextFrame());
+  TEST_ASSERT_EQUAL_UINT(500250, replay.getTimeUs());
+  TEST_ASSERT_FALSE(replay.nextFrame());
+}
+
+void test_adcTrace_minInterval() {
+  // GIVEN
+  kit.addPad("pad0", 0);
+  drumKit.init();
+  std::vector<uint8_t> trace;
+  startTrace(trace, 1000);
+
+  // WHEN
+  for (int i = 0; i < 100; ++i) {
+    drumKit.updateDrums();
+    advanceVirtualClock(100);
+  }
+  stopTrace(trace);
+
+  // THEN
+  AdcTraceReplay replay;
+  TEST_ASSERT_TRUE(replay.load(trace.data(), trace.size()));
+  TEST_ASSERT_EQUAL_UINT(10, replay.getFrameCount());
+}
+
+void test_adcTrace_invalidHeader() {
+  const uint8_t data[] = {'E', 'D', 'T', 'X', ADC_TRACE_VERSION, 0};
+  AdcTraceReplay replay;
+  TEST_ASSERT_FALSE(replay.load(data, sizeof(data)));
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_adcTrace_frameRoundTrip);
+  RUN_TEST(test_adcTrace_captureAndReplay);
+  RUN_TEST(test_adcTrace_longDelta);
+  RUN_TEST(test_adcTrace_replayLongGap);
+  RUN_TEST(test_adcTrace_minInterval);
+  RUN_TEST(test_adcTrace_invalidHeader);
+  return UNITY_END();
+}
@@ -0,0 +1,136 @@
+#include "ble_midi_packet.h"
+
+#include <unity.h>
+
+BleMidiPacketEncoder encoder;
+
+void setUp(void) {
+  encoder = BleMidiPacketEncoder();
+}
+
+void tearDown(void) {
+  // clean stuff up here
+}
+
+static MidiMessage noteOn(uint8_t note, time_us_t timeUs) {
+  return {MidiMessageType::NoteOn, note, 100, 10, timeUs};
+}
+
+static MidiMessage noteOff(uint8_t note, time_us_t timeUs) {
+  return {MidiMessageType::NoteOff, note, 0, 10, timeUs};
+}
+
+static void assertPacket(const uint8_t* expected, size_t expectedSize) {
+  TEST_ASSERT_EQUAL(expectedSize, encoder.getPacketSize());
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, encoder.getPacket(), expectedSize);
+}
+
+void test_messages_get_timestamps_of_their_hits() {
+  // GIVEN: timestamp 0x1234 & 0x1FFF = 0x1234 -> header bits 0x24, low bits 0x34
+  const time_us_t hitTimeUs = 0x1234 * 1000;
+
+  // WHEN
+  TEST_ASSERT_TRUE(encoder.addMessage(noteOn(36, hitTimeUs)));
+  TEST_ASSERT_TRUE(encoder.addMessage(noteOn(38, hitTimeUs + 2000)));
+
+  // THEN
+  const uint8_t expected[] = {0xA4, 0xB4, 0x99, 36, 100, 0xB6, 38, 100};
+  assertPacket(expected, sizeof(expected));
+  TEST_ASSERT_EQUAL(2, encoder.getMessageCount());
+}
+
+void test_status_is_sent_if_it_changes() {
+  // WHEN
+  encoder.addMessage(noteOn(36, 0));
+  encoder.addMessage(noteOff(36, 0));
+  encoder.addMessage({MidiMessageType::ChannelAfterTouch, 64, 0, 10, 0});
+
+  // THEN
+  const uint8_t expected[] = {0x80, 0x80, 0x99, 36, 100, 0x80, 0x89, 36, 0, 0x80, 0xD9, 64};
+  assertPacket(expected, sizeof(expected));
+}
+
+void test_earlier_message_gets_timestamp_of_predecessor() {
+  // GIVEN
+  encoder.addMessage(noteOn(38, 10000));
+
+  // WHEN: NoteOff of a note that was hit before
+  encoder.addMessage(noteOff(36, 8000));
+
+  // THEN
+  const uint8_t expected[] = {0x80, 0x8A, 0x99, 38, 100, 0x8A, 0x89, 36, 0};
+  assertPacket(expected, sizeof(expected));
+}
+
+void test_timestamp_overflow_within_packet() {
+  // GIVEN
+  encoder.addMessage(noteOn(36, 0x7E * 1000));
+
+  // WHEN
+  encoder.addMessage(noteOn(38, 0x81 * 1000));
+
+  // THEN: the receiver adds 0x80 as the low bits are lower than before
+  const uint8_t expected[] = {0x80, 0xFE, 0x99, 36, 100, 0x81, 38, 100};
+  assertPacket(expected, sizeof(expected));
+}
+
+void test_message_far_after_predecessor_needs_new_packet() {
+  // GIVEN
+  encoder.addMessage(noteOn(36, 0));
+
+  // WHEN
+  bool added = encoder.addMessage(noteOn(38, 128000));
+
+  // THEN
+  TEST_ASSERT_FALSE(added);
+  TEST_ASSERT_EQUAL(1, encoder.getMessageCount());
+}
+
+void test_full_packet_rejects_message() {
+  // GIVEN: header + 5 bytes of the first message + 3 bytes for each of the following messages
+  for (uint8_t note = 0; note < 6; ++note) {
+    TEST_ASSERT_TRUE(encoder.addMessage(noteOn(note, 0)));
+  }
+  TEST_ASSERT_EQUAL(BLE_MIDI_DEFAULT_PACKET_SIZE, encoder.getPacketSize());
+
+  // WHEN
+  bool added = encoder.addMessage(noteOn(6, 0));
+
+  // THEN
+  TEST_ASSERT_FALSE(added);
+
+  // WHEN
+  encoder.clear();
+  encoder.setMaxPacketSize(32);
+
+  // THEN
+  TEST_ASSERT_TRUE(encoder.isEmpty());
+  TEST_ASSERT_TRUE(encoder.addMessage(noteOn(6, 0)));
+  TEST_ASSERT_EQUAL_UINT8(0x99, encoder.getPacket()[2]); // running status starts new with each packet
+}
+
+void test_max_packet_size_is_clamped() {
+  // WHEN
+  encoder.setMaxPacketSize(0);
+
+  // THEN
+  TEST_ASSERT_EQUAL(BLE_MIDI_DEFAULT_PACKET_SIZE, encoder.getMaxPacketSize());
+
+  // WHEN
+  encoder.setMaxPacketSize(512);
+
+  // THEN
+  TEST_ASSERT_EQUAL(BLE_MIDI_PACKET_BUFFER_SIZE, encoder.getMaxPacketSize());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_messages_get_timestamps_of_their_hits);
+  RUN_TEST(test_status_is_sent_if_it_changes);
+  RUN_TEST(test_earlier_message_gets_timestamp_of_predecessor);
+  RUN_TEST(test_timestamp_overflow_within_packet);
+  RUN_TEST(test_message_far_after_predecessor_needs_new_packet);
+  RUN_TEST(test_full_packet_rejects_message);
+  RUN_TEST(test_max_packet_size_is_clamped);
+  return UNITY_END();
+}
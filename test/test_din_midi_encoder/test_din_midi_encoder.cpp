@@ -0,0 +1,133 @@
+#include "din_midi_encoder.h"
+
+#include <unity.h>
+
+DinMidiEncoder encoder;
+uint8_t buffer[DinMidiEncoder::getMaxBatchSize()];
+
+void setUp(void) {
+  encoder = DinMidiEncoder();
+}
+
+void tearDown(void) {
+  // clean stuff up here
+}
+
+void test_noteOff_is_sent_as_noteOn_with_running_status() {
+  // WHEN
+  encoder.addNoteOn(38, 100, 10);
+  encoder.addNoteOff(38, 0, 10);
+  size_t size = encoder.encodeBatch(buffer);
+
+  // THEN
+  const uint8_t expected[] = {0x99, 38, 100, 38, 0};
+  TEST_ASSERT_EQUAL(sizeof(expected), size);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, buffer, size);
+  TEST_ASSERT_TRUE(encoder.isEmpty());
+}
+
+void test_noteOffs_are_deferred_after_noteOns() {
+  // GIVEN: 4 pads hit at the same time, each with NoteOn and NoteOff as by DrumKit::sendMidiNoteOnOffMessage()
+  const uint8_t notes[] = {36, 38, 42, 49};
+  for (uint8_t note : notes) {
+    encoder.addNoteOn(note, 100, 10);
+    encoder.addNoteOff(note, 0, 10);
+  }
+
+  // WHEN
+  size_t size = encoder.encodeBatch(buffer);
+
+  // THEN
+  const uint8_t expected[] = {
+    0x99, 36, 100, 38, 100, 42, 100, 49, 100,
+    36, 0, 38, 0, 42, 0, 49, 0
+  };
+  TEST_ASSERT_EQUAL(sizeof(expected), size);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, buffer, size);
+  // the last NoteOn is complete after 9 bytes instead of 24 bytes without the encoder (4.8ms earlier at 31.25 kbaud)
+}
+
+void test_noteOff_is_sent_before_retrigger_of_same_note() {
+  // GIVEN
+  encoder.addNoteOn(49, 100, 10);
+  encoder.addNoteOff(49, 0, 10);
+  encoder.addNoteOff(51, 0, 10);
+
+  // WHEN
+  encoder.addNoteOn(51, 90, 10);
+  size_t size = encoder.encodeBatch(buffer);
+
+  // THEN
+  const uint8_t expected[] = {0x99, 49, 100, 51, 0, 51, 90, 49, 0};
+  TEST_ASSERT_EQUAL(sizeof(expected), size);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, buffer, size);
+}
+
+void test_status_is_sent_if_it_changes() {
+  // WHEN
+  encoder.addControlChange(4, 90, 10);
+  encoder.addNoteOn(46, 80, 10);
+  encoder.addControlChange(4, 100, 10);
+  encoder.addChannelAfterTouch(64, 10);
+  encoder.addPolyAfterTouch(49, 127, 10);
+  size_t size = encoder.encodeBatch(buffer);
+
+  // THEN
+  const uint8_t expected[] = {0xB9, 4, 90, 0x99, 46, 80, 0xB9, 4, 100, 0xD9, 64, 0xA9, 49, 127};
+  TEST_ASSERT_EQUAL(sizeof(expected), size);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, buffer, size);
+}
+
+void test_noteOff_with_release_velocity_keeps_status() {
+  // WHEN
+  encoder.addNoteOff(38, 64, 1);
+  size_t size = encoder.encodeBatch(buffer);
+
+  // THEN
+  const uint8_t expected[] = {0x80, 38, 64};
+  TEST_ASSERT_EQUAL(sizeof(expected), size);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, buffer, size);
+}
+
+void test_running_status_starts_new_with_each_batch() {
+  // GIVEN
+  encoder.addNoteOn(38, 100, 10);
+  encoder.encodeBatch(buffer);
+
+  // WHEN
+  encoder.addNoteOn(36, 100, 10);
+  size_t size = encoder.encodeBatch(buffer);
+
+  // THEN
+  const uint8_t expected[] = {0x99, 36, 100};
+  TEST_ASSERT_EQUAL(sizeof(expected), size);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, buffer, size);
+}
+
+void test_full_batch_drops_messages() {
+  // GIVEN
+  for (int i = 0; i < DIN_MIDI_BATCH_SIZE; ++i) {
+    TEST_ASSERT_FALSE(encoder.isFull());
+    encoder.addNoteOn(i, 100, 10);
+  }
+  TEST_ASSERT_TRUE(encoder.isFull());
+
+  // WHEN
+  encoder.addNoteOn(100, 100, 10);
+
+  // THEN
+  TEST_ASSERT_EQUAL(1, encoder.getDroppedCount());
+  TEST_ASSERT_EQUAL(3 + (DIN_MIDI_BATCH_SIZE - 1) * 2, encoder.encodeBatch(buffer));
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_noteOff_is_sent_as_noteOn_with_running_status);
+  RUN_TEST(test_noteOffs_are_deferred_after_noteOns);
+  RUN_TEST(test_noteOff_is_sent_before_retrigger_of_same_note);
+  RUN_TEST(test_status_is_sent_if_it_changes);
+  RUN_TEST(test_noteOff_with_release_velocity_keeps_status);
+  RUN_TEST(test_running_status_starts_new_with_each_batch);
+  RUN_TEST(test_full_batch_drops_messages);
+  return UNITY_END();
+}
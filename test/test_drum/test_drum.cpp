@@ -1,5 +1,7 @@
 #include "drum/sensing/scale.h"
 
+#include <math.h>
+
 #include <unity.h>
 
 void setUp(void) {
@@ -129,6 +131,64 @@ void test_curve_exp2() {
   TEST_ASSERT_EQUAL_UINT16(127, scaleAndCurve(1023, inMin, inMax, curveType));
 }
 
+// runtime implementation that was replaced by the precomputed tables
+static midi_velocity_t referenceCurveFunc(sensor_value_t inputValue, float base) {
+  float curveValue = pow(base, inputValue - 1) - 1;
+  float curveMax = pow(base, MAX_SENSOR_VALUE - 1) - 1;
+  float outputValue = curveValue / curveMax * 126;
+  return round(outputValue) + 1;
+}
+
+void test_curve_tablesMatchCurveFunc() {
+  const struct {
+    CurveType curveType;
+    float base;
+  } curves[] = {
+    {CurveType::Exponential1, 1.002},
+    {CurveType::Exponential2, 1.004},
+    {CurveType::Logarithmic1, 0.998},
+    {CurveType::Logarithmic2, 0.996}
+  };
+
+  for (const auto& curveInfo : curves) {
+    const CurveTable& table = getCurveTable(curveInfo.curveType);
+    TEST_ASSERT_EQUAL_UINT8(0, table.velocities[0]);
+    for (sensor_value_t value = 1; value <= MAX_SENSOR_VALUE; ++value) {
+      TEST_ASSERT_EQUAL_UINT8(referenceCurveFunc(value, curveInfo.base), table.velocities[value]);
+    }
+  }
+}
+
+void test_curve_custom() {
+  // GIVEN
+  const CurvePoint points[] = {{20, 10}, {50, 100}, {100, 127}};
+  CurveTable table;
+
+  // WHEN
+  buildCustomCurveTable(table, points, 3);
+
+  // THEN
+  TEST_ASSERT_EQUAL_UINT8(0, table.velocities[0]);
+  TEST_ASSERT_EQUAL_UINT8(10, table.velocities[1]); // before first point
+  TEST_ASSERT_EQUAL_UINT8(10, table.velocities[MAX_SENSOR_VALUE / 5]);
+  TEST_ASSERT_EQUAL_UINT8(55, table.velocities[MAX_SENSOR_VALUE * 35 / 100 + 1]); // interpolated
+  TEST_ASSERT_EQUAL_UINT8(100, table.velocities[MAX_SENSOR_VALUE / 2 + 1]);
+  TEST_ASSERT_EQUAL_UINT8(127, table.velocities[MAX_SENSOR_VALUE]);
+}
+
+void test_curve_customWithoutPoints() {
+  // GIVEN
+  CurveTable table;
+
+  // WHEN
+  buildCustomCurveTable(table, nullptr, 0);
+
+  // THEN
+  for (sensor_value_t value = 0; value <= MAX_SENSOR_VALUE; ++value) {
+    TEST_ASSERT_EQUAL_UINT8(curve(value, CurveType::Linear), table.velocities[value]);
+  }
+}
+
 void printCurveFunc() {
 #if 0 // enable this to print out a curve to a file
   const CurveType curveType = CurveType::Exponential2;
@@ -156,5 +216,8 @@ int main(int argc, char** argv) {
   RUN_TEST(test_curve_log2);
   RUN_TEST(test_curve_exp1);
   RUN_TEST(test_curve_exp2);
+  RUN_TEST(test_curve_tablesMatchCurveFunc);
+  RUN_TEST(test_curve_custom);
+  RUN_TEST(test_curve_customWithoutPoints);
   return UNITY_END();
 }
@@ -0,0 +1,386 @@
+#include "simulation.h"
+#include "../support/test_kit_builder.h"
+
+#include <unity.h>
+
+#define MUX_ANALOG_IN_PIN 26
+#define DIRECT_ANALOG_IN_PIN 27
+
+static TestKitBuilder kit(drumKit);
+
+static sensor_value_t readSample(const DrumPad& pad) {
+  const sensor_value_t* sample = pad.getConnector()->getPin(0).sample;
+  TEST_ASSERT_NOT_NULL(sample);
+  return *sample;
+}
+
+void setUp(void) {
+  drumKit.reset();
+  DrumIO::setup(false);
+
+  // two muxes that share the select and analog in pins like on the EavesDrum board
+  DrumMux mux0;
+  mux0.initHC4067(11, 12, 13, 14, MUX_ANALOG_IN_PIN, 10);
+  drumKit.addMux(mux0);
+
+  DrumMux mux1;
+  mux1.initHC4067(11, 12, 13, 14, MUX_ANALOG_IN_PIN, 15);
+  drumKit.addMux(mux1);
+}
+
+void tearDown(void) {
+  // clean stuff up here
+}
+
+void test_scanner_planContainsOnlyUsedInputs() {
+  // GIVEN
+  const DrumPin pinsDirect[] = {DrumPin(DIRECT_ANALOG_IN_PIN)};
+  const DrumPin pinsMux[] = {DrumPin(drumKit.getMux(1), 1, 7), DrumPin(drumKit.getMux(0), 0, 2)};
+  kit.addPad("direct", pinsDirect, 1);
+  kit.addPad("mux", pinsMux, 2).getSettings().zonesType = ZonesType::Zones2_Piezos;
+
+  // WHEN
+  drumKit.init();
+
+  // THEN
+  const DrumScanner& scanner = drumKit.getScanner();
+  TEST_ASSERT_EQUAL_UINT(3, scanner.getSlotsCount());
+  TEST_ASSERT_EQUAL_UINT(2, scanner.getSlot(0).channel); // ordered by channel
+  TEST_ASSERT_EQUAL_UINT(7, scanner.getSlot(1).channel);
+  TEST_ASSERT_NULL(scanner.getSlot(2).mux);
+}
+
+void test_scanner_unusedPinsAreSkipped() {
+  // GIVEN
+  const DrumPin pins0[] = {DrumPin(drumKit.getMux(0), 0, 0), DrumPin(drumKit.getMux(0), 0, 1)};
+  const DrumPin pins1[] = {DrumPin(drumKit.getMux(0), 0, 2)};
+  const DrumPin pinsPedal[] = {DrumPin(drumKit.getMux(0), 0, 3)};
+  kit.addPad("single-zone", pins0, 2); // second pin is not used by a 1-zone pad
+  kit.addPad("disabled", pins1, 1).setEnabled(false);
+  DrumPad& pedal = kit.addPad("pedal", pinsPedal, 1);
+  pedal.setEnabled(false);
+  pedal.getSettings().padType = PadType::Pedal;
+  DrumPad& hihat = kit.addPad("hihat", nullptr, 0);
+  hihat.getSettings().padType = PadType::Cymbal;
+  hihat.setPedalPad(pedal);
+
+  // WHEN
+  drumKit.init();
+
+  // THEN
+  const DrumScanner& scanner = drumKit.getScanner();
+  TEST_ASSERT_EQUAL_UINT(2, scanner.getSlotsCount());
+  TEST_ASSERT_EQUAL_UINT(0, scanner.getSlot(0).channel);
+  TEST_ASSERT_EQUAL_UINT(3, scanner.getSlot(1).channel); // pedal of an enabled hi-hat
+  TEST_ASSERT_NULL(drumKit.getConnectorById("disabled")->getPin(0).sample);
+}
+
+void test_scanner_enabledChange() {
+  // GIVEN
+  const DrumPin pins[] = {DrumPin(drumKit.getMux(0), 0, 5)};
+  DrumPad& pad = kit.addPad("mux", pins, 1);
+  pad.setEnabled(false);
+  drumKit.init();
+  TEST_ASSERT_EQUAL_UINT(0, drumKit.getScanner().getSlotsCount());
+
+  // WHEN
+  pad.setEnabled(true);
+  drumKit.rebuildScanPlan();
+
+  // THEN
+  TEST_ASSERT_EQUAL_UINT(1, drumKit.getScanner().getSlotsCount());
+  TEST_ASSERT_NOT_NULL(pad.getConnector()->getPin(0).sample);
+}
+
+void test_scanner_sharedAnalogInPin() {
+  // GIVEN
+  const DrumPin pins0[] = {DrumPin(drumKit.getMux(0), 0, 3)};
+  const DrumPin pins1[] = {DrumPin(drumKit.getMux(1), 1, 3)};
+  DrumPad& pad0 = kit.addPad("mux0", pins0, 1);
+  DrumPad& pad1 = kit.addPad("mux1", pins1, 1);
+  drumKit.init();
+  setPadPinValue(pad0, 0, 400);
+  setPadPinValue(pad1, 0, 800);
+
+  // WHEN
+  drumKit.updateDrums();
+
+  // THEN
+  TEST_ASSERT_EQUAL_UINT16(ZERO_OFFSET + 400 / 2, readSample(pad0));
+  TEST_ASSERT_EQUAL_UINT16(ZERO_OFFSET + 800 / 2, readSample(pad1));
+}
+
+void test_scanner_interleavedSharedSelectPins() {
+  // GIVEN
+  const DrumPin pins0[] = {DrumPin(drumKit.getMux(0), 0, 0), DrumPin(drumKit.getMux(0), 0, 1)};
+  const DrumPin pins1[] = {DrumPin(drumKit.getMux(1), 1, 0)};
+  kit.addPad("mux0", pins0, 2).getSettings().zonesType = ZonesType::Zones2_Piezos;
+  kit.addPad("mux1", pins1, 1);
+
+  // WHEN
+  drumKit.init();
+
+  // THEN
+  const DrumScanner& scanner = drumKit.getScanner();
+  TEST_ASSERT_TRUE(scanner.getSlot(0).mux == drumKit.getMux(0));
+  TEST_ASSERT_TRUE(scanner.getSlot(1).mux == drumKit.getMux(1));
+  TEST_ASSERT_EQUAL_UINT(0, scanner.getSlot(1).channel);
+  TEST_ASSERT_FALSE(scanner.getSlot(1).needsSelect);
+  TEST_ASSERT_TRUE(scanner.getSlot(2).needsSelect);
+  TEST_ASSERT_FALSE(scanner.getSlot(1).overlapsPrevious); // shared analog in pin
+}
+
+void test_scanner_overlappingMuxes() {
+  // GIVEN
+  drumKit.reset();
+  DrumMux mux0;
+  mux0.initHC4051(2, 3, 4, 26);
+  drumKit.addMux(mux0);
+  DrumMux mux1;
+  mux1.initHC4051(5, 6, 7, 27);
+  drumKit.addMux(mux1);
+
+  const DrumPin pins0[] = {DrumPin(drumKit.getMux(0), 0, 5)};
+  const DrumPin pins1[] = {DrumPin(drumKit.getMux(1), 1, 5)};
+  DrumPad& pad0 = kit.addPad("mux0", pins0, 1);
+  DrumPad& pad1 = kit.addPad("mux1", pins1, 1);
+  drumKit.init();
+  setPadPinValue(pad0, 0, 200);
+  setPadPinValue(pad1, 0, 600);
+
+  // WHEN
+  drumKit.getScanner().sweep();
+
+  // THEN
+  TEST_ASSERT_TRUE(drumKit.getScanner().getSlot(1).overlapsPrevious);
+  TEST_ASSERT_EQUAL_UINT16(ZERO_OFFSET + 200 / 2, readSample(pad0));
+  TEST_ASSERT_EQUAL_UINT16(ZERO_OFFSET + 600 / 2, readSample(pad1));
+}
+
+void test_scanner_directPin() {
+  // GIVEN
+  const DrumPin pins[] = {DrumPin(DIRECT_ANALOG_IN_PIN)};
+  DrumPad& pad = kit.addPad("direct", pins, 1);
+  drumKit.init();
+  setPadPinValue(pad, 0, 700);
+
+  // WHEN
+  drumKit.updateDrums();
+
+  // THEN
+  TEST_ASSERT_EQUAL_UINT16(700, readSample(pad));
+}
+
+void test_scanner_connectorChange() {
+  // GIVEN
+  const DrumPin pins[] = {DrumPin(DIRECT_ANALOG_IN_PIN)};
+  DrumPad& pad = kit.addPad("direct", pins, 1);
+  drumKit.init();
+
+  // WHEN
+  pad.setConnector(nullptr);
+  drumKit.rebuildScanPlan();
+
+  // THEN
+  TEST_ASSERT_EQUAL_UINT(0, drumKit.getScanner().getSlotsCount());
+  TEST_ASSERT_NULL(drumKit.getConnectorById("direct")->getPin(0).sample);
+}
+
+void test_scanner_skippedSlot() {
+  // GIVEN
+  const DrumPin pins0[] = {DrumPin(drumKit.getMux(0), 0, 0)};
+  const DrumPin pins1[] = {DrumPin(drumKit.getMux(0), 0, 1)};
+  DrumPad& pad0 = kit.addPad("pad0", pins0, 1);
+  DrumPad& pad1 = kit.addPad("pad1", pins1, 1);
+  drumKit.init();
+  setPadPinValue(pad0, 0, 400);
+  setPadPinValue(pad1, 0, 800);
+
+  // WHEN
+  drumKit.getScanner().setSlotSkipped(0, true);
+  drumKit.getScanner().sweep();
+
+  // THEN
+  TEST_ASSERT_EQUAL_UINT16(ZERO_OFFSET, readSample(pad0)); // initial value
+  TEST_ASSERT_EQUAL_UINT16(ZERO_OFFSET + 800 / 2, readSample(pad1));
+}
+
+void test_scanner_sweepSlots() {
+  // GIVEN
+  const DrumPin pins0[] = {DrumPin(drumKit.getMux(0), 0, 0)};
+  const DrumPin pins1[] = {DrumPin(drumKit.getMux(1), 1, 4)};
+  DrumPad& pad0 = kit.addPad("pad0", pins0, 1);
+  DrumPad& pad1 = kit.addPad("pad1", pins1, 1);
+  drumKit.init();
+  setPadPinValue(pad0, 0, 400);
+  setPadPinValue(pad1, 0, 800);
+
+  // WHEN
+  const scan_slot_t slotIndices[] = {1};
+  drumKit.getScanner().sweepSlots(slotIndices, 1);
+
+  // THEN
+  TEST_ASSERT_EQUAL_UINT16(ZERO_OFFSET, readSample(pad0));
+  TEST_ASSERT_EQUAL_UINT16(ZERO_OFFSET + 800 / 2, readSample(pad1));
+}
+
+void test_scanner_maskedDrumIsSkipped() {
+  // GIVEN
+  const DrumPin pins0[] = {DrumPin(drumKit.getMux(0), 0, 0)};
+  const DrumPin pins1[] = {DrumPin(drumKit.getMux(0), 0, 1)};
+  DrumPad& drum = kit.addPad("drum", pins0, 1);
+  DrumPad& cymbal = kit.addPad("cymbal", pins1, 1);
+  cymbal.getSettings().padType = PadType::Cymbal;
+  drum.getSettings().scanTimeUs = 0;
+  cymbal.getSettings().scanTimeUs = 0;
+  drumKit.init();
+  setPadPinValue(drum, 0, 800);
+  setPadPinValue(cymbal, 0, 800);
+  drumKit.updateDrums(); // the hit ends the scan time in the first oversampling pass
+  TEST_ASSERT_EQUAL(SensingState::Mask, drum.getSensingState());
+  TEST_ASSERT_EQUAL(SensingState::Mask, cymbal.getSensingState());
+
+  // WHEN
+  drumKit.updateDrums();
+
+  // THEN
+  TEST_ASSERT_TRUE(drumKit.getScanner().isSlotSkipped(0));
+  TEST_ASSERT_FALSE(drumKit.getScanner().isSlotSkipped(1)); // cymbals might be choked
+}
+
+void test_scanner_sampleTimes() {
+  // GIVEN
+  const DrumPin pins0[] = {DrumPin(drumKit.getMux(0), 0, 0)};
+  const DrumPin pins1[] = {DrumPin(drumKit.getMux(0), 0, 1)};
+  DrumPad& pad0 = kit.addPad("pad0", pins0, 1);
+  DrumPad& pad1 = kit.addPad("pad1", pins1, 1);
+  drumKit.init();
+  const time_us_t startTimeUs = micros();
+
+  // WHEN
+  drumKit.getScanner().sweep();
+
+  // THEN
+  const time_us_t* sampleTime0 = pad0.getConnector()->getPin(0).sampleTimeUs;
+  const time_us_t* sampleTime1 = pad1.getConnector()->getPin(0).sampleTimeUs;
+  TEST_ASSERT_NOT_NULL(sampleTime0);
+  TEST_ASSERT_NOT_NULL(sampleTime1);
+  TEST_ASSERT_TRUE(*sampleTime0 >= startTimeUs);
+  TEST_ASSERT_TRUE(*sampleTime1 >= *sampleTime0);
+}
+
+void test_scanner_settlingSuppressesUnsettledPads() {
+  // GIVEN
+  const DrumPin pins0[] = {DrumPin(drumKit.getMux(0), 0, 0)};
+  const DrumPin pins1[] = {DrumPin(drumKit.getMux(0), 0, 1)};
+  DrumPad& pad0 = kit.addPad("pad0", pins0, 1);
+  DrumPad& pad1 = kit.addPad("pad1", pins1, 1);
+  drumKit.init();
+  setPadPinValue(pad0, 0, 800); // the line still has to settle
+  setPadPinValue(pad1, 0, 0);
+  SettlingTracker& tracker = drumKit.getSettlingTracker();
+
+  // WHEN
+  tracker.startSettling(micros());
+  for (int i = 0; i < SETTLE_SAMPLE_COUNT; ++i) {
+    drumKit.updateDrums();
+  }
+
+  // THEN
+  TEST_ASSERT_TRUE(tracker.isSettling());
+  TEST_ASSERT_FALSE(tracker.isSettled(0));
+  TEST_ASSERT_TRUE(tracker.isSettled(1));
+  TEST_ASSERT_EQUAL(SensingState::PeakDetect, pad0.getSensingState()); // not evaluated
+  TEST_ASSERT_TRUE(tracker.getSuppressedTimeUs() > 0);
+
+  // WHEN
+  setPadPinValue(pad0, 0, 0);
+  for (int i = 0; i < SETTLE_SAMPLE_COUNT; ++i) {
+    drumKit.updateDrums();
+  }
+
+  // THEN
+  TEST_ASSERT_FALSE(tracker.isSettling());
+  TEST_ASSERT_EQUAL(SensingState::PeakDetect, pad1.getSensingState());
+}
+
+void test_scanner_settlingPadIsNotCalibrated() {
+  // GIVEN
+  const DrumPin pins[] = {DrumPin(drumKit.getMux(0), 0, 0)};
+  DrumPad& pad = kit.addPad("pad", pins, 1);
+  pad.setAutoCalibrate(true);
+  drumKit.init();
+  setPadPinValue(pad, 0, 800);
+  SettlingTracker& tracker = drumKit.getSettlingTracker();
+  enableVirtualClock(1000000); // no timeout of the settling
+
+  // WHEN
+  tracker.startSettling(micros());
+  for (int i = 0; i < BALANCE_THRESHOLD; ++i) {
+    drumKit.updateDrums();
+  }
+
+  // THEN
+  TEST_ASSERT_TRUE(tracker.isSettling());
+  TEST_ASSERT_EQUAL(MAX_SENSOR_VALUE / 2, pad.getConnector()->getPin(0).getOffset());
+  disableVirtualClock();
+}
+
+void test_scanner_settlingTimeout() {
+  // GIVEN
+  const DrumPin pins[] = {DrumPin(drumKit.getMux(0), 0, 0)};
+  DrumPad& pad = kit.addPad("pad", pins, 1);
+  drumKit.init();
+  setPadPinValue(pad, 0, 800);
+  SettlingTracker& tracker = drumKit.getSettlingTracker();
+  tracker.startSettling(micros() - SETTLE_TIMEOUT_US);
+
+  // WHEN
+  drumKit.updateDrums();
+
+  // THEN
+  TEST_ASSERT_FALSE(tracker.isSettling());
+  TEST_ASSERT_TRUE(tracker.getSuppressedTimeUs() >= SETTLE_TIMEOUT_US);
+}
+
+void benchmark_scanner_sweep() {
+  // half-populated kit: only the first mux is used
+  for (channel_size_t channel = 0; channel < 16; ++channel) {
+    const DrumPin pins[] = {DrumPin(drumKit.getMux(0), 0, channel)};
+    kit.addPad((String("pad") + channel).c_str(), pins, 1);
+  }
+  drumKit.init();
+
+  const int sweepCount = 100000;
+  time_us_t startTimeUs = micros();
+  for (int i = 0; i < sweepCount; ++i) {
+    drumKit.getScanner().sweep();
+  }
+  time_us_t durationUs = micros() - startTimeUs;
+
+  char message[100];
+  snprintf(message, sizeof(message), "%d sweeps of %d slots: %llu us",
+      sweepCount, drumKit.getScanner().getSlotsCount(), (unsigned long long) durationUs);
+  TEST_MESSAGE(message);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_scanner_planContainsOnlyUsedInputs);
+  RUN_TEST(test_scanner_unusedPinsAreSkipped);
+  RUN_TEST(test_scanner_enabledChange);
+  RUN_TEST(test_scanner_sharedAnalogInPin);
+  RUN_TEST(test_scanner_interleavedSharedSelectPins);
+  RUN_TEST(test_scanner_overlappingMuxes);
+  RUN_TEST(test_scanner_directPin);
+  RUN_TEST(test_scanner_connectorChange);
+  RUN_TEST(test_scanner_skippedSlot);
+  RUN_TEST(test_scanner_sweepSlots);
+  RUN_TEST(test_scanner_maskedDrumIsSkipped);
+  RUN_TEST(test_scanner_sampleTimes);
+  RUN_TEST(test_scanner_settlingSuppressesUnsettledPads);
+  RUN_TEST(test_scanner_settlingPadIsNotCalibrated);
+  RUN_TEST(test_scanner_settlingTimeout);
+  RUN_TEST(benchmark_scanner_sweep);
+  return UNITY_END();
+}
@@ -0,0 +1,106 @@
+#include "drum/sensing/scale.h"
+
+#include <unity.h>
+
+// float implementations that were replaced by the fixed-point ones
+
+static sensor_value_t referenceDecayThreshold(sensor_value_t maxValue, sensor_value_t thresholdMin, time_us_t timeSinceDecayBeginUs, uint8_t decayTimeMs) {
+  float decayProgress = (float) timeSinceDecayBeginUs / (decayTimeMs * 1000);
+  return (maxValue > thresholdMin)
+    ? maxValue - (maxValue - thresholdMin) * decayProgress
+    : thresholdMin;
+}
+
+static bool referenceIsAtRangePercent(sensor_value_t value, sensor_value_t minValue, sensor_value_t maxValue, float percent) {
+  const sensor_value_t range = maxValue - minValue;
+  float valuePercent = ((int16_t)value - minValue) * 100.f / range;
+  return valuePercent >= percent;
+}
+
+void setUp(void) {
+  // set stuff up here
+}
+
+void tearDown(void) {
+  // clean stuff up here
+}
+
+void test_fixedPoint_fraction() {
+  TEST_ASSERT_EQUAL_UINT32(0, toFractionQ16(0, 1000));
+  TEST_ASSERT_EQUAL_UINT32(FRACTION_Q16_ONE / 2, toFractionQ16(500, 1000));
+  TEST_ASSERT_EQUAL_UINT32(FRACTION_Q16_ONE, toFractionQ16(1000, 1000));
+  TEST_ASSERT_UINT_WITHIN(1, FRACTION_Q16_ONE / 4, toFractionQ16(63750, 255000)); // denominator > 16 bit -> lower bits dropped
+  TEST_ASSERT_EQUAL_UINT32(FRACTION_Q16_ONE, toFractionQ16(255000, 255000));
+}
+
+void test_fixedPoint_percent() {
+  TEST_ASSERT_EQUAL_UINT16(0, toPercentQ8(-5.f));
+  TEST_ASSERT_EQUAL_UINT16(90 << PERCENT_Q8_BITS, toPercentQ8(90.f));
+  TEST_ASSERT_EQUAL_UINT16((100 << PERCENT_Q8_BITS) + 128, toPercentQ8(100.5f));
+  TEST_ASSERT_EQUAL_UINT16(UINT16_MAX, toPercentQ8(1000.f));
+  TEST_ASSERT_EQUAL_FLOAT(90.5f, fromPercentQ8(toPercentQ8(90.5f)));
+}
+
+void test_fixedPoint_decayThresholdMatchesFloat() {
+  const uint8_t decayTimesMs[] = {1, 10, 65, 66, 100, 255};
+  const sensor_value_t thresholdsMin[] = {0, 50, 511, 1000};
+  const sensor_value_t maxValues[] = {0, 50, 400, 800, 1023};
+
+  for (uint8_t decayTimeMs : decayTimesMs) {
+    const time_us_t decayTimeUs = decayTimeMs * 1000;
+    for (sensor_value_t thresholdMin : thresholdsMin) {
+      for (sensor_value_t maxValue : maxValues) {
+        for (time_us_t timeUs = 0; timeUs < decayTimeUs; timeUs += 7) {
+          sensor_value_t expected = referenceDecayThreshold(maxValue, thresholdMin, timeUs, decayTimeMs);
+          sensor_value_t actual = decayThreshold(maxValue, thresholdMin, toFractionQ16(timeUs, decayTimeUs));
+          // the rounding of the fraction can differ by one
+          TEST_ASSERT_UINT16_WITHIN(1, expected, actual);
+        }
+      }
+    }
+  }
+}
+
+void test_fixedPoint_decayThresholdBounds() {
+  TEST_ASSERT_EQUAL_UINT16(800, decayThreshold(800, 100, 0));
+  TEST_ASSERT_EQUAL_UINT16(100, decayThreshold(800, 100, FRACTION_Q16_ONE));
+  TEST_ASSERT_EQUAL_UINT16(450, decayThreshold(800, 100, FRACTION_Q16_ONE / 2));
+  TEST_ASSERT_EQUAL_UINT16(100, decayThreshold(50, 100, FRACTION_Q16_ONE / 2));
+}
+
+void test_fixedPoint_rangePercentMatchesFloat() {
+  const float percents[] = {0.f, 1.f, 33.f, 50.f, 90.f, 99.5f, 100.f, 120.f};
+  const sensor_value_t ranges[][2] = {{0, 1023}, {100, 500}, {511, 512}, {300, 900}, {400, 400}};
+
+  for (float percent : percents) {
+    const percent_q8_t percentQ8 = toPercentQ8(percent);
+    for (const auto& range : ranges) {
+      for (sensor_value_t value = 0; value <= MAX_SENSOR_VALUE; ++value) {
+        bool expected = referenceIsAtRangePercent(value, range[0], range[1], percent);
+        bool actual = isAtRangePercent(value, range[0], range[1], percentQ8);
+        if (expected != actual) {
+          char message[100];
+          snprintf(message, sizeof(message), "value: %d, range: %d..%d, percent: %f", value, range[0], range[1], percent);
+          TEST_FAIL_MESSAGE(message);
+        }
+      }
+    }
+  }
+}
+
+void test_fixedPoint_rangePercentEmptyRange() {
+  TEST_ASSERT_FALSE(isAtRangePercent(400, 400, 400, toPercentQ8(0.f)));
+  TEST_ASSERT_FALSE(isAtRangePercent(399, 400, 400, toPercentQ8(100.f)));
+  TEST_ASSERT_TRUE(isAtRangePercent(401, 400, 400, toPercentQ8(100.f)));
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_fixedPoint_fraction);
+  RUN_TEST(test_fixedPoint_percent);
+  RUN_TEST(test_fixedPoint_decayThresholdMatchesFloat);
+  RUN_TEST(test_fixedPoint_decayThresholdBounds);
+  RUN_TEST(test_fixedPoint_rangePercentMatchesFloat);
+  RUN_TEST(test_fixedPoint_rangePercentEmptyRange);
+  return UNITY_END();
+}
@@ -0,0 +1,398 @@
+#include "adc_trace_replay.h"
+#include "hit_pattern.h"
+#include "midi_transport_capture.h"
+#include "sensing_core.h"
+#include "../support/test_kit_builder.h"
+
+#include <fstream>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include <unity.h>
+
+// Golden-output regression tests of the sensing: recorded ADC traces (<name>.edtr) are replayed through
+// DrumKit::updateDrums() and the MIDI output is compared with the expected output (<name>.golden).
+//
+// Run with GOLDEN_UPDATE=1 to rewrite the golden files after an intended change of the output.
+// Missing traces are recorded from the synthetic scenarios below in this mode, so delete a trace
+// to record it again. Field traces can be added the same way if they match the pins of the kit below.
+
+#define MUX_ANALOG_IN_PIN 26
+
+#define UPDATE_PERIOD_US 200 // of the recording
+#define GATE_TIME_MS 20
+
+// allowed difference to the golden files, e.g. caused by an optimization of the sensing
+#define TIME_TOLERANCE_US 1000
+#define VALUE_TOLERANCE 2 // velocity, pressure or controller value
+
+#define MAX_REPORTED_MISMATCHES 10
+
+// see drum_kit.cpp
+#define MIDI_CHANNEL 10
+#define HIHAT_CC 4
+
+enum GoldenPad {
+  SNARE, // head and rim piezo
+  TOM,
+  KICK,
+  RIDE, // bow piezo and edge switch, choked by the edge switch
+  HIHAT_PEDAL,
+  HIHAT
+};
+
+static const char* const GOLDEN_DIR_NAME = "data";
+
+static String getGoldenPath(const char* name, const char* extension) {
+  String dir = __FILE__;
+  dir = dir.substring(0, max(dir.lastIndexOf('/'), dir.lastIndexOf('\\')) + 1);
+  return dir + GOLDEN_DIR_NAME + "/" + name + extension;
+}
+
+static bool isUpdateMode() {
+  const char* value = getenv("GOLDEN_UPDATE");
+  return value && strcmp(value, "1") == 0;
+}
+
+// changing the kit invalidates the golden files
+static void setupGoldenKit() {
+  TestKitBuilder kit(drumKit);
+  DrumPad& snare = kit.addSnare(0, 1);
+  kit.getMappings(snare).noteMain = 38;
+  kit.getMappings(snare).noteRim = 40;
+
+  const channel_size_t tomChannels[] = {2};
+  DrumPad& tom = kit.addPad("tom", tomChannels, 1, PadType::Drum, ZonesType::Zones1_Piezo);
+  kit.getMappings(tom).noteMain = 48;
+
+  const channel_size_t kickChannels[] = {3};
+  DrumPad& kick = kit.addPad("kick", kickChannels, 1, PadType::Drum, ZonesType::Zones1_Piezo);
+  kit.getMappings(kick).noteMain = 36;
+
+  DrumPad& ride = kit.addRide(4, 5);
+  kit.getMappings(ride).noteMain = 51;
+  kit.getMappings(ride).noteRim = 59;
+
+  DrumPad& pedal = kit.addHihatPedal(7);
+  kit.getMappings(pedal).noteMain = 44;
+
+  DrumPad& hihat = kit.addHihat(6, pedal);
+  kit.getMappings(hihat).noteMain = 46;
+  kit.getMappings(hihat).closedNotesEnabled = true;
+  kit.getMappings(hihat).noteCloseMain = 42;
+
+  drumKit.setGateTime(GATE_TIME_MS);
+  drumKit.init();
+}
+
+/**
+ * Synthetic input of a trace. The pedal position and the choke switch are given as levels that
+ * are held until the next change.
+ */
+struct GoldenScenario {
+  struct Level {
+    time_us_t timeUs;
+    GoldenPad pad;
+    zone_size_t zone;
+    sensor_value_t value;
+  };
+
+  HitPattern hits[2]; // by zone
+  std::vector<Level> levels; // ordered by time
+
+  void addLevel(time_us_t timeUs, GoldenPad pad, zone_size_t zone, sensor_value_t value) {
+    levels.push_back({timeUs, pad, zone, value});
+  }
+
+  // the pedal is closed at 0 and open at MAX_SENSOR_VALUE (as the input is inverted)
+  void movePedal(time_us_t startTimeUs, time_us_t durationUs, sensor_value_t from, sensor_value_t to) {
+    const int steps = durationUs / 1000;
+    for (int step = 0; step <= steps; ++step) {
+      addLevel(startTimeUs + step * 1000, HIHAT_PEDAL, 0, from + ((int) to - from) * step / steps);
+    }
+  }
+
+  time_us_t getDurationUs() const {
+    time_us_t durationUs = max(hits[0].getDurationUs(), hits[1].getDurationUs());
+    return levels.empty() ? durationUs : max(durationUs, levels.back().timeUs + GATE_TIME_MS * 1000 * 2);
+  }
+};
+
+static void recordTrace(const GoldenScenario& scenario, const String& path) {
+  uint8_t header[sizeof(AdcTraceHeader) + MAX_SCAN_SLOTS * sizeof(AdcTraceSlotInfo)];
+  const size_t headerSize = drumKit.getAdcTraceCapture().start(drumKit, 0, header, sizeof(header));
+  TEST_ASSERT_TRUE(headerSize > 0);
+  std::vector<uint8_t> trace(header, header + headerSize);
+
+  const DrumPad& pedal = *drumKit.getPad(HIHAT_PEDAL);
+  setPadPinValue(pedal, 0, MAX_SENSOR_VALUE); // open
+
+  MidiTransport_Capture ignoredOutput;
+  size_t levelIndex = 0;
+  const time_us_t durationUs = scenario.getDurationUs();
+  for (time_us_t timeUs = 0; timeUs < durationUs; timeUs += UPDATE_PERIOD_US) {
+    for (pad_size_t padIndex = 0; padIndex < drumKit.getPadsCount(); ++padIndex) {
+      if (padIndex == HIHAT_PEDAL) {
+        continue;
+      }
+      const DrumPad& pad = *drumKit.getPad(padIndex);
+      setPadPinValue(pad, 0, scenario.hits[0].getValue(padIndex, timeUs));
+      if (pad.getSettings().zonesType == ZonesType::Zones2_Piezos) {
+        setPadPinValue(pad, 1, scenario.hits[1].getValue(padIndex, timeUs));
+      }
+    }
+    for (; levelIndex < scenario.levels.size() && scenario.levels[levelIndex].timeUs <= timeUs; ++levelIndex) {
+      const GoldenScenario::Level& level = scenario.levels[levelIndex];
+      setPadPinValue(*drumKit.getPad(level.pad), level.zone, level.value);
+    }
+
+    drumKit.updateDrums();
+    midiOutputQueue.forwardTo(ignoredOutput);
+    advanceVirtualClock(UPDATE_PERIOD_US);
+
+    if (timeUs + UPDATE_PERIOD_US >= durationUs) {
+      drumKit.getAdcTraceCapture().stop();
+    }
+    while (const AdcTraceChunk* chunk = AdcTraceCapture::peekQueuedChunk()) {
+      const size_t magicSize = strlen(ADC_TRACE_DATA_MAGIC);
+      trace.insert(trace.end(), chunk->data + magicSize, chunk->data + chunk->size);
+      AdcTraceCapture::popQueuedChunk();
+    }
+  }
+
+  std::ofstream file(path.c_str(), std::ios::binary);
+  TEST_ASSERT_TRUE_MESSAGE(file.good(), "cannot write trace");
+  file.write((const char*) trace.data(), trace.size());
+}
+
+static std::vector<CapturedMidiMessage> replayTrace(const String& path) {
+  AdcTraceReplay replay;
+  TEST_ASSERT_TRUE_MESSAGE(replay.loadFile(path.c_str()), "trace is missing, run with GOLDEN_UPDATE=1 to record it");
+  TEST_ASSERT_EQUAL_UINT8(drumKit.getScanner().getSlotsCount(), replay.getSlotsCount());
+
+  MidiTransport_Capture output;
+  output.clear();
+  while (replay.nextFrame()) {
+    drumKit.updateDrums();
+    midiOutputQueue.forwardTo(output);
+  }
+  return output.getMessages();
+}
+
+static bool readGoldenFile(const String& path, std::vector<CapturedMidiMessage>& messages) {
+  std::ifstream file(path.c_str());
+  if (!file) {
+    return false;
+  }
+
+  std::string line;
+  while (std::getline(file, line)) {
+    CapturedMidiMessage message;
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    TEST_ASSERT_TRUE_MESSAGE(CapturedMidiMessage::parse(line.c_str(), message), "invalid line in golden file");
+    messages.push_back(message);
+  }
+  return true;
+}
+
+static void writeGoldenFile(const String& path, const std::vector<CapturedMidiMessage>& messages) {
+  std::ofstream file(path.c_str());
+  TEST_ASSERT_TRUE_MESSAGE(file.good(), "cannot write golden file");
+  file << "# <time in us> <type> <channel> <data1> <data2>, see test_golden.cpp\n";
+  for (const CapturedMidiMessage& message : messages) {
+    file << message.toString().c_str() << "\n";
+  }
+}
+
+static bool isMatching(const CapturedMidiMessage& expected, const CapturedMidiMessage& actual) {
+  return expected.message.type == actual.message.type
+    && expected.message.channel == actual.message.channel
+    && expected.message.data1 == actual.message.data1
+    && abs((int) expected.message.data2 - actual.message.data2) <= VALUE_TOLERANCE
+    && abs((int32_t) (expected.timeUs - actual.timeUs)) <= TIME_TOLERANCE_US;
+}
+
+/**
+ * Matches each expected message with the closest matching message of the actual output.
+ * Messages may be reordered within the time tolerance, e.g. hits of different pads.
+ * @return number of missing and unexpected messages
+ */
+static uint32_t compareWithGolden(const std::vector<CapturedMidiMessage>& expected, const std::vector<CapturedMidiMessage>& actual) {
+  std::vector<bool> isMatched(actual.size(), false);
+  uint32_t mismatchCount = 0;
+
+  for (const CapturedMidiMessage& expectedMessage : expected) {
+    int bestIndex = -1;
+    for (size_t i = 0; i < actual.size(); ++i) {
+      if (!isMatched[i] && isMatching(expectedMessage, actual[i])
+          && (bestIndex < 0 || abs((int32_t) (actual[i].timeUs - expectedMessage.timeUs))
+            < abs((int32_t) (actual[bestIndex].timeUs - expectedMessage.timeUs)))) {
+        bestIndex = i;
+      }
+    }
+
+    if (bestIndex >= 0) {
+      isMatched[bestIndex] = true;
+    } else if (++mismatchCount <= MAX_REPORTED_MISMATCHES) {
+      TEST_MESSAGE((String("missing: ") + expectedMessage.toString()).c_str());
+    }
+  }
+
+  for (size_t i = 0; i < actual.size(); ++i) {
+    if (!isMatched[i] && ++mismatchCount <= MAX_REPORTED_MISMATCHES) {
+      TEST_MESSAGE((String("unexpected: ") + actual[i].toString()).c_str());
+    }
+  }
+  return mismatchCount;
+}
+
+static void runGoldenTest(const char* name, const GoldenScenario& scenario) {
+  const String tracePath = getGoldenPath(name, ".edtr");
+  const String goldenPath = getGoldenPath(name, ".golden");
+
+  if (isUpdateMode() && !std::ifstream(tracePath.c_str())) {
+    recordTrace(scenario, tracePath);
+    // start the replay with the same state as the recording
+    setUp();
+  }
+
+  const uint32_t droppedCount = midiOutputQueue.getDroppedCount();
+  std::vector<CapturedMidiMessage> actual = replayTrace(tracePath);
+  TEST_ASSERT_TRUE(actual.size() > 0);
+  TEST_ASSERT_EQUAL_UINT32(droppedCount, midiOutputQueue.getDroppedCount());
+
+  if (isUpdateMode()) {
+    writeGoldenFile(goldenPath, actual);
+    return;
+  }
+
+  std::vector<CapturedMidiMessage> expected;
+  TEST_ASSERT_TRUE_MESSAGE(readGoldenFile(goldenPath, expected), "golden file is missing, run with GOLDEN_UPDATE=1 to create it");
+  if (compareWithGolden(expected, actual) > 0) {
+    TEST_FAIL_MESSAGE("MIDI output differs from the golden file, run with GOLDEN_UPDATE=1 if the change is intended");
+  }
+}
+
+void setUp(void) {
+  drumKit.reset();
+  DrumIO::setup(false);
+
+  DrumMux mux;
+  mux.initHC4067(11, 12, 13, 14, MUX_ANALOG_IN_PIN, 10);
+  drumKit.addMux(mux);
+  setupGoldenKit();
+
+  MidiTransport_Capture staleOutput;
+  midiOutputQueue.forwardTo(staleOutput);
+  enableVirtualClock(1000000);
+}
+
+void tearDown(void) {
+  disableVirtualClock();
+}
+
+void test_golden_groove() {
+  // a bar of a rock beat at 120 bpm with closed hihat
+  GoldenScenario scenario;
+  scenario.movePedal(0, 10000, MAX_SENSOR_VALUE, 0);
+  const time_us_t eighthUs = 250000;
+  for (int i = 0; i < 8; ++i) {
+    const time_us_t timeUs = 50000 + i * eighthUs;
+    scenario.hits[0].addHit(HIHAT, timeUs, (i % 2 == 0) ? 700 : 400);
+    if (i % 4 == 0) {
+      scenario.hits[0].addHit(KICK, timeUs, 850);
+    } else if (i % 4 == 2) {
+      scenario.hits[0].addHit(SNARE, timeUs, 600 + i * 10);
+    }
+  }
+  runGoldenTest("groove", scenario);
+}
+
+void test_golden_rollsAndFlams() {
+  GoldenScenario scenario;
+  const pad_size_t snare[] = {SNARE};
+  scenario.hits[0].addRoll(snare, 1, 0, 20, 12, 450);
+  scenario.hits[0].addFlam(TOM, 700000, 15000, 200, 800);
+  scenario.hits[0].addFlam(SNARE, 900000, 10000, 250, 750);
+
+  // rim shot: the rim piezo is stronger than the head piezo
+  scenario.hits[0].addHit(SNARE, 1200000, 400);
+  scenario.hits[1].addHit(SNARE, 1200000, 850);
+  // simultaneous hits on different pads
+  scenario.hits[0].addHit(KICK, 1400000, 800);
+  scenario.hits[0].addHit(TOM, 1400000, 500);
+  runGoldenTest("rolls_flams", scenario);
+}
+
+void test_golden_hihatPedalAndChoke() {
+  GoldenScenario scenario;
+  // open hihat, close it fast (chick) and hit it closed
+  scenario.hits[0].addHit(HIHAT, 50000, 600);
+  scenario.movePedal(200000, 15000, MAX_SENSOR_VALUE, 0);
+  scenario.hits[0].addHit(HIHAT, 350000, 600);
+  scenario.movePedal(500000, 100000, 0, MAX_SENSOR_VALUE); // slowly open
+
+  // ride hits and a choke by grabbing the edge
+  scenario.hits[0].addHit(RIDE, 700000, 700);
+  scenario.hits[0].addHit(RIDE, 900000, 500);
+  scenario.addLevel(1000000, RIDE, 1, 800);
+  scenario.addLevel(1200000, RIDE, 1, 0);
+  runGoldenTest("hihat_choke", scenario);
+}
+
+void test_golden_compareAppliesTolerances() {
+  // GIVEN
+  const std::vector<CapturedMidiMessage> expected = {
+    {1000, {MidiMessageType::NoteOn, 38, 100, MIDI_CHANNEL}},
+    {1000, {MidiMessageType::NoteOn, 36, 90, MIDI_CHANNEL}},
+    {5000, {MidiMessageType::ControlChange, HIHAT_CC, 64, MIDI_CHANNEL}}
+  };
+
+  // WHEN
+  const std::vector<CapturedMidiMessage> withinTolerance = {
+    {1000 + TIME_TOLERANCE_US, {MidiMessageType::NoteOn, 36, 90 + VALUE_TOLERANCE, MIDI_CHANNEL}},
+    {1200, {MidiMessageType::NoteOn, 38, 100 - VALUE_TOLERANCE, MIDI_CHANNEL}},
+    {5000 - TIME_TOLERANCE_US, {MidiMessageType::ControlChange, HIHAT_CC, 64, MIDI_CHANNEL}}
+  };
+  const std::vector<CapturedMidiMessage> outOfTolerance = {
+    {1000 + TIME_TOLERANCE_US + 1, {MidiMessageType::NoteOn, 38, 100, MIDI_CHANNEL}},
+    {1000, {MidiMessageType::NoteOn, 36, 90 + VALUE_TOLERANCE + 1, MIDI_CHANNEL}},
+    {5000, {MidiMessageType::ControlChange, HIHAT_CC, 64, MIDI_CHANNEL}},
+    {5000, {MidiMessageType::NoteOff, 36, 0, MIDI_CHANNEL}}
+  };
+
+  // THEN
+  TEST_ASSERT_EQUAL_UINT32(0, compareWithGolden(expected, withinTolerance));
+  TEST_ASSERT_EQUAL_UINT32(2 + 2 + 1, compareWithGolden(expected, outOfTolerance));
+}
+
+void test_golden_messageFormat() {
+  // GIVEN
+  const CapturedMidiMessage message = {123456, {MidiMessageType::PolyAfterTouch, 51, 127, MIDI_CHANNEL}};
+
+  // WHEN
+  CapturedMidiMessage parsed;
+  bool success = CapturedMidiMessage::parse(message.toString(), parsed);
+
+  // THEN
+  TEST_ASSERT_TRUE(success);
+  TEST_ASSERT_EQUAL_STRING("123456 PolyAfterTouch 10 51 127", message.toString().c_str());
+  TEST_ASSERT_EQUAL_UINT32(message.timeUs, parsed.timeUs);
+  TEST_ASSERT_TRUE(parsed.message.type == MidiMessageType::PolyAfterTouch);
+  TEST_ASSERT_EQUAL_UINT8(51, parsed.message.data1);
+  TEST_ASSERT_EQUAL_UINT8(127, parsed.message.data2);
+  TEST_ASSERT_FALSE(CapturedMidiMessage::parse("123 Unknown 10 1 2", parsed));
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_golden_groove);
+  RUN_TEST(test_golden_rollsAndFlams);
+  RUN_TEST(test_golden_hihatPedalAndChoke);
+  RUN_TEST(test_golden_compareAppliesTolerances);
+  RUN_TEST(test_golden_messageFormat);
+  return UNITY_END();
+}
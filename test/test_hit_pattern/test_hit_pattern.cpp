@@ -0,0 +1,142 @@
+#include "hit_pattern.h"
+#include "../support/test_kit_builder.h"
+
+#include <unity.h>
+
+#define MUX_ANALOG_IN_PIN 26
+
+#define SCAN_TIME_US 2000
+#define MASK_TIME_MS 30
+
+static void addPads(pad_size_t count) {
+  TestKitBuilder kit(drumKit);
+  for (pad_size_t padIndex = 0; padIndex < count; ++padIndex) {
+    DrumSettings& settings = kit.addDrum((String("pad") + padIndex).c_str(), padIndex).getSettings();
+    settings.scanTimeUs = SCAN_TIME_US;
+    settings.maskTimeMs = MASK_TIME_MS;
+  }
+  drumKit.init();
+}
+
+void setUp(void) {
+  drumKit.reset();
+  DrumIO::setup(false);
+
+  DrumMux mux;
+  mux.initHC4067(11, 12, 13, 14, MUX_ANALOG_IN_PIN, 10);
+  drumKit.addMux(mux);
+  enableVirtualClock(1000000);
+}
+
+void tearDown(void) {
+  disableVirtualClock();
+}
+
+void test_hitPattern_singleHits() {
+  // GIVEN
+  addPads(1);
+  HitPattern pattern;
+  for (int i = 0; i < 4; ++i) {
+    pattern.addHit(0, i * 100000, 300 + i * 100);
+  }
+
+  // WHEN
+  HitPatternResult result = runHitPattern(pattern);
+
+  // THEN
+  TEST_ASSERT_EQUAL_UINT32(4, result.detectedCount);
+  TEST_ASSERT_EQUAL_UINT32(0, result.mergedCount);
+  TEST_ASSERT_EQUAL_UINT32(0, result.missedCount);
+  TEST_ASSERT_EQUAL_UINT32(0, result.extraCount);
+  TEST_ASSERT_TRUE(result.maxLatencyUs >= SCAN_TIME_US);
+}
+
+void test_hitPattern_virtualClockIsDeterministic() {
+  // GIVEN
+  addPads(2);
+  HitPattern pattern;
+  const pad_size_t padIndices[] = {0, 1};
+  pattern.addRoll(padIndices, 2, 0, 25, 8, 500);
+  pattern.addFlam(1, 50000, 8000, 200, 900);
+
+  // WHEN
+  HitPatternResult result1 = runHitPattern(pattern, 100);
+  HitPatternResult result2 = runHitPattern(pattern, 100);
+
+  // THEN
+  TEST_ASSERT_EQUAL_UINT32(pattern.getDurationUs() / 100, result1.updateCount);
+  TEST_ASSERT_EQUAL_STRING(result1.toString().c_str(), result2.toString().c_str());
+}
+
+void test_hitPattern_rollInMaskTimeIsMerged() {
+  // GIVEN
+  addPads(1);
+  HitPattern pattern;
+  const pad_size_t padIndices[] = {0};
+  pattern.addRoll(padIndices, 1, 0, 50, 6, 600); // every 20ms, so every second hit is in the mask time
+
+  // WHEN
+  HitPatternResult result = runHitPattern(pattern);
+
+  // THEN
+  TEST_ASSERT_EQUAL_UINT32(3, result.detectedCount);
+  TEST_ASSERT_EQUAL_UINT32(3, result.mergedCount);
+  TEST_ASSERT_EQUAL_UINT32(0, result.missedCount);
+}
+
+void test_hitPattern_hitInMaskTimeOfOtherPad() {
+  // GIVEN
+  addPads(2);
+  HitPattern pattern;
+  pattern.addHit(0, 0, 800);
+  pattern.addHit(1, MASK_TIME_MS * 1000 / 2, 400);
+
+  // WHEN
+  HitPatternResult result = runHitPattern(pattern);
+
+  // THEN
+  TEST_ASSERT_EQUAL_UINT32(2, result.detectedCount);
+}
+
+void benchmark_hitPattern_rolls() {
+  disableVirtualClock(); // throughput of the host
+  const pad_size_t padCount = 4;
+  addPads(padCount);
+  const pad_size_t padIndices[padCount] = {0, 1, 2, 3};
+
+  for (uint16_t rateHz : {10, 20, 30, 40}) {
+    HitPattern pattern;
+    pattern.addRoll(padIndices, padCount, 0, rateHz, 10, 600);
+    HitPatternResult result = runHitPattern(pattern);
+
+    String message = String("roll ") + rateHz + " Hz on " + padCount + " pads: " + result.toString();
+    TEST_MESSAGE(message.c_str());
+  }
+}
+
+void benchmark_hitPattern_flams() {
+  disableVirtualClock(); // throughput of the host
+  addPads(1);
+
+  for (time_us_t spacingUs : {5000, 15000, 25000, 35000}) {
+    HitPattern pattern;
+    for (int i = 0; i < 4; ++i) {
+      pattern.addFlam(0, i * 100000, spacingUs, 300, 800);
+    }
+    HitPatternResult result = runHitPattern(pattern);
+
+    String message = String("flam ") + (int) (spacingUs / 1000) + " ms: " + result.toString();
+    TEST_MESSAGE(message.c_str());
+  }
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_hitPattern_singleHits);
+  RUN_TEST(test_hitPattern_virtualClockIsDeterministic);
+  RUN_TEST(test_hitPattern_rollInMaskTimeIsMerged);
+  RUN_TEST(test_hitPattern_hitInMaskTimeOfOtherPad);
+  RUN_TEST(benchmark_hitPattern_rolls);
+  RUN_TEST(benchmark_hitPattern_flams);
+  return UNITY_END();
+}
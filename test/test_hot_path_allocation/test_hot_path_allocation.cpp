@@ -0,0 +1,235 @@
+#include "adc_trace_replay.h"
+#include "hit_pattern.h"
+#include "sensing_core.h"
+#include "../support/test_kit_builder.h"
+
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include <unity.h>
+
+// Counts the heap allocations while a flag is set. The new operators are replaced on all platforms,
+// malloc() (e.g. used by String) can only be interposed with glibc.
+
+static std::atomic<bool> isCountingAllocations = false;
+static std::atomic<uint32_t> allocationCount = 0;
+
+static void countAllocation() {
+  if (isCountingAllocations.load(std::memory_order_relaxed)) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+#ifdef __GLIBC__
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+
+extern "C" void* malloc(size_t size) {
+  countAllocation();
+  return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+  countAllocation();
+  return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+  countAllocation();
+  return __libc_realloc(ptr, size);
+}
+#endif
+
+void* operator new(size_t size) {
+  countAllocation();
+  void* ptr = malloc(size ? size : 1);
+  if (!ptr) {
+    abort();
+  }
+  return ptr;
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+  free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+  free(ptr);
+}
+
+#define MUX_ANALOG_IN_PIN 26
+#define UPDATE_PERIOD_US 100
+
+enum TestPad {
+  SNARE, // head and rim piezo
+  RIDE, // bow piezo and edge switch
+  HIHAT_PEDAL,
+  HIHAT
+};
+
+// uses all features of the hit path: both MIDI note modes, hihat, choke, prediction and the monitor
+static void setupKit() {
+  TestKitBuilder kit(drumKit);
+  DrumPad& snare = kit.addSnare(0, 1);
+  snare.getSettings().predictionEnabled = true;
+  kit.getMappings(snare).noteMain = 38;
+  kit.getMappings(snare).noteRim = 40;
+
+  DrumPad& ride = kit.addRide(2, 3);
+  kit.getMappings(ride).noteMain = 51;
+  kit.getMappings(ride).noteRim = 59;
+
+  DrumPad& pedal = kit.addHihatPedal(4);
+  kit.getMappings(pedal).noteMain = 44;
+
+  DrumPad& hihat = kit.addHihat(5, pedal);
+  kit.getMappings(hihat).noteMain = 46;
+
+  drumKit.setGateTime(20);
+  drumKit.init();
+
+  drumKit.getMonitor().setMonitoredPad(snare);
+  drumKit.getMonitor().setTriggeredByAllPads(true);
+}
+
+static HitPattern createPattern() {
+  HitPattern pattern;
+  const pad_size_t pads[] = {SNARE, RIDE, HIHAT};
+  pattern.addRoll(pads, 3, 0, 20, 10, 500);
+  pattern.addFlam(SNARE, 600000, 10000, 200, 900);
+  return pattern;
+}
+
+static void setInputs(const HitPattern& pattern, time_us_t timeUs) {
+  setPadPinValue(*drumKit.getPad(SNARE), 0, pattern.getValue(SNARE, timeUs));
+  setPadPinValue(*drumKit.getPad(SNARE), 1, pattern.getValue(SNARE, timeUs) / 2);
+  setPadPinValue(*drumKit.getPad(RIDE), 0, pattern.getValue(RIDE, timeUs));
+  setPadPinValue(*drumKit.getPad(RIDE), 1, (timeUs / 100000) % 3 == 2 ? 800 : 0); // choke
+  setPadPinValue(*drumKit.getPad(HIHAT_PEDAL), 0, (timeUs / 1000) % MAX_SENSOR_VALUE); // moving
+  setPadPinValue(*drumKit.getPad(HIHAT), 0, pattern.getValue(HIHAT, timeUs));
+}
+
+static void countUpdateAllocations() {
+  isCountingAllocations = true;
+  drumKit.updateDrums();
+  isCountingAllocations = false;
+}
+
+// the output is forwarded by the main core, it is not part of the hit path
+static void forwardOutput(std::vector<uint8_t>* trace = nullptr) {
+  SensingCore::forwardOutput();
+  while (const AdcTraceChunk* chunk = AdcTraceCapture::peekQueuedChunk()) {
+    if (trace) {
+      const size_t magicSize = strlen(ADC_TRACE_DATA_MAGIC);
+      trace->insert(trace->end(), chunk->data + magicSize, chunk->data + chunk->size);
+    }
+    AdcTraceCapture::popQueuedChunk();
+  }
+}
+
+void setUp(void) {
+  drumKit.reset();
+  DrumIO::setup(false);
+
+  DrumMux mux;
+  mux.initHC4067(11, 12, 13, 14, MUX_ANALOG_IN_PIN, 10);
+  drumKit.addMux(mux);
+  setupKit();
+
+  allocationCount = 0;
+  enableVirtualClock(1000000);
+}
+
+void tearDown(void) {
+  disableVirtualClock();
+}
+
+void test_hotPathAllocation_liveInput() {
+  // GIVEN
+  const HitPattern pattern = createPattern();
+  uint32_t hitCount = 0;
+
+  // WHEN
+  for (time_us_t timeUs = 0; timeUs < pattern.getDurationUs(); timeUs += UPDATE_PERIOD_US) {
+    setInputs(pattern, timeUs);
+    countUpdateAllocations();
+    hitCount += drumKit.getPad(SNARE)->isHit();
+    forwardOutput();
+    advanceVirtualClock(UPDATE_PERIOD_US);
+  }
+
+  // THEN
+  TEST_ASSERT_GREATER_THAN(0, hitCount);
+  TEST_ASSERT_EQUAL_UINT32(0, allocationCount.load());
+}
+
+void test_hotPathAllocation_traceCaptureAndReplay() {
+  // GIVEN
+  const HitPattern pattern = createPattern();
+  uint8_t header[sizeof(AdcTraceHeader) + MAX_SCAN_SLOTS * sizeof(AdcTraceSlotInfo)];
+  const size_t headerSize = drumKit.getAdcTraceCapture().start(drumKit, 0, header, sizeof(header));
+  std::vector<uint8_t> trace(header, header + headerSize);
+
+  for (time_us_t timeUs = 0; timeUs < pattern.getDurationUs(); timeUs += UPDATE_PERIOD_US) {
+    setInputs(pattern, timeUs);
+    countUpdateAllocations();
+    forwardOutput(&trace);
+    advanceVirtualClock(UPDATE_PERIOD_US);
+  }
+  drumKit.getAdcTraceCapture().stop();
+  forwardOutput(&trace);
+  TEST_ASSERT_EQUAL_UINT32(0, allocationCount.load());
+
+  // WHEN
+  AdcTraceReplay replay;
+  TEST_ASSERT_TRUE(replay.load(trace.data(), trace.size()));
+  while (replay.nextFrame()) {
+    countUpdateAllocations();
+    forwardOutput();
+  }
+
+  // THEN
+  TEST_ASSERT_EQUAL_UINT32(0, allocationCount.load());
+}
+
+void test_hotPathAllocation_detectorCountsAllocations() {
+  // GIVEN
+  isCountingAllocations = true;
+
+  // WHEN
+  int* value = new int(1);
+  String text = String("allocated ") + *value + " time";
+
+  // THEN
+  isCountingAllocations = false;
+  delete value;
+#ifdef __GLIBC__
+  TEST_ASSERT_GREATER_OR_EQUAL(2, allocationCount.load());
+#else
+  TEST_ASSERT_GREATER_OR_EQUAL(1, allocationCount.load());
+#endif
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_hotPathAllocation_detectorCountsAllocations);
+  RUN_TEST(test_hotPathAllocation_liveInput);
+  RUN_TEST(test_hotPathAllocation_traceCaptureAndReplay);
+  return UNITY_END();
+}
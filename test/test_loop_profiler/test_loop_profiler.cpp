@@ -0,0 +1,116 @@
+#include "loop_profiler.h"
+#include "simulation.h"
+
+#include <unity.h>
+
+#define MUX_ANALOG_IN_PIN 26
+
+void setUp(void) {
+  drumKit.reset();
+  DrumIO::setup(false);
+
+  DrumMux mux;
+  mux.initHC4067(11, 12, 13, 14, MUX_ANALOG_IN_PIN, 10);
+  drumKit.addMux(mux);
+  drumKit.init();
+
+  loopProfiler.reset();
+  enableVirtualClock(1000000);
+}
+
+void tearDown(void) {
+  disableVirtualClock();
+}
+
+void test_costHistogram_bucketBounds() {
+  for (uint32_t value = 0; value < 100000; value += 7) {
+    // GIVEN
+    uint8_t bucket = CostHistogram::getBucketIndex(value);
+
+    // THEN
+    TEST_ASSERT_LESS_THAN(COST_HISTOGRAM_BUCKET_COUNT, bucket);
+    TEST_ASSERT_GREATER_OR_EQUAL(value, CostHistogram::getBucketUpperBoundUs(bucket));
+    TEST_ASSERT_LESS_OR_EQUAL(value + value / 4, CostHistogram::getBucketUpperBoundUs(bucket)); // max. error 25%
+    if (bucket > 0) {
+      TEST_ASSERT_LESS_THAN(value, CostHistogram::getBucketUpperBoundUs(bucket - 1));
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT8(COST_HISTOGRAM_BUCKET_COUNT - 1, CostHistogram::getBucketIndex(UINT32_MAX));
+}
+
+void test_costHistogram_statistics() {
+  // GIVEN
+  CostHistogram histogram;
+
+  // WHEN
+  for (int i = 0; i < 990; ++i) {
+    histogram.record(10);
+  }
+  for (int i = 0; i < 10; ++i) {
+    histogram.record(1000 + i);
+  }
+
+  // THEN
+  TEST_ASSERT_EQUAL_UINT32(1000, histogram.getCount());
+  TEST_ASSERT_EQUAL_UINT32(10, histogram.getMinUs());
+  TEST_ASSERT_EQUAL_UINT32(1009, histogram.getMaxUs());
+  TEST_ASSERT_EQUAL_UINT32((990 * 10 + 10 * 1000 + 45) / 1000, histogram.getAvgUs());
+  TEST_ASSERT_EQUAL_UINT32(10, histogram.getPercentileUs(99));
+  TEST_ASSERT_UINT_WITHIN(1009 / 4, 1009, histogram.getPercentileUs(100));
+  TEST_ASSERT_LESS_OR_EQUAL(1009, histogram.getPercentileUs(100));
+
+  // WHEN
+  histogram.reset();
+
+  // THEN
+  TEST_ASSERT_EQUAL_UINT32(0, histogram.getCount());
+  TEST_ASSERT_EQUAL_UINT32(0, histogram.getMinUs());
+  TEST_ASSERT_EQUAL_UINT32(0, histogram.getPercentileUs(99));
+}
+
+void test_loopProfiler_sensingPeriod() {
+  // GIVEN
+  const time_us_t periodsUs[] = {100, 100, 250, 100};
+
+  // WHEN
+  drumKit.updateDrums();
+  for (time_us_t periodUs : periodsUs) {
+    advanceVirtualClock(periodUs);
+    drumKit.updateDrums();
+  }
+
+  // THEN
+  const CostHistogram& sensingPeriod = loopProfiler.getSensingPeriod();
+  TEST_ASSERT_EQUAL_UINT32(4, sensingPeriod.getCount());
+  TEST_ASSERT_EQUAL_UINT32(100, sensingPeriod.getMinUs());
+  TEST_ASSERT_EQUAL_UINT32(250, sensingPeriod.getMaxUs());
+  TEST_ASSERT_EQUAL_UINT32(5, loopProfiler.getPhaseCost(LoopPhase::MuxRead).getCount());
+  TEST_ASSERT_EQUAL_UINT32(5, loopProfiler.getPhaseCost(LoopPhase::PadEvaluation).getCount());
+  TEST_ASSERT_EQUAL_UINT32(5, loopProfiler.getPhaseCost(LoopPhase::Monitor).getCount());
+  TEST_ASSERT_EQUAL_UINT32(0, loopProfiler.getPhaseCost(LoopPhase::Network).getCount());
+}
+
+void test_loopProfiler_phaseCost() {
+  // GIVEN
+  LOOP_PROFILER_START(micros());
+
+  // WHEN
+  advanceVirtualClock(30);
+  LOOP_PROFILER_END_PHASE(LoopPhase::Network);
+  advanceVirtualClock(500);
+  LOOP_PROFILER_END_PHASE(LoopPhase::UsbDevice);
+
+  // THEN
+  TEST_ASSERT_EQUAL_UINT32(30, loopProfiler.getPhaseCost(LoopPhase::Network).getMaxUs());
+  TEST_ASSERT_EQUAL_UINT32(500, loopProfiler.getPhaseCost(LoopPhase::UsbDevice).getMaxUs());
+  TEST_ASSERT_TRUE(loopProfiler.toString().indexOf("UsbDevice") >= 0);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_costHistogram_bucketBounds);
+  RUN_TEST(test_costHistogram_statistics);
+  RUN_TEST(test_loopProfiler_sensingPeriod);
+  RUN_TEST(test_loopProfiler_phaseCost);
+  return UNITY_END();
+}
@@ -0,0 +1,451 @@
+#include "midi_priority_queue.h"
+#include "midi_transport.h"
+#include "midi_transport_queue.h"
+
+#include <unity.h>
+
+#include <vector>
+
+MidiPriorityQueue queue;
+
+void setUp(void) {
+  queue = MidiPriorityQueue();
+  enableVirtualClock(1000000);
+}
+
+void tearDown(void) {
+  disableVirtualClock();
+}
+
+static MidiMessage noteOn(uint8_t note) {
+  return {MidiMessageType::NoteOn, note, 100, 10};
+}
+
+static MidiMessage noteOff(uint8_t note) {
+  return {MidiMessageType::NoteOff, note, 0, 10};
+}
+
+static MidiMessage choke(uint8_t note, uint8_t pressure) {
+  return {MidiMessageType::PolyAfterTouch, note, pressure, 10};
+}
+
+static MidiMessage controlChange(uint8_t controlNumber, uint8_t value) {
+  return {MidiMessageType::ControlChange, controlNumber, value, 10};
+}
+
+static std::vector<MidiMessage> popAll() {
+  std::vector<MidiMessage> messages;
+  MidiMessage message;
+  while (queue.pop(message)) {
+    messages.push_back(message);
+  }
+  return messages;
+}
+
+static void assertMessage(MidiMessageType type, uint8_t data1, uint8_t data2, const MidiMessage& message) {
+  TEST_ASSERT_EQUAL((int) type, (int) message.type);
+  TEST_ASSERT_EQUAL_UINT8(data1, message.data1);
+  TEST_ASSERT_EQUAL_UINT8(data2, message.data2);
+}
+
+void test_messages_are_sent_by_priority() {
+  // GIVEN
+  queue.push(controlChange(4, 90));
+  queue.push(noteOff(36));
+  queue.push(choke(49, 127));
+  queue.push(noteOn(38));
+
+  // WHEN
+  std::vector<MidiMessage> messages = popAll();
+
+  // THEN
+  TEST_ASSERT_EQUAL(4, messages.size());
+  assertMessage(MidiMessageType::NoteOn, 38, 100, messages[0]);
+  assertMessage(MidiMessageType::PolyAfterTouch, 49, 127, messages[1]);
+  assertMessage(MidiMessageType::NoteOff, 36, 0, messages[2]);
+  assertMessage(MidiMessageType::ControlChange, 4, 90, messages[3]);
+  TEST_ASSERT_TRUE(queue.isEmpty());
+}
+
+void test_same_priority_keeps_order() {
+  // GIVEN
+  queue.push(noteOn(36));
+  queue.push(noteOn(42));
+  queue.push(noteOn(38));
+
+  // WHEN
+  std::vector<MidiMessage> messages = popAll();
+
+  // THEN
+  TEST_ASSERT_EQUAL(3, messages.size());
+  TEST_ASSERT_EQUAL_UINT8(36, messages[0].data1);
+  TEST_ASSERT_EQUAL_UINT8(42, messages[1].data1);
+  TEST_ASSERT_EQUAL_UINT8(38, messages[2].data1);
+}
+
+void test_controlChanges_of_same_controller_are_coalesced() {
+  // GIVEN
+  for (uint8_t value = 0; value <= 100; value += 10) {
+    queue.push(controlChange(4, value));
+  }
+  queue.push(controlChange(7, 127));
+
+  // WHEN
+  std::vector<MidiMessage> messages = popAll();
+
+  // THEN
+  TEST_ASSERT_EQUAL(2, messages.size());
+  assertMessage(MidiMessageType::ControlChange, 4, 100, messages[0]);
+  assertMessage(MidiMessageType::ControlChange, 7, 127, messages[1]);
+  TEST_ASSERT_EQUAL(10, queue.getCoalescedCount());
+}
+
+void test_retrigger_sends_end_of_note_first() {
+  // GIVEN
+  queue.push(noteOn(49));
+  queue.push(noteOff(49));
+  queue.push(choke(49, 127));
+  queue.push(choke(49, 0));
+  queue.push(noteOff(51));
+
+  // WHEN
+  queue.push(noteOn(49));
+  std::vector<MidiMessage> messages = popAll();
+
+  // THEN: the end of the note keeps its order
+  TEST_ASSERT_EQUAL(6, messages.size());
+  assertMessage(MidiMessageType::NoteOn, 49, 100, messages[0]);
+  assertMessage(MidiMessageType::NoteOff, 49, 0, messages[1]);
+  assertMessage(MidiMessageType::PolyAfterTouch, 49, 127, messages[2]);
+  assertMessage(MidiMessageType::PolyAfterTouch, 49, 0, messages[3]);
+  assertMessage(MidiMessageType::NoteOn, 49, 100, messages[4]);
+  assertMessage(MidiMessageType::NoteOff, 51, 0, messages[5]);
+}
+
+void test_full_queue_drops_noteOn_but_not_end_of_note() {
+  // GIVEN
+  queue.push(controlChange(4, 90));
+  for (int i = 1; i < MIDI_PRIORITY_QUEUE_SIZE; ++i) {
+    queue.push(noteOn(i));
+  }
+
+  // WHEN
+  bool noteOnQueued = queue.push(noteOn(100));
+  bool noteOffQueued = queue.push(noteOff(1));
+  bool chokeQueued = queue.push(choke(2, 127));
+
+  // THEN: the CC and then the oldest NoteOn made room for the end of the notes
+  TEST_ASSERT_FALSE(noteOnQueued);
+  TEST_ASSERT_TRUE(noteOffQueued);
+  TEST_ASSERT_TRUE(chokeQueued);
+  TEST_ASSERT_EQUAL(3, queue.getDroppedCount());
+  TEST_ASSERT_EQUAL(MIDI_PRIORITY_QUEUE_SIZE, queue.getSize());
+  TEST_ASSERT_EQUAL(MIDI_PRIORITY_QUEUE_SIZE, queue.getMaxSize());
+  std::vector<MidiMessage> messages = popAll();
+  assertMessage(MidiMessageType::NoteOn, 2, 100, messages[0]);
+  assertMessage(MidiMessageType::PolyAfterTouch, 2, 127, messages[MIDI_PRIORITY_QUEUE_SIZE - 2]);
+  assertMessage(MidiMessageType::NoteOff, 1, 0, messages[MIDI_PRIORITY_QUEUE_SIZE - 1]);
+}
+
+void test_queue_full_of_end_of_note_rejects_end_of_note() {
+  // GIVEN
+  for (int i = 0; i < MIDI_PRIORITY_QUEUE_SIZE; ++i) {
+    queue.push(noteOff(i));
+  }
+
+  // WHEN
+  bool queued = queue.push(noteOff(100));
+
+  // THEN: no message was dropped, the caller has to send it
+  TEST_ASSERT_FALSE(queued);
+  TEST_ASSERT_EQUAL(0, queue.getDroppedCount());
+  TEST_ASSERT_EQUAL(MIDI_PRIORITY_QUEUE_SIZE, queue.getSize());
+}
+
+class MidiTransport_SlowRecorder : public MidiTransport {
+public:
+  void start(MidiOutputMode mode) override { isStarted = true; }
+  void stop() override { isStarted = false; }
+  void sendNoteOn(uint8_t inNoteNumber, uint8_t inVelocity, midi_channel_t inChannel) override { record(0x90, inNoteNumber); }
+  void sendNoteOff(uint8_t inNoteNumber, uint8_t inVelocity, midi_channel_t inChannel) override { record(0x80, inNoteNumber); }
+  void sendAfterTouch(uint8_t inPressure, midi_channel_t inChannel) override {}
+  void sendAfterTouch(uint8_t inNoteNumber, uint8_t inPressure, midi_channel_t inChannel) override {}
+  void sendControlChange(uint8_t inControlNumber, uint8_t inControlValue, midi_channel_t inChannel) override { record(0xB0, inControlValue); }
+
+  size_t getWriteCapacity() override { return capacity; }
+
+  void record(uint8_t status, uint8_t data) {
+    messages.push_back({status, data});
+    capacity -= MIDI_MAX_MESSAGE_SIZE;
+  }
+
+  bool isStarted = false;
+  size_t capacity = 0;
+  std::vector<std::pair<uint8_t, uint8_t>> messages;
+};
+
+void test_multiplexer_sends_only_as_much_as_transport_can_take() {
+  // GIVEN
+  MidiTransport_SlowRecorder transport;
+  MidiTransportInstances instances = {.usbDevice = &transport};
+  MidiTransportMultiplexer multiplexer(instances);
+  multiplexer.start();
+  for (uint8_t value = 0; value < 100; ++value) { // pedal moved while the transport was busy
+    multiplexer.sendControlChange(4, value, 10);
+  }
+  multiplexer.sendNoteOn(46, 100, 10);
+  multiplexer.sendNoteOff(46, 0, 10);
+
+  // WHEN
+  multiplexer.flush();
+
+  // THEN
+  TEST_ASSERT_EQUAL(0, transport.messages.size());
+  TEST_ASSERT_EQUAL(3, multiplexer.getOutputQueue(0).getSize());
+
+  // WHEN
+  transport.capacity = 2 * MIDI_MAX_MESSAGE_SIZE;
+  multiplexer.flush();
+
+  // THEN
+  TEST_ASSERT_EQUAL(2, transport.messages.size());
+  TEST_ASSERT_EQUAL_UINT8(0x90, transport.messages[0].first);
+  TEST_ASSERT_EQUAL_UINT8(0x80, transport.messages[1].first);
+
+  // WHEN
+  transport.capacity = SIZE_MAX;
+  multiplexer.update();
+
+  // THEN
+  TEST_ASSERT_EQUAL(3, transport.messages.size());
+  TEST_ASSERT_EQUAL_UINT8(0xB0, transport.messages[2].first);
+  TEST_ASSERT_EQUAL_UINT8(99, transport.messages[2].second);
+  TEST_ASSERT_TRUE(multiplexer.getOutputQueue(0).isEmpty());
+}
+
+void test_multiplexer_keeps_order_if_transport_can_take_all() {
+  // GIVEN
+  MidiTransport_SlowRecorder transport;
+  transport.capacity = SIZE_MAX;
+  MidiTransportInstances instances = {.usbDevice = &transport};
+  MidiTransportMultiplexer multiplexer(instances);
+  multiplexer.start();
+
+  // WHEN: the hi-hat is hit with the pedal opened, then the pedal is closed
+  multiplexer.sendControlChange(4, 10, 10);
+  multiplexer.sendControlChange(4, 20, 10);
+  multiplexer.sendNoteOn(46, 100, 10);
+  multiplexer.sendControlChange(4, 30, 10);
+  multiplexer.sendControlChange(4, 127, 10);
+  multiplexer.flush();
+
+  // THEN: the pedal position of the hit is sent before the NoteOn, the last position after it
+  TEST_ASSERT_EQUAL(3, transport.messages.size());
+  TEST_ASSERT_EQUAL_UINT8(0xB0, transport.messages[0].first);
+  TEST_ASSERT_EQUAL_UINT8(20, transport.messages[0].second);
+  TEST_ASSERT_EQUAL_UINT8(0x90, transport.messages[1].first);
+  TEST_ASSERT_EQUAL_UINT8(0xB0, transport.messages[2].first);
+  TEST_ASSERT_EQUAL_UINT8(127, transport.messages[2].second);
+}
+
+void test_multiplexer_fanOut_stalled_output_does_not_delay_others() {
+  // GIVEN
+  MidiTransport_SlowRecorder usbDevice, serialDin, bleServer;
+  usbDevice.capacity = SIZE_MAX;
+  bleServer.capacity = 0; // stalled
+  serialDin.capacity = SIZE_MAX;
+  MidiTransportInstances instances = {.usbDevice = &usbDevice, .serialDin = &serialDin, .bleServer = &bleServer};
+  MidiTransportMultiplexer multiplexer(instances);
+  multiplexer.setFanOutModes({MidiOutputMode::SerialDin, MidiOutputMode::BleServer});
+  multiplexer.start();
+
+  // WHEN
+  multiplexer.sendNoteOn(38, 100, 10);
+  multiplexer.sendNoteOff(38, 0, 10);
+  multiplexer.flush();
+
+  // THEN
+  TEST_ASSERT_TRUE(usbDevice.isStarted && serialDin.isStarted && bleServer.isStarted);
+  TEST_ASSERT_EQUAL(2, usbDevice.messages.size());
+  TEST_ASSERT_EQUAL(2, serialDin.messages.size());
+  TEST_ASSERT_EQUAL(0, bleServer.messages.size());
+  TEST_ASSERT_EQUAL(3, multiplexer.getOutputCount());
+  TEST_ASSERT_EQUAL(2, multiplexer.getOutputQueue(2).getSize());
+}
+
+void test_multiplexer_fanOut_ignores_selected_and_unsupported_modes() {
+  // GIVEN
+  MidiTransport_SlowRecorder usbDevice, serialDin, gamepad;
+  MidiTransportInstances instances = {.usbDevice = &usbDevice, .serialDin = &serialDin, .gamepad = &gamepad};
+  MidiTransportMultiplexer multiplexer(instances);
+  multiplexer.start();
+
+  // WHEN
+  multiplexer.setFanOutModes({MidiOutputMode::UsbDevice, MidiOutputMode::GamepadUsb, MidiOutputMode::BleClient,
+    MidiOutputMode::SerialDin, MidiOutputMode::SerialDin});
+
+  // THEN
+  std::vector<MidiOutputMode> fanOutModes = multiplexer.getFanOutModes();
+  TEST_ASSERT_EQUAL(1, fanOutModes.size());
+  TEST_ASSERT_EQUAL((int) MidiOutputMode::SerialDin, (int) fanOutModes[0]);
+  TEST_ASSERT_TRUE(serialDin.isStarted);
+  TEST_ASSERT_FALSE(gamepad.isStarted);
+}
+
+void test_multiplexer_fanOut_allows_only_one_ble_role() {
+  // GIVEN
+  MidiTransport_SlowRecorder usbDevice, bleClient, bleServer;
+  MidiTransportInstances instances = {.usbDevice = &usbDevice, .bleClient = &bleClient, .bleServer = &bleServer};
+  MidiTransportMultiplexer multiplexer(instances);
+  multiplexer.start();
+
+  // WHEN
+  multiplexer.setFanOutModes({MidiOutputMode::BleServer, MidiOutputMode::BleClient});
+
+  // THEN
+  TEST_ASSERT_EQUAL(1, multiplexer.getFanOutModes().size());
+  TEST_ASSERT_TRUE(bleServer.isStarted);
+  TEST_ASSERT_FALSE(bleClient.isStarted);
+
+  // WHEN: the other BLE role is selected
+  multiplexer.setOutputMode(MidiOutputMode::BleClient);
+
+  // THEN
+  TEST_ASSERT_TRUE(multiplexer.getFanOutModes().empty());
+  TEST_ASSERT_FALSE(bleServer.isStarted);
+  TEST_ASSERT_TRUE(bleClient.isStarted);
+  std::vector<MidiOutputMode> supportedModes = multiplexer.getSupportedFanOutModes();
+  TEST_ASSERT_EQUAL(1, supportedModes.size());
+  TEST_ASSERT_EQUAL((int) MidiOutputMode::UsbDevice, (int) supportedModes[0]);
+}
+
+void test_multiplexer_selecting_fanOut_mode_removes_it_from_fanOut() {
+  // GIVEN
+  MidiTransport_SlowRecorder usbDevice, serialDin;
+  MidiTransportInstances instances = {.usbDevice = &usbDevice, .serialDin = &serialDin};
+  MidiTransportMultiplexer multiplexer(instances);
+  multiplexer.setFanOutModes({MidiOutputMode::SerialDin});
+  multiplexer.start();
+
+  // WHEN
+  multiplexer.setOutputMode(MidiOutputMode::SerialDin);
+
+  // THEN
+  TEST_ASSERT_TRUE(multiplexer.getFanOutModes().empty());
+  TEST_ASSERT_FALSE(usbDevice.isStarted);
+  TEST_ASSERT_TRUE(serialDin.isStarted);
+  TEST_ASSERT_EQUAL((int) MidiOutputMode::SerialDin, (int) multiplexer.getOutputMode(0));
+}
+
+void test_multiplexer_constant_latency_sends_hits_at_fixed_time_after_hit() {
+  // GIVEN
+  MidiTransport_SlowRecorder transport;
+  transport.capacity = SIZE_MAX;
+  MidiTransportInstances instances = {.usbDevice = &transport};
+  MidiTransportMultiplexer multiplexer(instances);
+  multiplexer.setConstantLatency(5000);
+  multiplexer.start();
+
+  // WHEN: two hits that were detected at different positions of the scan
+  const time_us_t nowUs = micros();
+  multiplexer.sendMessage({MidiMessageType::NoteOn, 36, 100, 10, nowUs - 3000});
+  multiplexer.sendMessage({MidiMessageType::NoteOn, 38, 100, 10, nowUs - 1000});
+  multiplexer.flush();
+
+  // THEN
+  TEST_ASSERT_EQUAL(0, transport.messages.size());
+
+  // WHEN
+  advanceVirtualClock(2000);
+  multiplexer.update();
+
+  // THEN
+  TEST_ASSERT_EQUAL(1, transport.messages.size());
+  TEST_ASSERT_EQUAL_UINT8(36, transport.messages[0].second);
+
+  // WHEN
+  advanceVirtualClock(2000);
+  multiplexer.update();
+
+  // THEN
+  TEST_ASSERT_EQUAL(2, transport.messages.size());
+  TEST_ASSERT_EQUAL_UINT8(38, transport.messages[1].second);
+  const CostHistogram& latency = multiplexer.getHitLatency();
+  TEST_ASSERT_EQUAL(2, latency.getCount());
+  TEST_ASSERT_EQUAL(5000, latency.getMinUs());
+  TEST_ASSERT_EQUAL(5000, latency.getMaxUs()); // no jitter
+}
+
+void test_multiplexer_constant_latency_does_not_hold_back_due_messages() {
+  // GIVEN
+  MidiTransport_SlowRecorder transport;
+  transport.capacity = SIZE_MAX;
+  MidiTransportInstances instances = {.usbDevice = &transport};
+  MidiTransportMultiplexer multiplexer(instances);
+  multiplexer.setConstantLatency(5000);
+  multiplexer.start();
+
+  // WHEN: a new hit that is not due yet and the end of a note that is due
+  const time_us_t nowUs = micros();
+  multiplexer.sendMessage({MidiMessageType::NoteOn, 38, 100, 10, nowUs - 1000});
+  multiplexer.sendMessage({MidiMessageType::NoteOff, 36, 0, 10, nowUs - 6000});
+  multiplexer.flush();
+
+  // THEN
+  TEST_ASSERT_EQUAL(1, transport.messages.size());
+  TEST_ASSERT_EQUAL_UINT8(0x80, transport.messages[0].first);
+  TEST_ASSERT_EQUAL(1, multiplexer.getOutputQueue(0).getSize());
+}
+
+void test_multiplexer_constant_latency_is_clamped() {
+  // GIVEN
+  MidiTransportInstances instances = {};
+  MidiTransportMultiplexer multiplexer(instances);
+
+  // WHEN
+  multiplexer.setConstantLatency(MAX_MIDI_CONSTANT_LATENCY_US + 1);
+
+  // THEN
+  TEST_ASSERT_EQUAL(MAX_MIDI_CONSTANT_LATENCY_US, multiplexer.getConstantLatency());
+}
+
+void test_queue_forwards_hit_time() {
+  // GIVEN
+  MidiTransport_SlowRecorder transport;
+  transport.capacity = SIZE_MAX;
+  MidiTransportInstances instances = {.usbDevice = &transport};
+  MidiTransportMultiplexer multiplexer(instances);
+  multiplexer.start();
+  MidiTransport_Queue outputQueue;
+
+  // WHEN: the hit was detected 700us before it was evaluated
+  outputQueue.sendNoteOn(38, 100, 10, micros() - 700);
+  advanceVirtualClock(300);
+  outputQueue.forwardTo(multiplexer);
+  multiplexer.flush();
+
+  // THEN
+  TEST_ASSERT_EQUAL(1, transport.messages.size());
+  TEST_ASSERT_EQUAL(1000, multiplexer.getHitLatency().getMaxUs());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_messages_are_sent_by_priority);
+  RUN_TEST(test_same_priority_keeps_order);
+  RUN_TEST(test_controlChanges_of_same_controller_are_coalesced);
+  RUN_TEST(test_retrigger_sends_end_of_note_first);
+  RUN_TEST(test_full_queue_drops_noteOn_but_not_end_of_note);
+  RUN_TEST(test_queue_full_of_end_of_note_rejects_end_of_note);
+  RUN_TEST(test_multiplexer_sends_only_as_much_as_transport_can_take);
+  RUN_TEST(test_multiplexer_keeps_order_if_transport_can_take_all);
+  RUN_TEST(test_multiplexer_fanOut_stalled_output_does_not_delay_others);
+  RUN_TEST(test_multiplexer_fanOut_ignores_selected_and_unsupported_modes);
+  RUN_TEST(test_multiplexer_fanOut_allows_only_one_ble_role);
+  RUN_TEST(test_multiplexer_selecting_fanOut_mode_removes_it_from_fanOut);
+  RUN_TEST(test_multiplexer_constant_latency_sends_hits_at_fixed_time_after_hit);
+  RUN_TEST(test_multiplexer_constant_latency_does_not_hold_back_due_messages);
+  RUN_TEST(test_multiplexer_constant_latency_is_clamped);
+  RUN_TEST(test_queue_forwards_hit_time);
+  return UNITY_END();
+}
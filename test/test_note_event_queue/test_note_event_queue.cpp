@@ -1,13 +1,20 @@
 #include "note_event_queue.h"
+#include "note_off_scheduler.h"
 
+#include <Arduino.h>
 #include <unity.h>
 
+#include <vector>
+
 void fillQueue(NoteEventQueue& queue);
 
 NoteEventQueue queue;
 
+NoteOffScheduler scheduler;
+
 void setUp(void) {
   queue = NoteEventQueue();
+  scheduler = NoteOffScheduler();
 }
 
 void tearDown(void) {
@@ -138,6 +145,198 @@ void fillQueue(NoteEventQueue& queue) {
 }
 
 
+void test_scheduler_processExpired_sends_note_off_after_gate_time() {
+  // GIVEN
+  scheduler.scheduleNoteOff(60, 100, 20);
+  std::vector<midi_note_t> notesOff;
+  auto sendNoteOff = [&](midi_note_t note) { notesOff.push_back(note); };
+
+  // WHEN
+  scheduler.processExpired(119, sendNoteOff);
+
+  // THEN
+  TEST_ASSERT_TRUE(notesOff.empty());
+  TEST_ASSERT_TRUE(scheduler.isPending(60));
+
+  // WHEN
+  scheduler.processExpired(120, sendNoteOff);
+
+  // THEN
+  TEST_ASSERT_EQUAL(1, notesOff.size());
+  TEST_ASSERT_EQUAL_UINT8(60, notesOff[0]);
+  TEST_ASSERT_FALSE(scheduler.isPending(60));
+  TEST_ASSERT_EQUAL(0, scheduler.getPendingCount());
+}
+
+void test_scheduler_supports_gate_time_per_note() {
+  // GIVEN
+  scheduler.scheduleNoteOff(49, 100, 30000); // long crash
+  scheduler.scheduleNoteOff(38, 100, 50);
+  std::vector<midi_note_t> notesOff;
+  auto sendNoteOff = [&](midi_note_t note) { notesOff.push_back(note); };
+
+  // WHEN
+  for (time_ms_t timeMs = 101; timeMs <= 30099; ++timeMs) {
+    scheduler.processExpired(timeMs, sendNoteOff);
+  }
+
+  // THEN
+  TEST_ASSERT_EQUAL(1, notesOff.size());
+  TEST_ASSERT_EQUAL_UINT8(38, notesOff[0]);
+  TEST_ASSERT_TRUE(scheduler.isPending(49));
+
+  // WHEN
+  scheduler.processExpired(30100, sendNoteOff);
+
+  // THEN
+  TEST_ASSERT_EQUAL(2, notesOff.size());
+  TEST_ASSERT_EQUAL_UINT8(49, notesOff[1]);
+}
+
+void test_scheduler_keeps_order_of_notes_with_same_due_time() {
+  // GIVEN
+  scheduler.scheduleNoteOff(50, 100, 10);
+  scheduler.scheduleNoteOff(40, 100, 10);
+  scheduler.scheduleNoteOff(45, 100, 10);
+  std::vector<midi_note_t> notesOff;
+
+  // WHEN
+  scheduler.processExpired(200, [&](midi_note_t note) { notesOff.push_back(note); });
+
+  // THEN
+  TEST_ASSERT_EQUAL(3, notesOff.size());
+  TEST_ASSERT_EQUAL_UINT8(50, notesOff[0]);
+  TEST_ASSERT_EQUAL_UINT8(40, notesOff[1]);
+  TEST_ASSERT_EQUAL_UINT8(45, notesOff[2]);
+}
+
+void test_scheduler_reschedule_replaces_pending_note() {
+  // GIVEN
+  scheduler.scheduleNoteOff(60, 100, 20);
+
+  // WHEN
+  scheduler.scheduleNoteOff(60, 110, 20);
+
+  // THEN
+  TEST_ASSERT_EQUAL(1, scheduler.getPendingCount());
+  int noteOffCount = 0;
+  scheduler.processExpired(120, [&](midi_note_t) { ++noteOffCount; });
+  TEST_ASSERT_EQUAL(0, noteOffCount);
+  scheduler.processExpired(130, [&](midi_note_t) { ++noteOffCount; });
+  TEST_ASSERT_EQUAL(1, noteOffCount);
+}
+
+void test_scheduler_cancel() {
+  // GIVEN
+  scheduler.scheduleNoteOff(60, 100, 20);
+  scheduler.scheduleNoteOff(61, 100, 20);
+
+  // WHEN
+  bool cancelled = scheduler.cancel(60);
+
+  // THEN
+  TEST_ASSERT_TRUE(cancelled);
+  TEST_ASSERT_FALSE(scheduler.cancel(60));
+  TEST_ASSERT_EQUAL(1, scheduler.getPendingCount());
+  std::vector<midi_note_t> notesOff;
+  scheduler.processExpired(200, [&](midi_note_t note) { notesOff.push_back(note); });
+  TEST_ASSERT_EQUAL(1, notesOff.size());
+  TEST_ASSERT_EQUAL_UINT8(61, notesOff[0]);
+}
+
+void test_scheduler_holds_all_notes() {
+  // GIVEN
+  for (midi_note_t note = 0; note < MIDI_NOTE_COUNT; ++note) {
+    scheduler.scheduleNoteOff(note, 100 + note, 1000);
+  }
+  TEST_ASSERT_EQUAL(MIDI_NOTE_COUNT, scheduler.getPendingCount());
+  std::vector<midi_note_t> notesOff;
+
+  // WHEN
+  scheduler.processExpired(5000, [&](midi_note_t note) { notesOff.push_back(note); });
+
+  // THEN
+  TEST_ASSERT_EQUAL(MIDI_NOTE_COUNT, notesOff.size());
+  TEST_ASSERT_EQUAL(0, scheduler.getPendingCount());
+  TEST_ASSERT_EQUAL(MIDI_NOTE_COUNT, scheduler.getMaxPendingCount());
+}
+
+void test_scheduler_handles_wrap_around_of_time() {
+  // GIVEN
+  const time_ms_t startMs = (time_ms_t) UINT32_MAX - 5;
+  scheduler.processExpired(startMs, [](midi_note_t) {});
+  scheduler.scheduleNoteOff(60, startMs, 10);
+  int noteOffCount = 0;
+
+  // WHEN
+  scheduler.processExpired(startMs + 9, [&](midi_note_t) { ++noteOffCount; });
+  scheduler.processExpired(startMs + 10, [&](midi_note_t) { ++noteOffCount; });
+
+  // THEN
+  TEST_ASSERT_EQUAL(1, noteOffCount);
+}
+
+// a hit every 2ms on 64 notes with the max. gate time, as in fast cymbal work with long gate times
+#define BENCHMARK_DURATION_MS 200000
+#define BENCHMARK_NOTE_COUNT 64
+
+static midi_note_t nextBenchmarkNote(uint32_t& seed) {
+  seed = seed * 1664525 + 1013904223;
+  return 35 + (seed >> 24) % BENCHMARK_NOTE_COUNT;
+}
+
+void benchmark_noteEventQueue_vs_noteOffScheduler() {
+  const time_ms_t gateTimeMs = 30000;
+  uint32_t noteOffCount[2] = {0, 0};
+  uint32_t evictionCount = 0;
+  auto sendNoteOff = [&](midi_note_t) { ++noteOffCount[1]; };
+
+  // same handling as DrumKit did before the scheduler
+  uint32_t seed = 1;
+  time_us_t startUs = micros();
+  for (time_ms_t timeMs = 1; timeMs <= BENCHMARK_DURATION_MS; ++timeMs) {
+    if (timeMs % 2 == 0) {
+      midi_note_t note = nextBenchmarkNote(seed);
+      if (queue.removeNote(note)) {
+        ++noteOffCount[0];
+      }
+      if (queue.isFull()) {
+        ++evictionCount;
+        ++noteOffCount[0];
+        queue.removeOldestNote();
+      }
+      queue.addNote(note, timeMs);
+    }
+    while (!queue.isEmpty() && timeMs - queue.peekOldestNote().noteOnTimeMs >= gateTimeMs) {
+      ++noteOffCount[0];
+      queue.removeOldestNote();
+    }
+  }
+  const time_us_t queueDurationUs = micros() - startUs;
+
+  seed = 1;
+  startUs = micros();
+  for (time_ms_t timeMs = 1; timeMs <= BENCHMARK_DURATION_MS; ++timeMs) {
+    if (timeMs % 2 == 0) {
+      midi_note_t note = nextBenchmarkNote(seed);
+      if (scheduler.cancel(note)) {
+        ++noteOffCount[1];
+      }
+      scheduler.scheduleNoteOff(note, timeMs, gateTimeMs);
+    }
+    scheduler.processExpired(timeMs, sendNoteOff);
+  }
+  const time_us_t schedulerDurationUs = micros() - startUs;
+
+  String message = String("NoteEventQueue: ") + (uint32_t) queueDurationUs + " us (" + evictionCount + " evictions, "
+    + noteOffCount[0] + " NoteOffs)";
+  TEST_MESSAGE(message.c_str());
+  message = String("NoteOffScheduler: ") + (uint32_t) schedulerDurationUs + " us (max. " + scheduler.getMaxPendingCount()
+    + " pending notes, " + noteOffCount[1] + " NoteOffs)";
+  TEST_MESSAGE(message.c_str());
+  TEST_ASSERT_LESS_OR_EQUAL(BENCHMARK_NOTE_COUNT, scheduler.getMaxPendingCount());
+}
+
 int main(int argc, char** argv) {
   UNITY_BEGIN();
   RUN_TEST(test_add_resets_isEmpty);
@@ -149,5 +348,13 @@ int main(int argc, char** argv) {
   RUN_TEST(test_remove_last_element_of_full_queue_does_not_crash);
   RUN_TEST(test_removeNote_removes_existing_note);
   RUN_TEST(test_removeNote_returns_false_if_note_does_not_exist);
+  RUN_TEST(test_scheduler_processExpired_sends_note_off_after_gate_time);
+  RUN_TEST(test_scheduler_supports_gate_time_per_note);
+  RUN_TEST(test_scheduler_keeps_order_of_notes_with_same_due_time);
+  RUN_TEST(test_scheduler_reschedule_replaces_pending_note);
+  RUN_TEST(test_scheduler_cancel);
+  RUN_TEST(test_scheduler_holds_all_notes);
+  RUN_TEST(test_scheduler_handles_wrap_around_of_time);
+  RUN_TEST(benchmark_noteEventQueue_vs_noteOffScheduler);
   return UNITY_END();
 }
@@ -0,0 +1,227 @@
+#include "simulation.h"
+#include "../support/test_kit_builder.h"
+
+#include <unity.h>
+
+#define MUX_ANALOG_IN_PIN 26
+
+static DrumPad& addPad() {
+  DrumPad& pad = TestKitBuilder(drumKit).addPad("pad", 0);
+
+  DrumSettings& settings = pad.getSettings();
+  settings.zoneThresholdsMin[0] = 100;
+  settings.scanTimeUs = 50000; // long enough to not be reached by the test
+  settings.maskTimeMs = 0;
+  return pad;
+}
+
+// returns true if the pad was hit
+static bool update(DrumPad& pad, sensor_value_t value) {
+  setPadPinValue(pad, 0, value);
+  drumKit.updateDrums();
+  return pad.isHit();
+}
+
+void setUp(void) {
+  drumKit.reset();
+  DrumIO::setup(false);
+
+  DrumMux mux;
+  mux.initHC4067(11, 12, 13, 14, MUX_ANALOG_IN_PIN, 10);
+  drumKit.addMux(mux);
+  drumKit.setScanOversampling(0); // one sample per update
+}
+
+void tearDown(void) {
+  // clean stuff up here
+}
+
+void test_sensing_earlyCommitDisabled() {
+  // GIVEN
+  DrumPad& pad = addPad();
+  drumKit.init();
+
+  // WHEN
+  bool isHit = update(pad, 800);
+  for (int i = 0; i < 10; ++i) {
+    isHit |= update(pad, 0);
+  }
+
+  // THEN
+  TEST_ASSERT_FALSE(isHit);
+  TEST_ASSERT_EQUAL(SensingState::Scan, pad.getSensingState());
+}
+
+void test_sensing_earlyCommit() {
+  // GIVEN
+  DrumPad& pad = addPad();
+  DrumSettings& settings = pad.getSettings();
+  settings.earlyCommitDropPercent = 50;
+  settings.earlyCommitSampleCount = 3;
+  settings.earlyCommitMinTimeUs = 0;
+  drumKit.init();
+
+  // WHEN
+  TEST_ASSERT_FALSE(update(pad, 400));
+  TEST_ASSERT_FALSE(update(pad, 800)); // peak
+  TEST_ASSERT_FALSE(update(pad, 500)); // not dropped enough
+  TEST_ASSERT_FALSE(update(pad, 300));
+  TEST_ASSERT_FALSE(update(pad, 300));
+  TEST_ASSERT_FALSE(update(pad, 500)); // restarts counting
+  TEST_ASSERT_FALSE(update(pad, 200));
+  TEST_ASSERT_FALSE(update(pad, 200));
+  bool isHit = update(pad, 200);
+
+  // THEN
+  TEST_ASSERT_TRUE(isHit);
+  TEST_ASSERT_EQUAL_UINT8(curve(scale(800, 100, MAX_SENSOR_VALUE), CurveType::Linear), pad.hitVelocities[0]);
+}
+
+void test_sensing_earlyCommitMinTime() {
+  // GIVEN
+  DrumPad& pad = addPad();
+  DrumSettings& settings = pad.getSettings();
+  settings.earlyCommitDropPercent = 50;
+  settings.earlyCommitSampleCount = 1;
+  settings.earlyCommitMinTimeUs = 40000; // not reached by the test
+  drumKit.init();
+
+  // WHEN
+  bool isHit = update(pad, 800);
+  for (int i = 0; i < 10; ++i) {
+    isHit |= update(pad, 0);
+  }
+
+  // THEN
+  TEST_ASSERT_FALSE(isHit);
+}
+
+void test_sensing_hitTimeIsSampleTime() {
+  // GIVEN
+  DrumPad& pad = addPad();
+  drumKit.init();
+
+  // WHEN
+  update(pad, 800);
+
+  // THEN
+  TEST_ASSERT_EQUAL(SensingState::Scan, pad.getSensingState());
+  TEST_ASSERT_TRUE(*pad.getConnector()->getPin(0).sampleTimeUs == pad.hitTimeUs);
+}
+
+void test_sensing_predictedHit() {
+  // GIVEN
+  DrumPad& pad = addPad();
+  DrumSettings& settings = pad.getSettings();
+  settings.predictionEnabled = true;
+  settings.predictionSampleCount = 2;
+  settings.predictionAmplitudeGain = 100;
+  settings.predictionRiseGain = 50;
+  drumKit.init();
+
+  // WHEN
+  TEST_ASSERT_FALSE(update(pad, 200));
+  TEST_ASSERT_FALSE(update(pad, 400));
+  bool isHit = update(pad, 600); // amplitude: 600, rise: 400
+
+  // THEN
+  TEST_ASSERT_TRUE(isHit);
+  TEST_ASSERT_EQUAL_UINT8(curve(scale(800, 100, MAX_SENSOR_VALUE), CurveType::Linear), pad.hitVelocities[0]);
+
+  // the scan continues without a second hit
+  TEST_ASSERT_FALSE(update(pad, 900));
+  TEST_ASSERT_FALSE(update(pad, 0));
+  TEST_ASSERT_EQUAL(SensingState::Scan, pad.getSensingState());
+}
+
+void test_sensing_calibrationHitRecorded() {
+  // GIVEN
+  DrumPad& pad = addPad();
+  DrumSettings& settings = pad.getSettings();
+  settings.predictionSampleCount = 2;
+  settings.earlyCommitDropPercent = 50;
+  settings.earlyCommitSampleCount = 1;
+  settings.earlyCommitMinTimeUs = 0;
+  drumKit.init();
+
+  // WHEN
+  update(pad, 200);
+  update(pad, 400);
+  update(pad, 600); // amplitude: 600, rise: 400
+  update(pad, 800); // peak
+  bool isHit = update(pad, 100);
+
+  // THEN
+  TEST_ASSERT_TRUE(isHit);
+  VelocityCalibration& calibration = pad.getVelocityCalibration();
+  TEST_ASSERT_EQUAL_UINT32(1, calibration.getHitCount());
+  TEST_ASSERT_EQUAL_UINT16(200, calibration.getMaxError()); // predicted by the default model: 600
+}
+
+void test_sensing_calibrationFit() {
+  // GIVEN
+  VelocityCalibration calibration;
+  const sensor_value_t hits[][2] = {{300, 100}, {500, 100}, {400, 300}, {200, 150}, {600, 50}};
+  for (auto& hit : hits) {
+    sensor_value_t amplitude = hit[0], rise = hit[1];
+    sensor_value_t peak = amplitude * 3 / 2 + rise / 2;
+    calibration.addHit(amplitude, rise, peak, amplitude);
+  }
+
+  // WHEN
+  VelocityModelFit fit;
+  bool isFitted = calibration.fit(fit);
+
+  // THEN
+  TEST_ASSERT_TRUE(isFitted);
+  TEST_ASSERT_EQUAL_INT16(150, fit.amplitudeGain);
+  TEST_ASSERT_EQUAL_INT16(50, fit.riseGain);
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 0, fit.rmsError);
+  TEST_ASSERT_EQUAL_UINT32(5, calibration.getHitCount());
+  TEST_ASSERT_EQUAL_UINT16(350, calibration.getMaxError());
+}
+
+void test_sensing_calibrationFitWithoutHits() {
+  // GIVEN
+  VelocityCalibration calibration;
+
+  // WHEN
+  VelocityModelFit fit;
+  bool isFitted = calibration.fit(fit);
+
+  // THEN
+  TEST_ASSERT_FALSE(isFitted);
+}
+
+void test_sensing_scanOversampling() {
+  // GIVEN
+  DrumPad& pad = addPad();
+  DrumSettings& settings = pad.getSettings();
+  settings.earlyCommitDropPercent = 50;
+  settings.earlyCommitSampleCount = 3;
+  settings.earlyCommitMinTimeUs = 0;
+  drumKit.setScanOversampling(2);
+  drumKit.init();
+  TEST_ASSERT_FALSE(update(pad, 800));
+
+  // WHEN
+  bool isHit = update(pad, 200); // read 3 times
+
+  // THEN
+  TEST_ASSERT_TRUE(isHit);
+  TEST_ASSERT_EQUAL(SensingState::Mask, pad.getSensingState());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_sensing_earlyCommitDisabled);
+  RUN_TEST(test_sensing_earlyCommit);
+  RUN_TEST(test_sensing_earlyCommitMinTime);
+  RUN_TEST(test_sensing_scanOversampling);
+  RUN_TEST(test_sensing_hitTimeIsSampleTime);
+  RUN_TEST(test_sensing_predictedHit);
+  RUN_TEST(test_sensing_calibrationHitRecorded);
+  RUN_TEST(test_sensing_calibrationFit);
+  RUN_TEST(test_sensing_calibrationFitWithoutHits);
+  return UNITY_END();
+}
@@ -0,0 +1,168 @@
+#include "simulation.h"
+#include "../support/test_kit_builder.h"
+
+#include <unity.h>
+
+#define MUX_ANALOG_IN_PIN 26
+
+static TestKitBuilder kit(drumKit);
+
+static pad_size_t findPadsToEvaluate(pad_size_t* padIndices) {
+  const SensingTable& table = drumKit.getSensingTable();
+  for (pad_size_t row = 0; row < table.getActivePadsCount(); ++row) {
+    drumKit.getPad(table.getActivePadIndex(row))->readInputValues(micros());
+  }
+  return table.findPadsToEvaluate(padIndices);
+}
+
+void setUp(void) {
+  drumKit.reset();
+  DrumIO::setup(false);
+
+  DrumMux mux;
+  mux.initHC4067(11, 12, 13, 14, MUX_ANALOG_IN_PIN, 10);
+  drumKit.addMux(mux);
+  drumKit.setScanOversampling(0); // one sample per update
+}
+
+void tearDown(void) {
+  // clean stuff up here
+}
+
+void test_sensingTable_activePadsFirst() {
+  // GIVEN
+  DrumPad& pad0 = kit.addPad("pad0", 0);
+  kit.addPad("pad1", 1);
+  DrumPad& pad2 = kit.addPad("pad2", 2);
+  pad2.getSettings().padType = PadType::Pedal;
+  pad0.setEnabled(false);
+  kit.addPad("pad3", 3);
+
+  // WHEN
+  drumKit.init();
+
+  // THEN
+  const SensingTable& table = drumKit.getSensingTable();
+  TEST_ASSERT_EQUAL_UINT8(2, table.getActivePadsCount());
+  TEST_ASSERT_EQUAL_UINT8(1, table.getActivePadIndex(0));
+  TEST_ASSERT_EQUAL_UINT8(3, table.getActivePadIndex(1));
+  TEST_ASSERT_TRUE(drumKit.getPad(1)->sensorValues + MAX_ZONE_COUNT == drumKit.getPad(3)->sensorValues);
+}
+
+void test_sensingTable_idlePadsAreSkipped() {
+  // GIVEN
+  DrumPad& pad0 = kit.addPad("pad0", 0);
+  DrumPad& pad1 = kit.addPad("pad1", 1);
+  drumKit.init();
+  setPadPinValue(pad0, 0, 100);
+  setPadPinValue(pad1, 0, 800);
+  drumKit.getScanner().sweep();
+
+  // WHEN
+  pad_size_t padIndices[MAX_PAD_COUNT];
+  pad_size_t count = findPadsToEvaluate(padIndices);
+
+  // THEN
+  TEST_ASSERT_EQUAL_UINT8(1, count);
+  TEST_ASSERT_EQUAL_UINT8(1, padIndices[0]);
+}
+
+void test_sensingTable_padsInScanAreEvaluated() {
+  // GIVEN
+  DrumPad& pad = kit.addPad("pad0", 0);
+  drumKit.init();
+  setPadPinValue(pad, 0, 800);
+  drumKit.updateDrums();
+  TEST_ASSERT_EQUAL(SensingState::Scan, pad.getSensingState());
+  setPadPinValue(pad, 0, 0);
+  drumKit.getScanner().sweep();
+
+  // WHEN
+  pad_size_t padIndices[MAX_PAD_COUNT];
+  pad_size_t count = findPadsToEvaluate(padIndices);
+
+  // THEN
+  TEST_ASSERT_EQUAL_UINT8(1, count);
+}
+
+void test_sensingTable_chokeableCymbalsAreEvaluated() {
+  // GIVEN
+  DrumPad& pad = kit.addPad("pad0", 0);
+  pad.getSettings().padType = PadType::Cymbal;
+  pad.getSettings().chokeType = ChokeType::TouchSensor;
+  drumKit.init();
+  drumKit.getScanner().sweep();
+
+  // WHEN
+  pad_size_t padIndices[MAX_PAD_COUNT];
+  pad_size_t count = findPadsToEvaluate(padIndices);
+
+  // THEN
+  TEST_ASSERT_EQUAL_UINT8(1, count);
+}
+
+void test_sensingTable_stateIsKeptOnRebuild() {
+  // GIVEN
+  DrumPad& pad0 = kit.addPad("pad0", 0);
+  DrumPad& pad1 = kit.addPad("pad1", 1);
+  drumKit.init();
+  setPadPinValue(pad1, 0, 800);
+  drumKit.updateDrums();
+
+  // WHEN
+  pad0.setEnabled(false);
+  drumKit.rebuildSensingTable();
+
+  // THEN
+  TEST_ASSERT_EQUAL_UINT8(1, drumKit.getSensingTable().getActivePadIndex(0));
+  TEST_ASSERT_EQUAL(SensingState::Scan, pad1.getSensingState());
+  TEST_ASSERT_EQUAL_UINT16(800, pad1.maxZoneValues[0]);
+}
+
+void test_sensingTable_scanningPads() {
+  // GIVEN
+  DrumPad& pad0 = kit.addPad("pad0", 0);
+  kit.addPad("pad1", 1);
+  drumKit.init();
+  setPadPinValue(pad0, 0, 800);
+  drumKit.updateDrums();
+
+  // WHEN
+  pad_size_t padIndices[MAX_PAD_COUNT];
+  pad_size_t count = drumKit.getSensingTable().findScanningPads(padIndices);
+
+  // THEN
+  TEST_ASSERT_EQUAL_UINT8(1, count);
+  TEST_ASSERT_EQUAL_UINT8(0, padIndices[0]);
+}
+
+void benchmark_sensingTable_updateDrums() {
+  for (pad_size_t padIndex = 0; padIndex < MAX_PAD_COUNT && padIndex < MAX_CHANNEL_COUNT; ++padIndex) {
+    kit.addPad((String("pad") + padIndex).c_str(), padIndex);
+  }
+  drumKit.init();
+
+  const int updateCount = 100000;
+  time_us_t startTimeUs = micros();
+  for (int i = 0; i < updateCount; ++i) {
+    drumKit.updateDrums();
+  }
+  time_us_t durationUs = micros() - startTimeUs;
+
+  char message[100];
+  snprintf(message, sizeof(message), "%d updates of %d idle pads: %llu us",
+      updateCount, drumKit.getPadsCount(), (unsigned long long) durationUs);
+  TEST_MESSAGE(message);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_sensingTable_activePadsFirst);
+  RUN_TEST(test_sensingTable_idlePadsAreSkipped);
+  RUN_TEST(test_sensingTable_padsInScanAreEvaluated);
+  RUN_TEST(test_sensingTable_chokeableCymbalsAreEvaluated);
+  RUN_TEST(test_sensingTable_stateIsKeptOnRebuild);
+  RUN_TEST(test_sensingTable_scanningPads);
+  RUN_TEST(benchmark_sensingTable_updateDrums);
+  return UNITY_END();
+}
@@ -0,0 +1,155 @@
+#include "spsc_queue.h"
+#include "midi/midi_transport_queue.h"
+
+#include <chrono>
+#include <thread>
+#include <unity.h>
+
+void setUp(void) {
+  // set stuff up here
+}
+
+void tearDown(void) {
+  // clean stuff up here
+}
+
+void test_queue_pushPop() {
+  // GIVEN
+  SpscQueue<int, 4> queue;
+
+  // WHEN
+  bool pushed1 = queue.push(1);
+  bool pushed2 = queue.push(2);
+
+  // THEN
+  TEST_ASSERT_TRUE(pushed1);
+  TEST_ASSERT_TRUE(pushed2);
+  int value;
+  TEST_ASSERT_TRUE(queue.pop(value));
+  TEST_ASSERT_EQUAL_INT(1, value);
+  TEST_ASSERT_TRUE(queue.pop(value));
+  TEST_ASSERT_EQUAL_INT(2, value);
+  TEST_ASSERT_FALSE(queue.pop(value));
+  TEST_ASSERT_TRUE(queue.isEmpty());
+}
+
+void test_queue_full() {
+  // GIVEN
+  SpscQueue<int, 4> queue;
+  queue.push(1);
+  queue.push(2);
+  queue.push(3);
+
+  // WHEN
+  bool pushed = queue.push(4);
+
+  // THEN
+  TEST_ASSERT_FALSE(pushed); // one item is always kept free
+  TEST_ASSERT_NULL(queue.beginPush());
+  queue.pop();
+  TEST_ASSERT_TRUE(queue.push(4));
+}
+
+void test_queue_inPlace() {
+  // GIVEN
+  SpscQueue<int, 4> queue;
+
+  // WHEN
+  int* item = queue.beginPush();
+  *item = 42;
+  TEST_ASSERT_NULL(queue.peek()); // not visible before commit
+  queue.commitPush();
+
+  // THEN
+  TEST_ASSERT_EQUAL_INT(42, *queue.peek());
+}
+
+class MidiTransport_Recorder : public MidiTransport {
+public:
+  void start(MidiOutputMode mode) override {}
+  void sendNoteOn(uint8_t inNoteNumber, uint8_t inVelocity, midi_channel_t inChannel) override { record(0x90, inNoteNumber, inVelocity); }
+  void sendNoteOff(uint8_t inNoteNumber, uint8_t inVelocity, midi_channel_t inChannel) override { record(0x80, inNoteNumber, inVelocity); }
+  void sendAfterTouch(uint8_t inPressure, midi_channel_t inChannel) override { record(0xD0, inPressure, 0); }
+  void sendAfterTouch(uint8_t inNoteNumber, uint8_t inPressure, midi_channel_t inChannel) override { record(0xA0, inNoteNumber, inPressure); }
+  void sendControlChange(uint8_t inControlNumber, uint8_t inControlValue, midi_channel_t inChannel) override { record(0xB0, inControlNumber, inControlValue); }
+
+  uint8_t messages[16][3];
+  int count = 0;
+
+private:
+  void record(uint8_t status, uint8_t data1, uint8_t data2) {
+    messages[count][0] = status;
+    messages[count][1] = data1;
+    messages[count][2] = data2;
+    ++count;
+  }
+};
+
+void test_midiQueue_forward() {
+  // GIVEN
+  MidiTransport_Queue queue;
+  MidiTransport_Recorder recorder;
+  queue.sendNoteOn(38, 100, 10);
+  queue.sendControlChange(4, 64, 10);
+  queue.sendNoteOff(38, 0, 10);
+
+  // WHEN
+  queue.forwardTo(recorder);
+
+  // THEN
+  const uint8_t expected[3][3] = {{0x90, 38, 100}, {0xB0, 4, 64}, {0x80, 38, 0}};
+  TEST_ASSERT_EQUAL_INT(3, recorder.count);
+  for (int i = 0; i < 3; ++i) {
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected[i], recorder.messages[i], 3);
+  }
+}
+
+void test_queue_concurrentProducerConsumer() {
+  // GIVEN
+  static SpscQueue<uint32_t, 64> queue;
+  const uint32_t itemCount = 1000000;
+
+  // WHEN
+  auto startTime = std::chrono::steady_clock::now();
+  std::thread producer([&]() {
+    for (uint32_t i = 0; i < itemCount;) {
+      if (queue.push(i)) {
+        ++i;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  uint32_t expected = 0;
+  bool inOrder = true;
+  while (expected < itemCount) {
+    uint32_t value;
+    if (queue.pop(value)) {
+      inOrder &= (value == expected);
+      ++expected;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  auto durationUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+
+  // THEN
+  TEST_ASSERT_TRUE(inOrder);
+  TEST_ASSERT_TRUE(queue.isEmpty());
+
+  char message[100];
+  snprintf(message, sizeof(message), "%u items transferred between threads in %lld us", itemCount, (long long) durationUs);
+  TEST_MESSAGE(message);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_queue_pushPop);
+  RUN_TEST(test_queue_full);
+  RUN_TEST(test_queue_inPlace);
+  RUN_TEST(test_midiQueue_forward);
+  RUN_TEST(test_queue_concurrentProducerConsumer);
+  return UNITY_END();
+}
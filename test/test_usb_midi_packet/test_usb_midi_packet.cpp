@@ -0,0 +1,100 @@
+#include "usb_midi_packet.h"
+
+#include <unity.h>
+
+UsbMidiPacketBuffer buffer;
+
+void setUp(void) {
+  buffer = UsbMidiPacketBuffer();
+}
+
+void tearDown(void) {
+  // clean stuff up here
+}
+
+static void assertPacket(uint8_t expected0, uint8_t expected1, uint8_t expected2, uint8_t expected3, const uint8_t* packet) {
+  const uint8_t expected[USB_MIDI_PACKET_SIZE] = {expected0, expected1, expected2, expected3};
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, packet, USB_MIDI_PACKET_SIZE);
+}
+
+void test_encode_channel_messages() {
+  // WHEN
+  buffer.addNoteOn(38, 100, 10);
+  buffer.addNoteOff(38, 0, 10);
+  buffer.addPolyAfterTouch(49, 127, 10);
+  buffer.addControlChange(4, 90, 10);
+  buffer.addChannelAfterTouch(64, 1);
+
+  // THEN
+  TEST_ASSERT_EQUAL(5, buffer.getPacketCount());
+  assertPacket(0x09, 0x99, 38, 100, buffer.getPacket(0));
+  assertPacket(0x08, 0x89, 38, 0, buffer.getPacket(1));
+  assertPacket(0x0A, 0xA9, 49, 127, buffer.getPacket(2));
+  assertPacket(0x0B, 0xB9, 4, 90, buffer.getPacket(3));
+  assertPacket(0x0D, 0xD0, 64, 0, buffer.getPacket(4));
+}
+
+void test_encode_sets_cable_number() {
+  // GIVEN
+  uint8_t packet[USB_MIDI_PACKET_SIZE];
+
+  // WHEN
+  encodeUsbMidiPacket(packet, 0x90, 36, 127, 2);
+
+  // THEN
+  assertPacket(0x29, 0x90, 36, 127, packet);
+}
+
+void test_encode_masks_data_bytes() {
+  // WHEN
+  buffer.addNoteOn(0xFF, 0x80, 16);
+
+  // THEN
+  assertPacket(0x09, 0x9F, 0x7F, 0x00, buffer.getPacket(0));
+}
+
+void test_full_buffer_drops_messages() {
+  // GIVEN
+  for (int i = 0; i < USB_MIDI_PACKET_BUFFER_SIZE; ++i) {
+    TEST_ASSERT_FALSE(buffer.isFull());
+    buffer.addNoteOn(i, 100, 10);
+  }
+  TEST_ASSERT_TRUE(buffer.isFull());
+
+  // WHEN
+  buffer.addNoteOn(100, 100, 10);
+
+  // THEN
+  TEST_ASSERT_EQUAL(USB_MIDI_PACKET_BUFFER_SIZE, buffer.getPacketCount());
+  TEST_ASSERT_EQUAL(1, buffer.getDroppedCount());
+}
+
+void test_removePackets_keeps_order_of_remaining_packets() {
+  // GIVEN
+  buffer.addNoteOn(36, 100, 10);
+  buffer.addNoteOn(38, 100, 10);
+  buffer.addNoteOn(42, 100, 10);
+
+  // WHEN
+  buffer.removePackets(2);
+
+  // THEN
+  TEST_ASSERT_EQUAL(1, buffer.getPacketCount());
+  assertPacket(0x09, 0x99, 42, 100, buffer.getPacket(0));
+
+  // WHEN
+  buffer.removePackets(1);
+
+  // THEN
+  TEST_ASSERT_TRUE(buffer.isEmpty());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_encode_channel_messages);
+  RUN_TEST(test_encode_sets_cable_number);
+  RUN_TEST(test_encode_masks_data_bytes);
+  RUN_TEST(test_full_buffer_drops_messages);
+  RUN_TEST(test_removePackets_keeps_order_of_remaining_packets);
+  return UNITY_END();
+}
@@ -11,6 +11,8 @@ export type ConnectorId = string;
 
 export const MAX_SENSOR_VALUE = 1023;
 export const MAX_GATE_TIME_MS = 30_000;
+export const MAX_MIDI_CONSTANT_LATENCY_US = 20_000;
+export const MAX_SCAN_OVERSAMPLING = 4;
 
 export const useConfig = create<Config>(() => ({
   mux: [],
@@ -67,11 +69,15 @@ export interface ConfigInfo {
   monitor?: MonitorConfig;
   version?: VersionInfo;
   midiOutputModes?: MidiOutputMode[];
+  midiFanOutModes?: MidiOutputMode[]; // modes that can be used as fan-out
 }
 
 export interface GeneralConfig {
   gateTimeMs: number; // 0 .. MAX_GATE_TIME_MS
+  scanOversampling?: number; // 0 .. MAX_SCAN_OVERSAMPLING
   midiOutputMode: MidiOutputMode; // USB client if not present
+  midiFanOutModes?: MidiOutputMode[]; // get all messages in addition to midiOutputMode
+  midiConstantLatencyUs?: number; // 0 (as soon as possible) .. MAX_MIDI_CONSTANT_LATENCY_US
   blePairing?: {
     name: string;
     address: string;
@@ -170,7 +176,18 @@ export interface DrumPadSettings {
   maskTimeMs?: number;
   decayTimeMs?: number;
   decayType?: keyof typeof DecayType;
+  earlyCommitDropPercent?: number; // 0: disabled
+  earlyCommitSampleCount?: number;
+  earlyCommitMinTimeUs?: number;
+  predictionEnabled?: boolean;
+  predictionSampleCount?: number;
+  predictionAmplitudeGain?: number; // %
+  predictionRiseGain?: number; // %
   curveType: keyof typeof CurveType;
+  customCurve?: {
+    input: number, // % of the threshold range [0 .. 100]
+    velocity: number, // [1 .. 127]
+  }[],
   almostClosedThreshold?: number; // %
   closedThreshold?: number; // %
   moveDetectTolerance?: number; // [0 .. MAX_SENSOR_VALUE]
@@ -208,7 +225,8 @@ export enum CurveType {
   Exp1 = "Exp1",
   Exp2 = "Exp2",
   Log1 = "Log1",
-  Log2 = "Log2"
+  Log2 = "Log2",
+  Custom = "Custom"
 }
 
 export enum DecayType {
@@ -21,12 +21,14 @@ export enum DrumCommand {
   scanBleDevices = "scanBleDevices",
   blePair = "blePair",
   getBleStatus = "getBleStatus",
-  getUsbHostStatus = "getUsbHostStatus"
+  getUsbHostStatus = "getUsbHostStatus",
+  adcTrace = "adcTrace"
 }
 
 enum ConnectionEventType {
     onConnectionChangeEvent = 'onConnectionChange',
     onConnectionBinaryData = 'onConnectionBinaryData',
+    onConnectionTraceData = 'onConnectionTraceData',
     onConnectionJsonData = 'onConnectionJsonData'
 }
 
@@ -91,7 +93,9 @@ export class Connection {
       }
 
       if (event.data instanceof ArrayBuffer) {
-        this.publishEvent(ConnectionEventType.onConnectionBinaryData, event.data);
+        // raw ADC traces start with a magic, monitor messages with the pad index
+        const isTraceData = event.data.byteLength >= 4 && new Uint8Array(event.data, 0, 1)[0] == 'E'.charCodeAt(0);
+        this.publishEvent(isTraceData ? ConnectionEventType.onConnectionTraceData : ConnectionEventType.onConnectionBinaryData, event.data);
       } else {
         const json = JSON.parse(event.data);
         this.publishEvent(ConnectionEventType.onConnectionJsonData, json);
@@ -195,6 +199,11 @@ export class Connection {
       (event: CustomEventInit) => listener(event.detail));
   }
 
+  registerOnTraceDataListener(listener: (data: ArrayBuffer) => void): EventListenerHandle {
+    return this.registerListener(ConnectionEventType.onConnectionTraceData,
+      (event: CustomEventInit) => listener(event.detail));
+  }
+
   registerOnJsonDataListener(type: string, listener: (data: any) => void) {
     return this.registerListener(ConnectionEventType.onConnectionJsonData,
       (event: CustomEventInit) => {
@@ -32,6 +32,7 @@ export class MonitorMessage {
   maskTimeMs?: number;
   decayTimeMs?: number;
   latencyUs: number;
+  scanTimeSavedUs: number; // by early commit
   isChoked: boolean;
   padType: PadType;
   zonesType: ZonesType;
@@ -68,6 +69,8 @@ export class MonitorMessage {
     offset += uint8_size;
     this.latencyUs = view.getUint32(offset, true);
     offset += uint32_size;
+    this.scanTimeSavedUs = view.getUint16(offset, true);
+    offset += uint16_size;
 
     this.padType = Object.values(PadType)[view.getUint8(offset)];
     offset += uint8_size;
@@ -129,7 +129,9 @@ function getXAnnotations(
           borderColor: 'rgb(119, 119, 119)',
           borderWidth: borderWidth,
           color: annotationTextColor,
-          content: 'Mask',
+          content: message.scanTimeSavedUs > 0
+            ? 'Mask (' + Number(message.scanTimeSavedUs / 1000).toFixed(1) + 'ms earlier)'
+            : 'Mask',
           display: true,
           position: labelPosition,
           xAdjust: (ctx) => {
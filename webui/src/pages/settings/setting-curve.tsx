@@ -36,6 +36,7 @@ export function SettingCurveTypeEntry({ label, padIndex, valueAccessor }: {
         <MenuItem value={CurveType.Exp2}>Exponential 2</MenuItem>
         <MenuItem value={CurveType.Log1}>Logarithmic 1</MenuItem>
         <MenuItem value={CurveType.Log2}>Logarithmic 2</MenuItem>
+        <MenuItem value={CurveType.Custom}>Custom</MenuItem>
       </Select>
     </SettingEntryContainer>
   );
@@ -2,7 +2,7 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 import { useContext } from "react";
-import { MAX_GATE_TIME_MS, updateConfig, useConfig } from "@config";
+import { MAX_GATE_TIME_MS, MAX_MIDI_CONSTANT_LATENCY_US, MAX_SCAN_OVERSAMPLING, updateConfig, useConfig } from "@config";
 import { createFractionConverter } from "./converter";
 import { connection } from "@/connection/connection";
 import { Box, Stack } from "@mui/material";
@@ -21,7 +21,9 @@ export function GeneralCard() {
       >
         <Stack spacing={1} sx={{ padding: 1 }}>
           <GateTime />
+          <ScanOversampling />
           <MidiOutputModeSelect />
+          <MidiConstantLatency />
         </Stack>
       </Card>
     </Box>
@@ -62,6 +64,72 @@ export function GateTime() {
   );
 }
 
+export function ScanOversampling() {
+  const scanOversampling = useConfig(config => config.general?.scanOversampling);
+  const connected = useContext(ConnectionStateContext);
+
+  const handleValueChange = (value: number) => {
+    if (Number.isFinite(value)) {
+      const newScanOversampling = Math.max(0, Math.min(Math.round(value), MAX_SCAN_OVERSAMPLING));
+      if (newScanOversampling !== scanOversampling) {
+        updateConfig(config => config.general = {
+          ...config.general!,
+          scanOversampling: newScanOversampling
+        });
+      }
+      connection.sendSetGeneralConfigCommand({
+        scanOversampling: newScanOversampling
+      });
+    }
+  };
+
+  return (
+    <GeneralSetting label="Scan Oversampling:">
+      <NumberInput disabled={!connected} value={scanOversampling ?? 0}
+        onValueChange={(value) => value !== null && handleValueChange(value)}
+        size='small'
+        step={1}
+        width='5em'
+        min={0} max={MAX_SCAN_OVERSAMPLING} />
+    </GeneralSetting>
+  );
+}
+
+// 0 sends the hits as soon as possible, otherwise each hit is sent this time after it was detected
+export function MidiConstantLatency() {
+  const midiConstantLatencyUs = useConfig(config => config.general?.midiConstantLatencyUs);
+  const connected = useContext(ConnectionStateContext);
+
+  const converter = createFractionConverter(1000);
+
+  const handleValueChange = (value: number) => {
+    if (Number.isFinite(value)) {
+      const newValue = converter.toConfig(value);
+      const newLatencyUs = Math.max(0, Math.min(newValue, MAX_MIDI_CONSTANT_LATENCY_US));
+      if (newLatencyUs !== midiConstantLatencyUs) {
+        updateConfig(config => config.general = {
+          ...config.general!,
+          midiConstantLatencyUs: newLatencyUs
+        });
+      }
+      connection.sendSetGeneralConfigCommand({
+        midiConstantLatencyUs: newLatencyUs
+      });
+    }
+  };
+
+  return (
+    <GeneralSetting label="Constant MIDI Latency (ms):">
+      <NumberInput disabled={!connected} value={converter.fromConfig(midiConstantLatencyUs ?? 0)}
+        onValueChange={(value) => value !== null && handleValueChange(value)}
+        size='small'
+        step={0.5}
+        width='5em'
+        min={0} max={converter.fromConfig(MAX_MIDI_CONSTANT_LATENCY_US)} />
+    </GeneralSetting>
+  );
+}
+
 export function GeneralSetting({children, label}: {
   children: React.ReactNode;
   label: string;
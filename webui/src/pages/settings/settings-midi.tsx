@@ -34,6 +34,9 @@ enum BleConnectionStatus {
 export function MidiOutputModeSelect() {
   const midiOutputMode = useConfig(config => config.general?.midiOutputMode);
   const supportedMidiOutputModes = useConfig(config => config._info?.midiOutputModes) ?? [];
+  const midiFanOutModes = useConfig(config => config.general?.midiFanOutModes) ?? [];
+  const supportedMidiFanOutModes = (useConfig(config => config._info?.midiFanOutModes) ?? [])
+    .filter(mode => mode !== midiOutputMode);
   const blePairing = useConfig(config => config.general?.blePairing);
   const connected = useContext(ConnectionStateContext);
   const theme = useTheme();
@@ -109,6 +112,16 @@ export function MidiOutputModeSelect() {
     }
   };
 
+  const handleMidiFanOutModesChanged = (value: MidiOutputMode[]) => {
+    updateConfig(config => config.general = {
+      ...config.general!,
+      midiFanOutModes: value
+    });
+    connection.sendSetGeneralConfigCommand({
+      midiFanOutModes: value
+    });
+  };
+
   const handlBleDeviceSelected = (device: {
     name: string; address: string
   } | undefined = undefined) => {
@@ -146,6 +159,27 @@ export function MidiOutputModeSelect() {
           ))}
         </Select>
       </GeneralSetting>
+
+      {supportedMidiFanOutModes.length > 0 && (
+        <GeneralSetting label="Also Send To:">
+          <Select
+            multiple
+            disabled={!connected}
+            value={midiFanOutModes.filter(mode => mode !== midiOutputMode)}
+            onChange={(e) => handleMidiFanOutModesChanged(e.target.value as MidiOutputMode[])}
+            renderValue={(modes) => modes.length === 0 ? "-" : modes.map(mode => midiOutputModeLabels[mode]).join(", ")}
+            displayEmpty
+            size='small'
+            sx={{ minWidth: '150px' }}
+          >
+            {supportedMidiFanOutModes.map(mode => (
+              <MenuItem key={mode} value={mode}>
+                {midiOutputModeLabels[mode]}
+              </MenuItem>
+            ))}
+          </Select>
+        </GeneralSetting>
+      )}
       
       {midiOutputMode === MidiOutputMode.BleClient && (
         <MidiSettingsBox label="BLE Client Settings">
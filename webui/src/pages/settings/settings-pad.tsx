@@ -18,6 +18,12 @@ const settingIdsOrdered: (keyof DrumPadSettings)[] = [
   'maskTimeMs',
   'decayTimeMs',
   'decayType',
+  'earlyCommitDropPercent',
+  'earlyCommitSampleCount',
+  'earlyCommitMinTimeUs',
+  'predictionSampleCount',
+  'predictionAmplitudeGain',
+  'predictionRiseGain',
   'moveDetectTolerance',
   'almostClosedThreshold',
   'closedThreshold',
@@ -41,6 +47,12 @@ const settingDisplayNames: SettingDisplayNames = {
   maskTimeMs: () => 'Mask-Time [ms]',
   decayTimeMs: () => 'Decay-Time [ms]',
   decayType: () => 'Decay Type',
+  earlyCommitDropPercent: () => 'Early Commit Peak Drop [%] (0: off)',
+  earlyCommitSampleCount: () => 'Early Commit Samples',
+  earlyCommitMinTimeUs: () => 'Early Commit Min. Scan-Time [ms]',
+  predictionSampleCount: () => 'Velocity Prediction Samples',
+  predictionAmplitudeGain: () => 'Velocity Prediction Amplitude Gain [%]',
+  predictionRiseGain: () => 'Velocity Prediction Rise Gain [%]',
   curveType: () => 'Curve Type',
   almostClosedThreshold: () => 'Almost / Closed Threshold [%]',
   moveDetectTolerance: () => 'Move Detection Tolerance [%]',
@@ -131,6 +143,15 @@ function SettingsElement({padIndex, settingId, padType} : {
     return <SettingSliderEntry {...defaultProps} key={settingId}
       max={20} step={0.1}
       convert={createFractionConverter(1000)} />;
+
+  case "predictionSampleCount":
+    return <SettingSliderEntry {...defaultProps} key={settingId} min={1} max={20} />;
+
+  case "predictionAmplitudeGain":
+    return <SettingSliderEntry {...defaultProps} key={settingId} max={500} />;
+
+  case "predictionRiseGain":
+    return <SettingSliderEntry {...defaultProps} key={settingId} min={-500} max={500} />;
   
   case "maskTimeMs":
     return <SettingSliderEntry {...defaultProps} key={settingId} />;
@@ -140,6 +161,17 @@ function SettingsElement({padIndex, settingId, padType} : {
 
   case "decayType":
     return <SettingDecayTypeEntry {...defaultProps} key={settingId} />;
+
+  case "earlyCommitDropPercent":
+    return <SettingSliderEntry {...defaultProps} key={settingId} max={100} />;
+
+  case "earlyCommitSampleCount":
+    return <SettingSliderEntry {...defaultProps} key={settingId} min={1} max={20} />;
+
+  case "earlyCommitMinTimeUs":
+    return <SettingSliderEntry {...defaultProps} key={settingId}
+      max={20} step={0.1}
+      convert={createFractionConverter(1000)} />;
   
   case "curveType":
     return <SettingCurveTypeEntry {...defaultProps} key={settingId} />;
@@ -8,15 +8,50 @@ import Box from '@mui/material/Box';
 import { connection, DrumCommand } from '@/connection/connection';
 import { IconButton, Stack, Typography } from '@mui/material';
 import ReloadIcon from '@mui/icons-material/Sync';
+import ResetIcon from '@mui/icons-material/RestartAlt';
 import { InfoBox } from '@/components/info-box';
 
+interface CostHistogramJson {
+    count: number;
+    minUs: number;
+    avgUs: number;
+    p99Us: number;
+    maxUs: number;
+}
+
+interface MidiOutputStatsJson {
+    mode: string;
+    queued: number;
+    maxQueued: number;
+    dropped: number;
+    coalesced: number;
+}
+
+// only available if the firmware was built with ENABLE_LOOP_PROFILER
+interface LoopProfileJson {
+    sensingPeriod: CostHistogramJson;
+    phases: Record<string, CostHistogramJson>;
+}
+
 interface StatisticsJson {
     updateCountPer30s?: number;
+    settlingSuppressedMs?: number;
+    muxSettleCount?: number;
+    notes?: {
+      pending: number;
+      maxPending: number;
+      retriggered: number;
+    };
+    midiDropped?: number;
+    midiOutputs?: MidiOutputStatsJson[];
+    midiLatency?: CostHistogramJson; // hit to NoteOn on the selected output
     mem: {
       freeHeap: number;
+      minFreeHeap: number;
       totalHeap: number;
     };
     cpuFreq: number;
+    loopProfile?: LoopProfileJson;
 }
 
 interface StatisticsInfo {
@@ -24,8 +59,38 @@ interface StatisticsInfo {
     statsJson: StatisticsJson;
 }
 
-function requestStats() {
-  connection.sendCommand(DrumCommand.getStats);
+function requestStats(resetProfile = false) {
+  connection.sendCommand(DrumCommand.getStats, resetProfile ? { resetProfile } : undefined);
+}
+
+function formatHistogram(histogram: CostHistogramJson) {
+  if (!histogram.count) {
+    return "-";
+  }
+  return `${histogram.minUs} / ${histogram.avgUs} / ${histogram.p99Us} / ${histogram.maxUs} µs`;
+}
+
+function formatJitter(histogram: CostHistogramJson) {
+  if (!histogram.count) {
+    return "-";
+  }
+  return `${histogram.maxUs - histogram.minUs} µs`;
+}
+
+function LoopProfileRows({ profile }: { profile: LoopProfileJson }) {
+  return (
+    <>
+      <Box gridColumn='span 2' fontStyle='italic'>Loop Profile (Min / Avg / P99 / Max):</Box>
+      <Box>Sensing Period:</Box><Box>{formatHistogram(profile.sensingPeriod)}</Box>
+      {
+        Object.entries(profile.phases).map(([phase, histogram]) =>
+          <Box key={phase} display='contents'>
+            <Box>{phase}:</Box><Box>{formatHistogram(histogram)}</Box>
+          </Box>
+        )
+      }
+    </>
+  );
 }
 
 export function StatisticsTable() {
@@ -50,6 +115,10 @@ export function StatisticsTable() {
     requestStats();
   }, []);
 
+  const handleResetProfile = useCallback(() => {
+    requestStats(true);
+  }, []);
+
   let lastRetrieval = "<n/a>";
   let pollingInfo = "<n/a>";
   let memInfo = "-";
@@ -65,7 +134,7 @@ export function StatisticsTable() {
     }
 
     const statsMem = statsInfo.statsJson.mem;
-    memInfo = `${Math.round(statsMem.freeHeap / 1024)} / ${Math.round(statsMem.totalHeap / 1024)} KB`;
+    memInfo = `${Math.round(statsMem.freeHeap / 1024)} / ${Math.round(statsMem.minFreeHeap / 1024)} / ${Math.round(statsMem.totalHeap / 1024)} KB`;
   }
 
   return (
@@ -76,14 +145,52 @@ export function StatisticsTable() {
           !statsInfo ? null :
             <>
               <Box>Sensor Polling Interval:</Box><Box>{pollingInfo}</Box>
+              <Box>Suppressed while Settling:</Box><Box>{statsInfo.statsJson.settlingSuppressedMs ?? 0} ms ({statsInfo.statsJson.muxSettleCount ?? 0} times)</Box>
+              {
+                statsInfo.statsJson.notes ?
+                  <>
+                    <Box>Pending Notes (Current / Max.):</Box><Box>{statsInfo.statsJson.notes.pending} / {statsInfo.statsJson.notes.maxPending}</Box>
+                    <Box>Retriggered Notes:</Box><Box>{statsInfo.statsJson.notes.retriggered}</Box>
+                  </> : null
+              }
+              {
+                statsInfo.statsJson.midiOutputs ?
+                  <>
+                    <Box gridColumn='span 2' fontStyle='italic'>MIDI Outputs (Queued / Max. Queued / Dropped / Coalesced):</Box>
+                    {
+                      statsInfo.statsJson.midiOutputs.map(output =>
+                        <Box key={output.mode} display='contents'>
+                          <Box>{output.mode}:</Box><Box>{output.queued} / {output.maxQueued} / {output.dropped} / {output.coalesced}</Box>
+                        </Box>
+                      )
+                    }
+                    <Box>Dropped before Output:</Box><Box>{statsInfo.statsJson.midiDropped ?? 0}</Box>
+                  </> : null
+              }
+              {
+                statsInfo.statsJson.midiLatency ?
+                  <>
+                    <Box>Hit Latency (Min / Avg / P99 / Max):</Box><Box>{formatHistogram(statsInfo.statsJson.midiLatency)}</Box>
+                    <Box>Hit Jitter:</Box><Box>{formatJitter(statsInfo.statsJson.midiLatency)}</Box>
+                  </> : null
+              }
               <Box>CPU Frequency:</Box><Box>{statsInfo.statsJson.cpuFreq  / 1000000} MHz</Box>
-              <Box>Heap (Free / Total):</Box><Box>{memInfo}</Box>
+              <Box>Heap (Free / Min. Free / Total):</Box><Box>{memInfo}</Box>
+              {statsInfo.statsJson.loopProfile ? <LoopProfileRows profile={statsInfo.statsJson.loopProfile}/> : null}
             </>
         }
       </InfoBox>
-      <IconButton onClick={handleReload}>
-        <ReloadIcon/>
-      </IconButton>
+      <Stack>
+        <IconButton onClick={handleReload}>
+          <ReloadIcon/>
+        </IconButton>
+        {
+          statsInfo?.statsJson.loopProfile || statsInfo?.statsJson.midiLatency ?
+            <IconButton onClick={handleResetProfile} title='Reset loop profile and hit latency'>
+              <ResetIcon/>
+            </IconButton> : null
+        }
+      </Stack>
     </Stack>
   );
 }
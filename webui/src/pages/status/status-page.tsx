@@ -3,11 +3,13 @@
 
 import { EventLogInfo } from './event-log';
 import { StatisticsTable } from './statistics';
+import { TraceCapture } from './trace-capture';
 
 export function StatusPage() {
   return (
     <>
       <StatisticsTable />
+      <TraceCapture />
       <EventLogInfo />
     </>
   );
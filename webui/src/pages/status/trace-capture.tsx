@@ -0,0 +1,82 @@
+// Copyright (c) 2025 Tobias Gunkel
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+import { useCallback, useEffect, useRef, useState } from 'react';
+
+import Box from '@mui/material/Box';
+
+import { connection, DrumCommand } from '@/connection/connection';
+import { Button, Stack } from '@mui/material';
+import { InfoBox } from '@/components/info-box';
+
+const traceDataMagicSize = 4; // prefix of the chunks with the frames, not part of the trace file
+
+interface AdcTraceStatusJson {
+  active: boolean;
+  droppedFrames: number;
+}
+
+function downloadTrace(parts: ArrayBuffer[]) {
+  const blob = new Blob(parts, { type: 'application/octet-stream' });
+  const url = URL.createObjectURL(blob);
+  const link = document.createElement('a');
+  link.href = url;
+  link.download = `trace-${new Date().toISOString().replace(/[:.]/g, '-')}.edtr`;
+  link.click();
+  URL.revokeObjectURL(url);
+}
+
+/**
+ * Records the raw samples of all inputs and downloads them as a trace file for the native simulation.
+ */
+export function TraceCapture() {
+  const [status, setStatus] = useState<AdcTraceStatusJson>();
+  const [recordedBytes, setRecordedBytes] = useState(0);
+  const traceParts = useRef<ArrayBuffer[]>([]);
+
+  useEffect(() => {
+    const traceDataHandle = connection.registerOnTraceDataListener(data => {
+      const isHeader = traceParts.current.length === 0;
+      const part = isHeader ? data : data.slice(traceDataMagicSize);
+      traceParts.current.push(part);
+      setRecordedBytes(bytes => bytes + part.byteLength);
+    });
+
+    const statusHandle = connection.registerOnJsonDataListener('adcTrace', (statusJson: AdcTraceStatusJson) => {
+      setStatus(statusJson);
+      if (!statusJson.active && traceParts.current.length > 0) {
+        downloadTrace(traceParts.current);
+        traceParts.current = [];
+      }
+    });
+
+    return () => {
+      connection.unregisterListener(traceDataHandle);
+      connection.unregisterListener(statusHandle);
+    };
+  }, []);
+
+  const handleStart = useCallback(() => {
+    traceParts.current = [];
+    setRecordedBytes(0);
+    connection.sendCommand(DrumCommand.adcTrace, { enabled: true });
+  }, []);
+
+  const handleStop = useCallback(() => {
+    connection.sendCommand(DrumCommand.adcTrace, { enabled: false });
+  }, []);
+
+  return (
+    <Stack direction='row' alignItems='center'>
+      <InfoBox>
+        <Box>Raw ADC Trace:</Box><Box>{Math.round(recordedBytes / 1024)} KB</Box>
+        <Box>Dropped Frames:</Box><Box>{status?.droppedFrames ?? 0}</Box>
+      </InfoBox>
+      {
+        status?.active ?
+          <Button variant='contained' onClick={handleStop}>Stop and Download</Button> :
+          <Button variant='contained' onClick={handleStart}>Record</Button>
+      }
+    </Stack>
+  );
+}